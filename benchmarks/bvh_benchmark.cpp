@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "common/scene/bvh.h"
+
+namespace {
+
+std::vector<AABB> createVolumes(size_t count) {
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+  std::uniform_real_distribution<float> size(0.5f, 4.0f);
+  std::vector<AABB> volumes(count);
+  for (AABB& volume : volumes) {
+    volume.lowerCorner = glm::vec3(position(random), position(random), position(random));
+    volume.upperCorner = volume.lowerCorner + size(random);
+  }
+  return volumes;
+}
+
+// Picking rays from around the world towards its center.
+std::vector<Ray> createRays() {
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+  std::vector<Ray> rays(1024);
+  for (Ray& ray : rays) {
+    ray.origin = glm::vec3(coordinate(random), 1200.0f, coordinate(random));
+    ray.direction = glm::normalize(glm::vec3(0.5f * coordinate(random), 0.0f,
+                                             0.5f * coordinate(random))
+                                   - ray.origin);
+  }
+  return rays;
+}
+
+void BM_BvhBuild(benchmark::State& state) {
+  const std::vector<AABB> volumes = createVolumes(state.range(0));
+  Bvh bvh;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bvh.build(volumes));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_BvhRefit(benchmark::State& state) {
+  const std::vector<AABB> volumes = createVolumes(state.range(0));
+  Bvh bvh;
+  bvh.build(volumes);
+  for (auto _ : state) {
+    bvh.refit(volumes);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_BvhRaycast(benchmark::State& state) {
+  const std::vector<AABB> volumes = createVolumes(state.range(0));
+  const std::vector<Ray> rays = createRays();
+  Bvh bvh;
+  bvh.build(volumes);
+  size_t hitCount = 0;
+  for (auto _ : state) {
+    hitCount = 0;
+    for (const Ray& ray : rays) {
+      hitCount += bvh.raycast(ray).has_value();
+    }
+    benchmark::DoNotOptimize(hitCount);
+  }
+  state.SetItemsProcessed(state.iterations() * rays.size());
+  state.counters["hits"] = static_cast<double>(hitCount);
+}
+
+// Testing every volume, like picking without a spatial structure.
+void BM_LinearRaycast(benchmark::State& state) {
+  const std::vector<AABB> volumes = createVolumes(state.range(0));
+  const std::vector<Ray> rays = createRays();
+  size_t hitCount = 0;
+  for (auto _ : state) {
+    hitCount = 0;
+    for (const Ray& ray : rays) {
+      std::optional<float> closest;
+      for (const AABB& volume : volumes) {
+        const std::optional<float> distance = intersectRay(ray, volume);
+        if (distance && (!closest || *distance < *closest)) {
+          closest = distance;
+        }
+      }
+      hitCount += closest.has_value();
+    }
+    benchmark::DoNotOptimize(hitCount);
+  }
+  state.SetItemsProcessed(state.iterations() * rays.size());
+  state.counters["hits"] = static_cast<double>(hitCount);
+}
+
+void BM_BvhOverlap(benchmark::State& state) {
+  const std::vector<AABB> volumes = createVolumes(state.range(0));
+  const std::vector<AABB> queries = createVolumes(1024);
+  Bvh bvh;
+  bvh.build(volumes);
+  std::vector<uint32_t> primitives;
+  for (auto _ : state) {
+    primitives.clear();
+    for (const AABB& query : queries) {
+      bvh.overlap(AABB{query.lowerCorner - 20.0f, query.upperCorner + 20.0f}, primitives);
+    }
+    benchmark::DoNotOptimize(primitives.data());
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+  state.counters["found"] = static_cast<double>(primitives.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_BvhBuild)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BvhRefit)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BvhRaycast)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LinearRaycast)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BvhOverlap)->Arg(100'000)->Unit(benchmark::kMicrosecond);
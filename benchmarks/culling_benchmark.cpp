@@ -0,0 +1,149 @@
+#include <benchmark/benchmark.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <vector>
+
+#include "common/scene/occlusion_buffer.h"
+#include "common/util/geometry.h"
+#include "lib/simd/kernels.h"
+
+namespace {
+
+constexpr size_t BOX_COUNT = 100'000;
+
+std::vector<AABB> createBoxes() {
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+  std::uniform_real_distribution<float> size(0.5f, 4.0f);
+  std::vector<AABB> boxes(BOX_COUNT);
+  for (AABB& box : boxes) {
+    box.lowerCorner = glm::vec3(position(random), position(random), position(random));
+    box.upperCorner = box.lowerCorner + size(random);
+  }
+  return boxes;
+}
+
+std::array<glm::vec4, NUM_CUBE_FACES> getFrustumPlanes() {
+  return extractFrustumPlanes(
+      glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 600.0f)
+      * glm::lookAt(glm::vec3(0.0f, 20.0f, -450.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+}
+
+void BM_CullAABBsSingle(benchmark::State& state) {
+  const std::vector<AABB> boxes = createBoxes();
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = getFrustumPlanes();
+  std::vector<uint32_t> visible;
+  visible.reserve(BOX_COUNT);
+  for (auto _ : state) {
+    visible.clear();
+    for (uint32_t i = 0; i < boxes.size(); ++i) {
+      if (boxes[i].intersectsFrustum(planes)) {
+        visible.push_back(i);
+      }
+    }
+    benchmark::DoNotOptimize(visible.data());
+  }
+  state.SetItemsProcessed(state.iterations() * BOX_COUNT);
+  state.counters["visible"] = static_cast<double>(visible.size());
+}
+
+void BM_CullAABBsBatch(benchmark::State& state) {
+  const lib::SimdLevel previous = lib::getSimdLevel();
+  if (!lib::setSimdLevel(static_cast<lib::SimdLevel>(state.range(0)))) {
+    state.SkipWithError("Instruction set not supported");
+    return;
+  }
+  AABBBatch boxes;
+  for (const AABB& box : createBoxes()) {
+    boxes.push_back(box);
+  }
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = getFrustumPlanes();
+  std::vector<uint32_t> visible;
+  visible.reserve(BOX_COUNT);
+  for (auto _ : state) {
+    visible.clear();
+    cullAABBs(boxes, planes, visible);
+    benchmark::DoNotOptimize(visible.data());
+  }
+  state.SetItemsProcessed(state.iterations() * BOX_COUNT);
+  state.counters["visible"] = static_cast<double>(visible.size());
+  lib::setSimdLevel(previous);
+}
+
+// Blocks of buildings on a grid, seen from the street.
+struct City {
+  std::vector<AABB> buildings;
+  glm::mat4 viewProjection;
+  glm::vec3 viewPosition = glm::vec3(0.0f, 2.0f, -480.0f);
+
+  City() {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> height(10.0f, 60.0f);
+    for (float x = -500.0f; x < 500.0f; x += 50.0f) {
+      for (float z = -440.0f; z < 500.0f; z += 50.0f) {
+        buildings.push_back(
+            AABB{glm::vec3(x + 5.0f, 0.0f, z), glm::vec3(x + 35.0f, height(random), z + 30.0f)});
+      }
+    }
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    projection[1][1] = -projection[1][1];
+    viewProjection = projection * glm::lookAt(viewPosition, glm::vec3(0.0f, 2.0f, 0.0f),
+                                              glm::vec3(0.0f, 1.0f, 0.0f));
+  }
+
+  void renderOccluders(OcclusionBuffer& buffer, size_t count) const {
+    std::vector<uint32_t> occluders;
+    selectOccluders(buildings, viewPosition, count, occluders);
+    buffer.clear();
+    for (uint32_t occluder : occluders) {
+      buffer.renderBox(buildings[occluder], viewProjection);
+    }
+    buffer.updateHierarchy();
+  }
+};
+
+void BM_OcclusionRenderOccluders(benchmark::State& state) {
+  const City city;
+  OcclusionBuffer buffer(256, 128);
+  for (auto _ : state) {
+    city.renderOccluders(buffer, state.range(0));
+    benchmark::DoNotOptimize(buffer.getDepth(0, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_OcclusionTestBoxes(benchmark::State& state) {
+  const City city;
+  OcclusionBuffer buffer(256, 128);
+  city.renderOccluders(buffer, 64);
+  std::vector<AABB> boxes = createBoxes();
+  for (AABB& box : boxes) {
+    const float height = box.upperCorner.y - box.lowerCorner.y;
+    box.lowerCorner.y = 0.0f;
+    box.upperCorner.y = height;
+  }
+  size_t visibleCount = 0;
+  for (auto _ : state) {
+    visibleCount = 0;
+    for (const AABB& box : boxes) {
+      visibleCount += buffer.isVisible(box, city.viewProjection);
+    }
+    benchmark::DoNotOptimize(visibleCount);
+  }
+  state.SetItemsProcessed(state.iterations() * BOX_COUNT);
+  state.counters["visible"] = static_cast<double>(visibleCount);
+}
+
+}  // namespace
+
+BENCHMARK(BM_CullAABBsSingle)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CullAABBsBatch)
+    ->ArgName("level")
+    ->Arg(static_cast<int64_t>(lib::SimdLevel::SCALAR))
+    ->Arg(static_cast<int64_t>(lib::SimdLevel::SSE))
+    ->Arg(static_cast<int64_t>(lib::SimdLevel::AVX2))
+    ->Arg(static_cast<int64_t>(lib::SimdLevel::NEON))
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_OcclusionRenderOccluders)->Arg(16)->Arg(64)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_OcclusionTestBoxes)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/archetype_registry.h"
+#include "common/entity_component_system/registry/registry.h"
+
+namespace {
+
+template <typename RegistryType>
+std::unique_ptr<RegistryType> createPopulatedRegistry(size_t count) {
+  auto registry = std::make_unique<RegistryType>(count);
+  for (size_t i = 0; i < count; ++i) {
+    const Entity entity = registry->createEntity();
+    registry->addComponent(entity, PositionComponent{.x = float(i), .y = 0.0f});
+    registry->addComponent(entity, VelocityComponent{.dx = 1.0f, .dy = 2.0f});
+    registry->addComponent(entity,
+                           TransformComponent{.model = glm::mat4(1.0f), .world = glm::mat4(1.0f)});
+  }
+  return registry;
+}
+
+constexpr auto updateComponents = [](PositionComponent& position, const VelocityComponent& velocity,
+                                     TransformComponent& transform) {
+  position.x += velocity.dx * 0.016f;
+  position.y += velocity.dy * 0.016f;
+  transform.model[3][0] = position.x;
+  transform.model[3][1] = position.y;
+};
+
+void BM_PoolRegistryIterate(benchmark::State& state) {
+  auto registry = createPopulatedRegistry<Registry>(state.range(0));
+  for (auto _ : state) {
+    registry->updateComponents<PositionComponent, VelocityComponent, TransformComponent>(
+        updateComponents);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ArchetypeRegistryIterate(benchmark::State& state) {
+  auto registry = createPopulatedRegistry<ArchetypeRegistry>(state.range(0));
+  for (auto _ : state) {
+    registry->updateComponents<PositionComponent, VelocityComponent, TransformComponent>(
+        updateComponents);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_PoolRegistryPopulate(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(createPopulatedRegistry<Registry>(state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ArchetypeRegistryPopulate(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(createPopulatedRegistry<ArchetypeRegistry>(state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_PoolRegistryIterate)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+BENCHMARK(BM_ArchetypeRegistryIterate)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+BENCHMARK(BM_PoolRegistryPopulate)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+BENCHMARK(BM_ArchetypeRegistryPopulate)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
@@ -0,0 +1,252 @@
+#include <benchmark/benchmark.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "common/scene/linear_octree.h"
+#include "common/scene/loose_octree.h"
+#include "common/scene/octree.h"
+#include "common/scene/scene.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+constexpr AABB WORLD_VOLUME = {.lowerCorner = glm::vec3(-1000.0f),
+                               .upperCorner = glm::vec3(1000.0f)};
+
+struct SceneObjects {
+  std::vector<std::unique_ptr<Object>> objects;
+  std::vector<LinearOctree::Entry> entries;
+};
+
+// Small objects scattered uniformly over the world.
+const SceneObjects& getSceneObjects(size_t count) {
+  static std::unique_ptr<SceneObjects> scene;
+  if (!scene || scene->entries.size() != count) {
+    scene = std::make_unique<SceneObjects>();
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-995.0f, 995.0f);
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+    for (size_t i = 0; i < count; ++i) {
+      scene->objects.push_back(std::make_unique<Object>("object", static_cast<Entity>(i)));
+      const glm::vec3 lower(position(random), position(random), position(random));
+      scene->entries.push_back({scene->objects.back().get(), AABB{lower, lower + size(random)}});
+    }
+  }
+  return *scene;
+}
+
+std::array<glm::vec4, NUM_CUBE_FACES> getFrustumPlanes() {
+  return extractFrustumPlanes(
+      glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 800.0f)
+      * glm::lookAt(glm::vec3(0.0f, 50.0f, -900.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+}
+
+void queryOctree(const OctreeNode* node, std::span<const glm::vec4> planes,
+                 std::vector<const Object*>& objects) {
+  if (!node || !node->getVolume().intersectsFrustum(planes)) {
+    return;
+  }
+  objects.insert(objects.end(), node->getObjects().cbegin(), node->getObjects().cend());
+  for (size_t i = 0; i < NUM_OCTREE_NODE_CHILDREN; ++i) {
+    queryOctree(node->getChild(static_cast<OctreeNode::Subvolume>(i)), planes, objects);
+  }
+}
+
+void BM_OctreeBuild(benchmark::State& state) {
+  const SceneObjects& scene = getSceneObjects(state.range(0));
+  for (auto _ : state) {
+    Octree octree(WORLD_VOLUME);
+    for (const LinearOctree::Entry& entry : scene.entries) {
+      octree.addObject(entry.object, entry.volume);
+    }
+    benchmark::DoNotOptimize(octree.getRoot());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LinearOctreeBuild(benchmark::State& state) {
+  const SceneObjects& scene = getSceneObjects(state.range(0));
+  lib::ThreadPool threadPool(state.range(1) - 1);
+  LinearOctree octree(WORLD_VOLUME);
+  for (auto _ : state) {
+    octree.build(scene.entries, state.range(1) > 1 ? &threadPool : nullptr);
+    benchmark::DoNotOptimize(octree.getNodes().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_OctreeQuery(benchmark::State& state) {
+  const SceneObjects& scene = getSceneObjects(state.range(0));
+  Octree octree(WORLD_VOLUME);
+  for (const LinearOctree::Entry& entry : scene.entries) {
+    octree.addObject(entry.object, entry.volume);
+  }
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = getFrustumPlanes();
+  std::vector<const Object*> visible;
+  for (auto _ : state) {
+    visible.clear();
+    queryOctree(octree.getRoot(), planes, visible);
+    benchmark::DoNotOptimize(visible.data());
+  }
+  state.counters["visible"] = static_cast<double>(visible.size());
+}
+
+void BM_LinearOctreeQuery(benchmark::State& state) {
+  const SceneObjects& scene = getSceneObjects(state.range(0));
+  LinearOctree octree(WORLD_VOLUME);
+  octree.build(scene.entries);
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = getFrustumPlanes();
+  std::vector<const Object*> visible;
+  for (auto _ : state) {
+    visible.clear();
+    octree.query(planes, visible);
+    benchmark::DoNotOptimize(visible.data());
+  }
+  state.counters["visible"] = static_cast<double>(visible.size());
+}
+
+void BM_SceneCull(benchmark::State& state) {
+  lib::ThreadPool threadPool(state.range(1) - 1);
+  Scene scene(WORLD_VOLUME);
+  scene.build(getSceneObjects(state.range(0)).entries);
+  if (state.range(1) > 1) {
+    scene.setThreadPool(&threadPool);
+  }
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = getFrustumPlanes();
+  std::vector<const Object*> visible;
+  for (auto _ : state) {
+    visible.clear();
+    scene.cull(planes, visible);
+    benchmark::DoNotOptimize(visible.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["visible"] = static_cast<double>(visible.size());
+}
+
+// Both XR eyes, the first shadow cascade covering their first 300 units and the camera, culled
+// in one traversal or view by view. Culled view by view, every view keeps its own list.
+std::vector<Frustum> getViewFrustums(size_t count) {
+  const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 800.0f);
+  const glm::vec3 up(0.0f, 1.0f, 0.0f);
+  const std::array<Frustum, 4> frustums = {
+    extractFrustumPlanes(projection
+                         * glm::lookAt(glm::vec3(-0.03f, 50.0f, -900.0f), glm::vec3(0.0f), up)),
+    extractFrustumPlanes(projection
+                         * glm::lookAt(glm::vec3(0.03f, 50.0f, -900.0f), glm::vec3(0.0f), up)),
+    extractFrustumPlanes(glm::ortho(-310.0f, 310.0f, -150.0f, 150.0f, 0.0f, 1140.0f)
+                         * glm::lookAt(glm::vec3(0.0f, 1000.0f, -750.0f),
+                                       glm::vec3(0.0f, 0.0f, -750.0f),
+                                       glm::vec3(0.0f, 0.0f, 1.0f))),
+    getFrustumPlanes()};
+  return std::vector<Frustum>(frustums.cbegin(), frustums.cbegin() + count);
+}
+
+void BM_SceneCullViews(benchmark::State& state) {
+  Scene scene(WORLD_VOLUME);
+  scene.build(getSceneObjects(1'000'000).entries);
+  const std::vector<Frustum> frustums = getViewFrustums(state.range(0));
+  std::vector<VisibleObject> visible;
+  for (auto _ : state) {
+    visible.clear();
+    scene.cullViews(frustums, visible);
+    benchmark::DoNotOptimize(visible.data());
+  }
+  state.counters["visible"] = static_cast<double>(visible.size());
+}
+
+void BM_SceneCullEachView(benchmark::State& state) {
+  Scene scene(WORLD_VOLUME);
+  scene.build(getSceneObjects(1'000'000).entries);
+  const std::vector<Frustum> frustums = getViewFrustums(state.range(0));
+  std::vector<std::vector<const Object*>> visible(frustums.size());
+  for (auto _ : state) {
+    for (size_t view = 0; view < frustums.size(); ++view) {
+      visible[view].clear();
+      scene.cull(frustums[view], visible[view]);
+      benchmark::DoNotOptimize(visible[view].data());
+    }
+  }
+}
+
+constexpr size_t MOVING_SCENE_SIZE = 100'000;
+
+// Moves state.range(0) percent of the objects by a small step, the original Octree has to be
+// rebuilt for that.
+void BM_OctreeMove(benchmark::State& state) {
+  std::vector<LinearOctree::Entry> entries = getSceneObjects(MOVING_SCENE_SIZE).entries;
+  const size_t movingCount = MOVING_SCENE_SIZE * state.range(0) / 100;
+  for (auto _ : state) {
+    for (size_t i = 0; i < movingCount; ++i) {
+      entries[i].volume.lowerCorner.x += 0.1f;
+      entries[i].volume.upperCorner.x += 0.1f;
+    }
+    Octree octree(WORLD_VOLUME);
+    for (const LinearOctree::Entry& entry : entries) {
+      octree.addObject(entry.object, entry.volume);
+    }
+    benchmark::DoNotOptimize(octree.getRoot());
+  }
+  state.SetItemsProcessed(state.iterations() * movingCount);
+}
+
+void BM_LooseOctreeMove(benchmark::State& state) {
+  std::vector<LinearOctree::Entry> entries = getSceneObjects(MOVING_SCENE_SIZE).entries;
+  const size_t movingCount = MOVING_SCENE_SIZE * state.range(0) / 100;
+  LooseOctree octree(WORLD_VOLUME);
+  std::vector<LooseOctree::Handle> handles;
+  for (const LinearOctree::Entry& entry : entries) {
+    handles.push_back(octree.insert(entry.object, entry.volume));
+  }
+  for (auto _ : state) {
+    for (size_t i = 0; i < movingCount; ++i) {
+      AABB& volume = entries[i].volume;
+      volume.lowerCorner.x += 0.1f;
+      volume.upperCorner.x += 0.1f;
+      octree.update(handles[i], volume);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * movingCount);
+}
+
+void BM_LooseOctreeQuery(benchmark::State& state) {
+  const SceneObjects& scene = getSceneObjects(state.range(0));
+  LooseOctree octree(WORLD_VOLUME);
+  for (const LinearOctree::Entry& entry : scene.entries) {
+    octree.insert(entry.object, entry.volume);
+  }
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = getFrustumPlanes();
+  std::vector<const Object*> visible;
+  for (auto _ : state) {
+    visible.clear();
+    octree.query(planes, visible);
+    benchmark::DoNotOptimize(visible.data());
+  }
+  state.counters["visible"] = static_cast<double>(visible.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_OctreeBuild)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LinearOctreeBuild)
+    ->ArgNames({"objects", "threads"})
+    ->Args({100'000, 1})
+    ->Args({1'000'000, 1})
+    ->Args({1'000'000, 4})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OctreeQuery)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LinearOctreeQuery)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LooseOctreeQuery)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_OctreeMove)->ArgName("moving%")->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LooseOctreeMove)->ArgName("moving%")->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SceneCull)
+    ->ArgNames({"objects", "threads"})
+    ->Args({1'000'000, 1})
+    ->Args({1'000'000, 4})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SceneCullViews)->ArgName("views")->DenseRange(1, 4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SceneCullEachView)->ArgName("views")->DenseRange(1, 4)->Unit(benchmark::kMicrosecond);
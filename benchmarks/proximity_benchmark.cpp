@@ -0,0 +1,152 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "common/scene/octree.h"
+#include "common/scene/spatial_hash_grid.h"
+
+namespace {
+
+constexpr AABB WORLD_VOLUME = {.lowerCorner = glm::vec3(-1000.0f),
+                               .upperCorner = glm::vec3(1000.0f)};
+constexpr size_t OBJECT_COUNT = 100'000;
+constexpr size_t QUERY_COUNT = 1000;
+constexpr float QUERY_RADIUS = 20.0f;
+constexpr float CELL_SIZE = 16.0f;
+
+// Objects wandering around the world, volumes are indexed by entity.
+struct MovingObjects {
+  std::vector<std::unique_ptr<Object>> objects;
+  std::vector<AABB> volumes;
+  std::vector<glm::vec3> velocities;
+  std::vector<glm::vec4> queries;
+
+  MovingObjects() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-990.0f, 990.0f);
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+    std::uniform_real_distribution<float> speed(-0.5f, 0.5f);
+    for (size_t i = 0; i < OBJECT_COUNT; ++i) {
+      objects.push_back(std::make_unique<Object>("object", static_cast<Entity>(i)));
+      const glm::vec3 lower(position(random), position(random), position(random));
+      volumes.push_back(AABB{lower, lower + size(random)});
+      velocities.emplace_back(speed(random), speed(random), speed(random));
+    }
+    for (size_t i = 0; i < QUERY_COUNT; ++i) {
+      queries.emplace_back(volumes[i * 97].lowerCorner, QUERY_RADIUS);
+    }
+  }
+
+  void move(size_t movingCount) {
+    for (size_t i = 0; i < movingCount; ++i) {
+      volumes[i].lowerCorner += velocities[i];
+      volumes[i].upperCorner += velocities[i];
+    }
+  }
+};
+
+bool intersectsSphere(const AABB& volume, const glm::vec4& sphere) {
+  const glm::vec3 center(sphere);
+  const glm::vec3 offset = glm::clamp(center, volume.lowerCorner, volume.upperCorner) - center;
+  return glm::dot(offset, offset) <= sphere.w * sphere.w;
+}
+
+void queryOctree(const OctreeNode* node, const glm::vec4& sphere, std::span<const AABB> volumes,
+                 std::vector<const Object*>& objects) {
+  if (!node || !intersectsSphere(node->getVolume(), sphere)) {
+    return;
+  }
+  for (const Object* object : node->getObjects()) {
+    if (intersectsSphere(volumes[object->getEntity()], sphere)) {
+      objects.push_back(object);
+    }
+  }
+  for (size_t i = 0; i < NUM_OCTREE_NODE_CHILDREN; ++i) {
+    queryOctree(node->getChild(static_cast<OctreeNode::Subvolume>(i)), sphere, volumes, objects);
+  }
+}
+
+// One frame: state.range(0) percent of the objects move, then every query runs. The Octree has
+// no update and is rebuilt.
+void BM_OctreeProximity(benchmark::State& state) {
+  MovingObjects scene;
+  const size_t movingCount = OBJECT_COUNT * state.range(0) / 100;
+  std::vector<const Object*> objects;
+  for (auto _ : state) {
+    scene.move(movingCount);
+    Octree octree(WORLD_VOLUME);
+    for (size_t i = 0; i < OBJECT_COUNT; ++i) {
+      octree.addObject(scene.objects[i].get(), scene.volumes[i]);
+    }
+    objects.clear();
+    for (const glm::vec4& query : scene.queries) {
+      queryOctree(octree.getRoot(), query, scene.volumes, objects);
+    }
+    benchmark::DoNotOptimize(objects.data());
+  }
+  state.counters["found"] = static_cast<double>(objects.size());
+}
+
+void BM_SpatialHashGridProximity(benchmark::State& state) {
+  MovingObjects scene;
+  const size_t movingCount = OBJECT_COUNT * state.range(0) / 100;
+  SpatialHashGrid grid(CELL_SIZE);
+  std::vector<SpatialHashGrid::Handle> handles;
+  for (size_t i = 0; i < OBJECT_COUNT; ++i) {
+    handles.push_back(grid.insert(scene.objects[i].get(), scene.volumes[i]));
+  }
+  GridQueryResults results;
+  for (auto _ : state) {
+    scene.move(movingCount);
+    for (size_t i = 0; i < movingCount; ++i) {
+      grid.update(handles[i], scene.volumes[i]);
+    }
+    grid.queryRadius(scene.queries, results);
+    benchmark::DoNotOptimize(results.objects.data());
+  }
+  state.counters["found"] = static_cast<double>(results.objects.size());
+}
+
+void BM_SpatialHashGridUpdate(benchmark::State& state) {
+  MovingObjects scene;
+  SpatialHashGrid grid(CELL_SIZE);
+  std::vector<SpatialHashGrid::Handle> handles;
+  for (size_t i = 0; i < OBJECT_COUNT; ++i) {
+    handles.push_back(grid.insert(scene.objects[i].get(), scene.volumes[i]));
+  }
+  for (auto _ : state) {
+    scene.move(OBJECT_COUNT);
+    for (size_t i = 0; i < OBJECT_COUNT; ++i) {
+      grid.update(handles[i], scene.volumes[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * OBJECT_COUNT);
+}
+
+void BM_SpatialHashGridQuery(benchmark::State& state) {
+  MovingObjects scene;
+  SpatialHashGrid grid(CELL_SIZE);
+  for (size_t i = 0; i < OBJECT_COUNT; ++i) {
+    grid.insert(scene.objects[i].get(), scene.volumes[i]);
+  }
+  GridQueryResults results;
+  for (auto _ : state) {
+    grid.queryRadius(scene.queries, results);
+    benchmark::DoNotOptimize(results.objects.data());
+  }
+  state.SetItemsProcessed(state.iterations() * QUERY_COUNT);
+  state.counters["found"] = static_cast<double>(results.objects.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_OctreeProximity)->ArgName("moving%")->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SpatialHashGridProximity)
+    ->ArgName("moving%")
+    ->Arg(10)
+    ->Arg(100)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SpatialHashGridUpdate)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SpatialHashGridQuery)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,180 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "common/entity_component_system/component/hierarchy.h"
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/registry.h"
+#include "common/entity_component_system/system/movement_system.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+constexpr size_t ENTITY_COUNT = 100'000;
+
+std::vector<Entity> createEntities(Registry& registry, size_t count) {
+  std::vector<Entity> entities(count);
+  for (Entity& entity : entities) {
+    entity = registry.createEntity();
+  }
+  return entities;
+}
+
+// Keeps ENTITY_COUNT entities alive while state.range(0) random ones are destroyed and created
+// again every iteration.
+void BM_RegistryChurn(benchmark::State& state) {
+  Registry registry(ENTITY_COUNT);
+  std::vector<Entity> entities = createEntities(registry, ENTITY_COUNT);
+  for (Entity entity : entities) {
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+  }
+  std::mt19937 random(42);
+  std::uniform_int_distribution<size_t> distribution(0, ENTITY_COUNT - 1);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      Entity& entity = entities[distribution(random)];
+      registry.destroyEntity(entity);
+      entity = registry.createEntity();
+      registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_RegistryAddComponent(benchmark::State& state) {
+  Registry registry(state.range(0));
+  const std::vector<Entity> entities = createEntities(registry, state.range(0));
+  for (auto _ : state) {
+    for (Entity entity : entities) {
+      registry.addComponent(entity, VelocityComponent{.dx = 1.0f, .dy = 2.0f});
+    }
+    state.PauseTiming();
+    for (Entity entity : entities) {
+      registry.removeComponent<VelocityComponent>(entity);
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_RegistryGetComponentRandom(benchmark::State& state) {
+  Registry registry(state.range(0));
+  std::vector<Entity> entities = createEntities(registry, state.range(0));
+  for (Entity entity : entities) {
+    registry.addComponent(entity, PositionComponent{.x = 1.0f, .y = 0.0f});
+  }
+  std::shuffle(entities.begin(), entities.end(), std::mt19937(42));
+  for (auto _ : state) {
+    float sum = 0.0f;
+    for (Entity entity : entities) {
+      sum += registry.getComponent<PositionComponent>(entity).x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Every entity owns a PositionComponent, state.range(0) percent of them own all four components.
+template <typename... Components>
+void BM_RegistryUpdateComponents(benchmark::State& state) {
+  Registry registry(ENTITY_COUNT);
+  const std::vector<Entity> entities = createEntities(registry, ENTITY_COUNT);
+  std::mt19937 random(42);
+  std::bernoulli_distribution matches(state.range(0) / 100.0);
+  for (Entity entity : entities) {
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+    if (matches(random)) {
+      registry.addComponent(entity, VelocityComponent{.dx = 1.0f, .dy = 2.0f});
+      registry.addComponent(
+          entity, TransformComponent{.model = glm::mat4(1.0f), .world = glm::mat4(1.0f)});
+      registry.addComponent(entity, HierarchyComponent{});
+    }
+  }
+  for (auto _ : state) {
+    registry.updateComponents<Components...>([](Components&... components) {
+      (benchmark::DoNotOptimize(components), ...);
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * ENTITY_COUNT);
+}
+
+// Iterates Position, Velocity and Transform of the 50% of entities owning all three, either
+// through a view (state.range(0) == 0) or an owning group.
+void BM_RegistryGroupIterate(benchmark::State& state) {
+  Registry registry(ENTITY_COUNT);
+  const std::vector<Entity> entities = createEntities(registry, ENTITY_COUNT);
+  for (size_t i = 0; i < entities.size(); ++i) {
+    registry.addComponent(entities[i], PositionComponent{.x = 0.0f, .y = 0.0f});
+    registry.addComponent(
+        entities[i], TransformComponent{.model = glm::mat4(1.0f), .world = glm::mat4(1.0f)});
+    if (i % 2 == 0) {
+      registry.addComponent(entities[i], VelocityComponent{.dx = 1.0f, .dy = 2.0f});
+    }
+  }
+  const auto update = [](PositionComponent& position, const VelocityComponent& velocity,
+                         TransformComponent& transform) {
+    position.x += velocity.dx;
+    transform.model[3][0] = position.x;
+  };
+  if (state.range(0)) {
+    const auto group =
+        registry.group<PositionComponent, const VelocityComponent, TransformComponent>().value();
+    for (auto _ : state) {
+      group.each(update);
+      benchmark::ClobberMemory();
+    }
+  } else {
+    const auto view =
+        registry.view<PositionComponent, const VelocityComponent, TransformComponent>();
+    for (auto _ : state) {
+      view.each(update);
+      benchmark::ClobberMemory();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ENTITY_COUNT / 2);
+}
+
+void BM_MovementSystem(benchmark::State& state) {
+  Registry registry(state.range(0));
+  for (Entity entity : createEntities(registry, state.range(0))) {
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+    registry.addComponent(entity, VelocityComponent{.dx = 1.0f, .dy = 2.0f});
+  }
+  lib::ThreadPool threadPool(state.range(1) - 1);
+  MovementSystem system(&registry);
+  if (state.range(1) > 1) {
+    system.setThreadPool(&threadPool);
+  }
+  for (auto _ : state) {
+    system.update(0.016f);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_RegistryChurn)->Arg(1'000)->Arg(10'000);
+BENCHMARK(BM_RegistryAddComponent)->Arg(10'000)->Arg(100'000);
+BENCHMARK(BM_RegistryGetComponentRandom)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+BENCHMARK(BM_RegistryUpdateComponents<PositionComponent>)
+    ->ArgName("match%")->Arg(100)->Arg(50)->Arg(10);
+BENCHMARK(BM_RegistryUpdateComponents<PositionComponent, VelocityComponent>)
+    ->ArgName("match%")->Arg(100)->Arg(50)->Arg(10);
+BENCHMARK(
+    BM_RegistryUpdateComponents<PositionComponent, VelocityComponent, TransformComponent>)
+    ->ArgName("match%")->Arg(100)->Arg(50)->Arg(10);
+BENCHMARK(BM_RegistryUpdateComponents<PositionComponent, VelocityComponent, TransformComponent,
+                                      HierarchyComponent>)
+    ->ArgName("match%")->Arg(100)->Arg(50)->Arg(10);
+BENCHMARK(BM_RegistryGroupIterate)->ArgName("group")->Arg(0)->Arg(1);
+BENCHMARK(BM_MovementSystem)
+    ->ArgNames({"entities", "threads"})
+    ->Args({100'000, 1})
+    ->Args({1'000'000, 1})
+    ->Args({1'000'000, 4})
+    ->UseRealTime();
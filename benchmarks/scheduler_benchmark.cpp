@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/system/scheduler.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+constexpr size_t ELEMENTS_PER_SYSTEM = 1 << 18;
+constexpr size_t GRAIN_SIZE = 4096;
+
+// Synthetic system with a fixed amount of arithmetic per element, so the benchmark measures
+// scheduling and parallel speedup rather than memory bandwidth.
+class WorkloadSystem : public System {
+  std::vector<float> _data;
+  SystemAccess _access;
+
+public:
+  explicit WorkloadSystem(SystemAccess access)
+    : _data(ELEMENTS_PER_SYSTEM, 1.0f), _access(access) {}
+
+  void update(float deltaTime) override {
+    const auto work = [this, deltaTime](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        float value = _data[i];
+        for (int j = 0; j < 16; ++j) {
+          value = std::sqrt(value * value + deltaTime);
+        }
+        _data[i] = value;
+      }
+    };
+    _threadPool->parallelFor(_data.size(), GRAIN_SIZE, work);
+  }
+
+  SystemAccess getAccess() const override {
+    return _access;
+  }
+};
+
+void BM_SchedulerUpdate(benchmark::State& state) {
+  lib::ThreadPool threadPool(state.range(0) - 1);
+  Scheduler scheduler(threadPool);
+
+  const Signature position = getSignature<PositionComponent>();
+  const Signature velocity = getSignature<VelocityComponent>();
+  const Signature transform = getSignature<TransformComponent>();
+  std::vector<std::unique_ptr<WorkloadSystem>> systems;
+  systems.push_back(std::make_unique<WorkloadSystem>(
+      SystemAccess{.reads = velocity, .writes = position, .exclusive = false}));
+  systems.push_back(std::make_unique<WorkloadSystem>(
+      SystemAccess{.reads = velocity, .writes = transform, .exclusive = false}));
+  systems.push_back(std::make_unique<WorkloadSystem>(
+      SystemAccess{.reads = position | transform, .writes = Signature(), .exclusive = false}));
+  systems.push_back(std::make_unique<WorkloadSystem>(
+      SystemAccess{.reads = Signature(), .writes = velocity, .exclusive = false}));
+  for (const std::unique_ptr<WorkloadSystem>& system : systems) {
+    scheduler.addSystem(system.get());
+  }
+
+  for (auto _ : state) {
+    scheduler.update(0.016f);
+  }
+  state.SetItemsProcessed(state.iterations() * systems.size() * ELEMENTS_PER_SYSTEM);
+}
+
+}  // namespace
+
+BENCHMARK(BM_SchedulerUpdate)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/registry.h"
+
+namespace {
+
+std::string getSnapshotPath() {
+  return (std::filesystem::temp_directory_path() / "bejzak_benchmark_snapshot.bin").string();
+}
+
+void populate(Registry& registry, size_t count) {
+  for (Entity entity : registry.createEntities(count)) {
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+    registry.addComponent(entity, VelocityComponent{.dx = 1.0f, .dy = 2.0f});
+    registry.addComponent(
+        entity, TransformComponent{.model = glm::mat4(1.0f), .world = glm::mat4(1.0f)});
+  }
+}
+
+void BM_RegistrySerialize(benchmark::State& state) {
+  Registry registry(state.range(0));
+  populate(registry, state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(registry.serialize(getSnapshotPath()));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::filesystem::remove(getSnapshotPath());
+}
+
+// Restores a level from a memory mapped snapshot, the file stays in the page cache.
+void BM_RegistryDeserialize(benchmark::State& state) {
+  {
+    Registry registry(state.range(0));
+    populate(registry, state.range(0));
+    if (!registry.serialize(getSnapshotPath())) {
+      state.SkipWithError("Failed to write the snapshot");
+      return;
+    }
+  }
+  Registry registry;
+  for (auto _ : state) {
+    const Status status =
+        registry.deserialize<PositionComponent, VelocityComponent, TransformComponent>(
+            getSnapshotPath());
+    benchmark::DoNotOptimize(status);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::filesystem::remove(getSnapshotPath());
+}
+
+}  // namespace
+
+BENCHMARK(BM_RegistrySerialize)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RegistryDeserialize)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/registry.h"
+#include "common/entity_component_system/system/movement_system.h"
+#include "lib/simd/kernels.h"
+
+namespace {
+
+constexpr size_t ENTITY_COUNT = 1'000'000;
+
+// Integrates ENTITY_COUNT entities on a single core with the kernels of state.range(0).
+void BM_MovementKernel(benchmark::State& state) {
+  const lib::SimdLevel previous = lib::getSimdLevel();
+  if (!lib::setSimdLevel(static_cast<lib::SimdLevel>(state.range(0)))) {
+    state.SkipWithError("Instruction set not supported");
+    return;
+  }
+  Registry registry(ENTITY_COUNT);
+  for (Entity entity : registry.createEntities(ENTITY_COUNT)) {
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+    registry.addComponent(entity, VelocityComponent{.dx = 1.0f, .dy = 2.0f});
+  }
+  MovementSystem system(&registry);
+  for (auto _ : state) {
+    system.update(0.016f);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * ENTITY_COUNT);
+  lib::setSimdLevel(previous);
+}
+
+void BM_KernelClamp(benchmark::State& state) {
+  const lib::SimdLevel previous = lib::getSimdLevel();
+  if (!lib::setSimdLevel(static_cast<lib::SimdLevel>(state.range(0)))) {
+    state.SkipWithError("Instruction set not supported");
+    return;
+  }
+  std::vector<float> values(ENTITY_COUNT * 2, 2.0f);
+  for (auto _ : state) {
+    lib::clamp(values.data(), -1.0f, 1.0f, values.size());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+  lib::setSimdLevel(previous);
+}
+
+void simdLevels(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("level");
+  for (lib::SimdLevel level : {lib::SimdLevel::SCALAR, lib::SimdLevel::SSE,
+                               lib::SimdLevel::AVX2, lib::SimdLevel::NEON}) {
+    benchmark->Arg(static_cast<int64_t>(level));
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_MovementKernel)->Apply(simdLevels)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_KernelClamp)->Apply(simdLevels)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/registry.h"
+
+namespace {
+
+// Every iteration spawns state.range(0) entities with three components into a registry with a
+// live view, then destroys them outside of the timed region.
+template <typename Spawn>
+void runSpawnBenchmark(benchmark::State& state, Spawn&& spawn) {
+  const size_t count = state.range(0);
+  Registry registry(count);
+  const auto view = registry.view<PositionComponent, VelocityComponent, TransformComponent>();
+  std::vector<Entity> entities(count);
+  for (auto _ : state) {
+    spawn(registry, entities);
+    benchmark::DoNotOptimize(view.size());
+    state.PauseTiming();
+    for (Entity entity : entities) {
+      registry.destroyEntity(entity);
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Source components as a scene loader would have them after parsing.
+struct SpawnData {
+  std::vector<PositionComponent> positions;
+  std::vector<VelocityComponent> velocities;
+  std::vector<TransformComponent> transforms;
+
+  explicit SpawnData(size_t count)
+    : positions(count, PositionComponent{.x = 0.0f, .y = 0.0f}),
+      velocities(count, VelocityComponent{.dx = 1.0f, .dy = 2.0f}),
+      transforms(count, TransformComponent{.model = glm::mat4(1.0f), .world = glm::mat4(1.0f)}) {}
+};
+
+void BM_SpawnIndividually(benchmark::State& state) {
+  const SpawnData data(state.range(0));
+  runSpawnBenchmark(state, [&data](Registry& registry, std::vector<Entity>& entities) {
+    for (size_t i = 0; i < entities.size(); ++i) {
+      const Entity entity = entities[i] = registry.createEntity();
+      registry.addComponent(entity, PositionComponent(data.positions[i]));
+      registry.addComponent(entity, VelocityComponent(data.velocities[i]));
+      registry.addComponent(entity, TransformComponent(data.transforms[i]));
+    }
+  });
+}
+
+void BM_SpawnBatched(benchmark::State& state) {
+  const SpawnData data(state.range(0));
+  runSpawnBenchmark(state, [&data](Registry& registry, std::vector<Entity>& entities) {
+    registry.createEntities(entities);
+    registry.addComponents<PositionComponent>(entities, data.positions);
+    registry.addComponents<VelocityComponent>(entities, data.velocities);
+    registry.addComponents<TransformComponent>(entities, data.transforms);
+  });
+}
+
+void BM_SpawnFromPrefab(benchmark::State& state) {
+  Registry* prefabRegistry = nullptr;
+  Entity prefab = NULL_ENTITY;
+  runSpawnBenchmark(state, [&](Registry& registry, std::vector<Entity>& entities) {
+    if (prefabRegistry != &registry) [[unlikely]] {
+      prefabRegistry = &registry;
+      prefab = registry.createEntity();
+      registry.addComponent(prefab, PositionComponent{.x = 0.0f, .y = 0.0f});
+      registry.addComponent(prefab, VelocityComponent{.dx = 1.0f, .dy = 2.0f});
+      registry.addComponent(
+          prefab, TransformComponent{.model = glm::mat4(1.0f), .world = glm::mat4(1.0f)});
+    }
+    static_cast<void>(registry.instantiate(prefab, entities));
+  });
+}
+
+}  // namespace
+
+BENCHMARK(BM_SpawnIndividually)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SpawnBatched)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SpawnFromPrefab)->Arg(100000)->Unit(benchmark::kMillisecond);
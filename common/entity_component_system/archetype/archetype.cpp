@@ -0,0 +1,105 @@
+#include "archetype.h"
+
+namespace {
+
+constexpr size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+size_t computeLayout(
+    size_t capacity, std::span<const ComponentType> types,
+    std::span<const ComponentInfo, MAX_COMPONENTS> infos,
+    std::array<size_t, MAX_COMPONENTS>& offsets) {
+  size_t offset = capacity * sizeof(Entity);
+  for (ComponentType type : types) {
+    offset = alignUp(offset, infos[type].alignment);
+    offsets[type] = offset;
+    offset += capacity * infos[type].size;
+  }
+  return offset;
+}
+
+}  // namespace
+
+Archetype::Archetype(
+    Signature signature, std::span<const ComponentInfo, MAX_COMPONENTS> componentInfos)
+  : _signature(signature) {
+  size_t rowSize = sizeof(Entity);
+  for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+    if (signature.test(type)) {
+      _componentTypes.push_back(type);
+      _componentInfos[type] = componentInfos[type];
+      rowSize += componentInfos[type].size;
+    }
+  }
+
+  _chunkCapacity = ARCHETYPE_CHUNK_SIZE / rowSize;
+  while (computeLayout(_chunkCapacity, _componentTypes, componentInfos, _columnOffsets)
+         > ARCHETYPE_CHUNK_SIZE) {
+    --_chunkCapacity;
+  }
+}
+
+Archetype::~Archetype() {
+  for (size_t row = 0; row < _size; ++row) {
+    for (ComponentType type : _componentTypes) {
+      _componentInfos[type].destroy(getAddress(type, row));
+    }
+  }
+}
+
+std::byte* Archetype::getAddress(ComponentType type, size_t row) const {
+  const size_t chunkIndex = row / _chunkCapacity;
+  const size_t chunkRow = row % _chunkCapacity;
+  return _chunks[chunkIndex]->data + _columnOffsets[type] + chunkRow * _componentInfos[type].size;
+}
+
+Entity* Archetype::getEntities(size_t chunkIndex) const {
+  return reinterpret_cast<Entity*>(_chunks[chunkIndex]->data);
+}
+
+size_t Archetype::allocate(Entity entity) {
+  const size_t row = _size++;
+  if (row == _chunks.size() * _chunkCapacity) {
+    _chunks.push_back(std::make_unique_for_overwrite<ArchetypeChunk>());
+  }
+  getEntities(row / _chunkCapacity)[row % _chunkCapacity] = entity;
+  return row;
+}
+
+Entity Archetype::remove(size_t row) {
+  for (ComponentType type : _componentTypes) {
+    _componentInfos[type].destroy(getAddress(type, row));
+  }
+
+  const size_t lastRow = --_size;
+  Entity& entity = getEntities(row / _chunkCapacity)[row % _chunkCapacity];
+  if (row != lastRow) {
+    for (ComponentType type : _componentTypes) {
+      std::byte* last = getAddress(type, lastRow);
+      _componentInfos[type].moveConstruct(getAddress(type, row), last);
+      _componentInfos[type].destroy(last);
+    }
+    entity = getEntities(lastRow / _chunkCapacity)[lastRow % _chunkCapacity];
+  }
+
+  // Keep spare chunks around so entities moving across a chunk boundary do not reallocate.
+  if (_chunks.size() * _chunkCapacity - _size > 2 * _chunkCapacity) {
+    _chunks.pop_back();
+  }
+  return entity;
+}
+
+size_t Archetype::moveTo(size_t row, Archetype& destination, Entity& movedEntity) {
+  const Entity entity = getEntities(row / _chunkCapacity)[row % _chunkCapacity];
+  const size_t destinationRow = destination.allocate(entity);
+  for (ComponentType type : _componentTypes) {
+    if (destination._signature.test(type)) {
+      _componentInfos[type].moveConstruct(
+          destination.getAddress(type, destinationRow), getAddress(type, row));
+    }
+  }
+  // Moved-from components are still alive and get destroyed together with the row.
+  movedEntity = remove(row);
+  return destinationRow;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "common/entity_component_system/component/component_types.h"
+#include "common/entity_component_system/entity/entity.h"
+
+constexpr size_t ARCHETYPE_CHUNK_SIZE = 16 * 1024;
+constexpr size_t ARCHETYPE_CHUNK_ALIGNMENT = 64;
+
+// Type-erased description of a component, used to move components between archetypes.
+struct ComponentInfo {
+  size_t size = 0;
+  size_t alignment = 0;
+  void (*moveConstruct)(void* dst, void* src) = nullptr;
+  void (*destroy)(void* ptr) = nullptr;
+
+  template <typename Component>
+  static constexpr ComponentInfo create() {
+    static_assert(std::is_nothrow_move_constructible_v<Component>,
+                  "Archetype components have to be nothrow move constructible");
+    static_assert(sizeof(Component) + sizeof(Entity) + alignof(Component) <= ARCHETYPE_CHUNK_SIZE,
+                  "Component does not fit into a single archetype chunk");
+    return ComponentInfo{
+      .size = sizeof(Component),
+      .alignment = alignof(Component),
+      .moveConstruct =
+          [](void* dst, void* src) {
+            new (dst) Component(std::move(*static_cast<Component*>(src)));
+          },
+      .destroy =
+          [](void* ptr) {
+            static_cast<Component*>(ptr)->~Component();
+          }};
+  }
+};
+
+struct alignas(ARCHETYPE_CHUNK_ALIGNMENT) ArchetypeChunk {
+  std::byte data[ARCHETYPE_CHUNK_SIZE];
+};
+
+// Stores all entities sharing one Signature in fixed-size chunks. Every chunk holds an entity
+// column followed by one tightly packed column per component (SoA), so iterating a chunk walks
+// each column linearly. Rows are kept dense: all chunks but the last one are always full.
+class Archetype {
+  Signature _signature;
+  std::vector<ComponentType> _componentTypes;
+  std::array<size_t, MAX_COMPONENTS> _columnOffsets{};
+  std::array<ComponentInfo, MAX_COMPONENTS> _componentInfos{};
+  size_t _chunkCapacity = 0;
+  size_t _size = 0;
+  std::vector<std::unique_ptr<ArchetypeChunk>> _chunks;
+  std::array<Archetype*, MAX_COMPONENTS> _addEdges{};
+
+  std::byte* getAddress(ComponentType type, size_t row) const;
+
+  Entity* getEntities(size_t chunkIndex) const;
+
+public:
+  Archetype(Signature signature, std::span<const ComponentInfo, MAX_COMPONENTS> componentInfos);
+
+  ~Archetype();
+
+  Archetype(const Archetype&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+
+  // Reserves a row for the entity. Component memory of the row is left uninitialized.
+  size_t allocate(Entity entity);
+
+  // Destroys all components of the row and fills the hole with the last row. Returns the entity
+  // that was moved into the row, or the removed entity itself if it was the last one.
+  Entity remove(size_t row);
+
+  // Moves all components shared with the destination archetype into its newly allocated row and
+  // removes the row from this archetype. Returns the row in the destination archetype.
+  size_t moveTo(size_t row, Archetype& destination, Entity& movedEntity);
+
+  void* getComponent(ComponentType type, size_t row) const {
+    return getAddress(type, row);
+  }
+
+  template <typename Component>
+  Component* getColumn(size_t chunkIndex) const {
+    return reinterpret_cast<Component*>(
+        _chunks[chunkIndex]->data + _columnOffsets[getComponentID<Component>()]);
+  }
+
+  std::span<const Entity> getChunkEntities(size_t chunkIndex) const {
+    return {getEntities(chunkIndex), getChunkSize(chunkIndex)};
+  }
+
+  size_t getChunkSize(size_t chunkIndex) const {
+    return std::min(_chunkCapacity, _size - chunkIndex * _chunkCapacity);
+  }
+
+  size_t getChunkCount() const {
+    return (_size + _chunkCapacity - 1) / _chunkCapacity;
+  }
+
+  size_t getChunkCapacity() const {
+    return _chunkCapacity;
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+  const Signature& getSignature() const {
+    return _signature;
+  }
+
+  Archetype* getAddEdge(ComponentType type) const {
+    return _addEdges[type];
+  }
+
+  void setAddEdge(ComponentType type, Archetype* archetype) {
+    _addEdges[type] = archetype;
+  }
+};
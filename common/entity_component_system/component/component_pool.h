@@ -1,46 +1,232 @@
 #pragma once
 
-#include <array>
-#include <optional>
-#include <set>
-#include <unordered_map>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "common/entity_component_system/entity/entity.h"
+#include "lib/sparse_set/sparse_set.h"
 
-// #include <boost/container/flat_set.hpp>
+using EntitySparseSet = lib::SparseSet<Entity, 4096, ENTITY_INDEX_MASK>;
+
+// Registry ticks at which a component was added and last changed.
+struct ComponentTicks {
+  uint32_t added;
+  uint32_t changed;
+};
 
 class ComponentPool {
+protected:
+  EntitySparseSet _entities;
+
 public:
   virtual void destroyEntity(Entity entity) = 0;
+  virtual void reserve(size_t size) = 0;
+  virtual bool isCopyable() const = 0;
+  // Copies the component of source to every target, none of which may own the component yet.
+  // Pools which are not copyable leave the targets untouched.
+  virtual void cloneComponent(Entity source, std::span<const Entity> targets, uint32_t tick) = 0;
+  // Exchanges the packed positions of two entities owning the component.
+  virtual void swapEntities(Entity lhs, Entity rhs) = 0;
+  virtual void clear() = 0;
+
+  // Raw access used by Registry snapshots. Pools of components which are not trivially copyable
+  // report a component size of 0 and cannot be restored.
+  virtual size_t getComponentSize() const = 0;
+  virtual const void* getComponentData() const = 0;
+  virtual std::span<const ComponentTicks> getTickData() const = 0;
+  // Replaces the content of the pool, components points to entities.size() packed components.
+  virtual void restore(std::span<const Entity> entities, const std::byte* components,
+                       std::span<const ComponentTicks> ticks) = 0;
   virtual ~ComponentPool() = default;
+
+  bool contains(Entity entity) const {
+    return _entities.contains(entity);
+  }
+
+  size_t size() const {
+    return _entities.size();
+  }
+
+  Entity getEntity(size_t index) const {
+    return _entities[index];
+  }
+
+  size_t getIndex(Entity entity) const {
+    return _entities.index(entity);
+  }
+
+  std::span<const Entity> getEntities() const {
+    return _entities.getPacked();
+  }
 };
 
+// Components are packed in the same order as the entities of the sparse set, so memory scales
+// with the number of components instead of the entity capacity. Change ticks are packed next to
+// the components in the same order.
 template <typename Component>
 class ComponentPoolImpl : public ComponentPool {
-  std::vector<std::pair<Entity, Component>> _components;
-  std::array<Entity, MAX_ENTITIES> _entities;  // TODO Try unordered flat map
+  std::vector<Component> _components;
+  std::vector<ComponentTicks> _ticks;
+
+  // Cheaper than vector::insert(end, count, value), which does not vectorize the fill.
+  void appendTicks(size_t count, uint32_t tick) {
+    const size_t size = _ticks.size();
+    _ticks.resize(size + count);
+    std::fill_n(_ticks.begin() + size, count, ComponentTicks{.added = tick, .changed = tick});
+  }
 
 public:
   ~ComponentPoolImpl() override = default;
 
-  void addComponent(Entity entity, Component&& component) {
-    _entities[entity] = _components.size();
-    _components.emplace_back(entity, std::move(component));
+  // Copies lvalues and moves rvalues.
+  template <typename Type>
+  void addComponent(Entity entity, Type&& component, uint32_t tick) {
+    _entities.insert(entity);
+    _components.push_back(std::forward<Type>(component));
+    _ticks.push_back(ComponentTicks{.added = tick, .changed = tick});
+  }
+
+  template <typename Type>
+  void addOrReplaceComponent(Entity entity, Type&& component, uint32_t tick) {
+    if (_entities.contains(entity)) {
+      const size_t index = _entities.index(entity);
+      _components[index] = std::forward<Type>(component);
+      _ticks[index].changed = tick;
+    } else {
+      addComponent(entity, std::forward<Type>(component), tick);
+    }
+  }
+
+  // Leading entities which do not own the component yet are appended with a single contiguous
+  // copy, the rest falls back to addOrReplaceComponent.
+  void addComponents(
+      std::span<const Entity> entities, std::span<const Component> components, uint32_t tick) {
+    assert(entities.size() == components.size());
+    size_t fresh = 0;
+    while (fresh < entities.size() && !_entities.contains(entities[fresh])) {
+      _entities.insert(entities[fresh++]);
+    }
+    _components.insert(_components.end(), components.begin(), components.begin() + fresh);
+    appendTicks(fresh, tick);
+    for (size_t i = fresh; i < entities.size(); ++i) {
+      addOrReplaceComponent(entities[i], Component(components[i]), tick);
+    }
+  }
+
+  bool isCopyable() const override {
+    return std::is_copy_constructible_v<Component>;
+  }
+
+  void cloneComponent(Entity source, std::span<const Entity> targets, uint32_t tick) override {
+    if constexpr (std::is_copy_constructible_v<Component>) {
+      const Component component = getComponent(source);
+      for (Entity entity : targets) {
+        _entities.insert(entity);
+      }
+      _components.insert(_components.end(), targets.size(), component);
+      appendTicks(targets.size(), tick);
+    }
+  }
+
+  void swapEntities(Entity lhs, Entity rhs) override {
+    const size_t lhsIndex = _entities.index(lhs);
+    const size_t rhsIndex = _entities.index(rhs);
+    if (lhsIndex != rhsIndex) {
+      _entities.swap(lhs, rhs);
+      std::swap(_components[lhsIndex], _components[rhsIndex]);
+      std::swap(_ticks[lhsIndex], _ticks[rhsIndex]);
+    }
+  }
+
+  void reserve(size_t size) override {
+    _entities.reserve(size);
+    _components.reserve(size);
+    _ticks.reserve(size);
+  }
+
+  void clear() override {
+    _entities.clear();
+    _components.clear();
+    _ticks.clear();
+  }
+
+  size_t getComponentSize() const override {
+    return std::is_trivially_copyable_v<Component> ? sizeof(Component) : 0;
+  }
+
+  const void* getComponentData() const override {
+    return _components.data();
+  }
+
+  std::span<const ComponentTicks> getTickData() const override {
+    return _ticks;
+  }
+
+  void restore(std::span<const Entity> entities, const std::byte* components,
+               std::span<const ComponentTicks> ticks) override {
+    if constexpr (std::is_trivially_copyable_v<Component>) {
+      _entities.assign(entities);
+      // Aligned blocks are copied without value-initializing the components first.
+      if (reinterpret_cast<uintptr_t>(components) % alignof(Component) == 0) {
+        const Component* first = reinterpret_cast<const Component*>(components);
+        _components.assign(first, first + entities.size());
+      } else {
+        _components.resize(entities.size());
+        std::memcpy(_components.data(), components, entities.size() * sizeof(Component));
+      }
+      _ticks.assign(ticks.begin(), ticks.end());
+    } else {
+      assert(false && "Component is not trivially copyable");
+    }
   }
 
   void destroyEntity(Entity entity) override {
-    Entity lastEntity = _components.back().first;
-    _components[_entities[entity]] = std::move(_components.back());
-    _entities[lastEntity] = _entities[entity];
+    const size_t index = _entities.erase(entity);
+    if (index + 1 != _components.size()) {
+      _components[index] = std::move(_components.back());
+      _ticks[index] = _ticks.back();
+    }
     _components.pop_back();
+    _ticks.pop_back();
   }
 
   Component& getComponent(Entity entity) {
-    return _components[_entities[entity]].second;
+    assert(_entities.contains(entity) && "Entity is stale or does not own the component");
+    return _components[_entities.index(entity)];
+  }
+
+  // Returns the component for writing and records the change at the given tick.
+  Component& getComponent(Entity entity, uint32_t changeTick) {
+    assert(_entities.contains(entity) && "Entity is stale or does not own the component");
+    const size_t index = _entities.index(entity);
+    _ticks[index].changed = changeTick;
+    return _components[index];
+  }
+
+  Component* tryGetComponent(Entity entity) {
+    return _entities.contains(entity) ? &_components[_entities.index(entity)] : nullptr;
   }
 
-  std::vector<std::pair<Entity, Component>>& getComponents() {
+  const ComponentTicks& getTicks(Entity entity) const {
+    return _ticks[_entities.index(entity)];
+  }
+
+  void markChanged(Entity entity, uint32_t tick) {
+    _ticks[_entities.index(entity)].changed = tick;
+  }
+
+  std::span<Component> getComponents() {
     return _components;
   }
+
+  std::span<ComponentTicks> getAllTicks() {
+    return _ticks;
+  }
 };
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "common/entity_component_system/entity/entity.h"
+
+template <typename... Types>
+struct TypeList {};
+
+class MeshComponent;
+class MaterialComponent;
+class TransformComponent;
+class VelocityComponent;
+class PositionComponent;
+class HierarchyComponent;
+class LodComponent;
+
+// Every component type known to the registries. A component ID is its position in this list,
+// so new components are appended at the end.
+using ComponentTypes =
+    TypeList<MeshComponent, MaterialComponent, TransformComponent, VelocityComponent,
+             PositionComponent, HierarchyComponent, LodComponent>;
+
+namespace detail {
+
+template <typename Type, typename... Types>
+constexpr size_t indexOf(TypeList<Types...>) {
+  size_t index = 0;
+  const bool found = ((++index, std::is_same_v<Type, Types>) || ...);
+  return found ? index - 1 : sizeof...(Types);
+}
+
+template <typename... Types>
+constexpr size_t sizeOf(TypeList<Types...>) {
+  return sizeof...(Types);
+}
+
+}  // namespace detail
+
+static_assert(detail::sizeOf(ComponentTypes{}) <= MAX_COMPONENTS, "Too many component types");
+
+template <typename Component>
+constexpr ComponentType getComponentID() {
+  constexpr size_t id = detail::indexOf<std::remove_cv_t<Component>>(ComponentTypes{});
+  static_assert(id < detail::sizeOf(ComponentTypes{}), "Component is missing in ComponentTypes");
+  return static_cast<ComponentType>(id);
+}
+
+// Resolved at compile time, testing an entity against it is a single AND and compare.
+template <typename... Components>
+constexpr Signature getSignature() {
+  return Signature(((uint64_t{1} << getComponentID<Components>()) | ... | uint64_t{0}));
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "common/entity_component_system/component/component_types.h"
+
+// Parents the TransformComponent of an entity to the one of another entity. Roots use
+// NULL_ENTITY. Replace the component (addComponent) to reparent, so the change is detected.
+class HierarchyComponent {
+public:
+  Entity parent = NULL_ENTITY;
+};
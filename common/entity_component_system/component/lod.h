@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "common/entity_component_system/component/component_types.h"
+#include "common/util/geometry.h"
+
+// Range of the index buffer of a MeshComponent drawn for one level of detail.
+struct LodLevel {
+  uint32_t firstIndex = 0;
+  uint32_t indexCount = 0;
+  // Smallest projected size in pixels at which the level is drawn.
+  float minScreenSize = 0.0f;
+};
+
+// Levels of detail of a mesh, from the finest to the coarsest. The LodSystem selects one every
+// frame from the projected size of the bounds.
+class LodComponent {
+public:
+  static constexpr uint32_t MAX_LEVELS = 4;
+
+  std::array<LodLevel, MAX_LEVELS> levels;
+  uint32_t levelCount = 0;
+  // Model space bounds of the mesh, usually MeshComponent::aabb.
+  AABB bounds;
+  // Written by the LodSystem.
+  uint32_t currentLevel = 0;
+  bool culled = false;
+};
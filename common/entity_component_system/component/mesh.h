@@ -2,22 +2,16 @@
 
 #include <memory>
 
-#include "common/entity_component_system/entity/entity.h"
+#include "common/entity_component_system/component/component_types.h"
 #include "common/util/geometry.h"
 
 class Buffer;  // TODO: do not use vulkan specifi things in this directory
 
 class MeshComponent {
-  static constexpr ComponentType componentID = 2;
-
 public:
   Buffer vertexBuffer;
   Buffer indexBuffer;
   Buffer vertexBufferPrimitive;
   AABB aabb;
   VkIndexType indexType;
-
-  static constexpr std::enable_if_t < componentID<MAX_COMPONENTS, ComponentType> getComponentID() {
-    return componentID;
-  }
 };
@@ -3,15 +3,12 @@
 #include <glm/glm.hpp>
 #include <memory>
 
-#include "common/entity_component_system/entity/entity.h"
+#include "common/entity_component_system/component/component_types.h"
 
 class TransformComponent {
-  static constexpr ComponentType componentID = 4;
-
 public:
+  // Relative to the parent for entities with a HierarchyComponent.
   glm::mat4 model;
-
-  static constexpr std::enable_if_t < componentID<MAX_COMPONENTS, ComponentType> getComponentID() {
-    return componentID;
-  }
+  // Computed by the TransformSystem, equal to model for entities without a HierarchyComponent.
+  glm::mat4 world;
 };
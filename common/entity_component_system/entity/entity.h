@@ -4,15 +4,28 @@
 #include <cstdint>
 #include <limits>
 
-using Entity = uint16_t;
-constexpr size_t MAX_ENTITIES = std::numeric_limits<Entity>::max() / 100;
+// Entity handles pack a slot index and a generation counter. The generation is bumped whenever
+// a slot is recycled, so handles to destroyed entities can be told apart from live ones.
+using Entity = uint32_t;
+constexpr uint32_t ENTITY_INDEX_BITS = 20;
+constexpr uint32_t ENTITY_GENERATION_BITS = 32 - ENTITY_INDEX_BITS;
+constexpr Entity ENTITY_INDEX_MASK = (Entity{1} << ENTITY_INDEX_BITS) - 1;
+constexpr Entity ENTITY_GENERATION_MASK = (Entity{1} << ENTITY_GENERATION_BITS) - 1;
+constexpr Entity NULL_ENTITY = std::numeric_limits<Entity>::max();
+// The all-ones index is reserved for NULL_ENTITY and the end of the free list.
+constexpr size_t MAX_ENTITIES = ENTITY_INDEX_MASK;
 constexpr size_t MAX_COMPONENTS = 32;
 using Signature = std::bitset<MAX_COMPONENTS>;
 using ComponentType = uint8_t;
 
-template <typename... Components>
-Signature getSignature() {  // TODO: Change to constexpr in later c++.
-  Signature signature;
-  (signature.set(Components::getComponentID()), ...);
-  return signature;
+constexpr uint32_t getEntityIndex(Entity entity) {
+  return entity & ENTITY_INDEX_MASK;
+}
+
+constexpr uint32_t getEntityGeneration(Entity entity) {
+  return entity >> ENTITY_INDEX_BITS;
+}
+
+constexpr Entity createEntityHandle(uint32_t index, uint32_t generation) {
+  return (generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS | (index & ENTITY_INDEX_MASK);
 }
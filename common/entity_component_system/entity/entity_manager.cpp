@@ -1,22 +1,49 @@
 #include "entity_manager.h"
 
-#include <algorithm>
-#include <iterator>
+#include <cassert>
 
-EntityManager::EntityManager() {
-  _availableEntities.reserve(MAX_ENTITIES);
-  std::generate_n(
-      std::back_inserter(_availableEntities), MAX_ENTITIES, [val = MAX_ENTITIES]() mutable {
-        return --val;
-      });
+EntityManager::EntityManager(size_t capacity) {
+  _entities.reserve(capacity);
 }
 
 Entity EntityManager::createEntity() {
-  const Entity entity = _availableEntities.back();
-  _availableEntities.pop_back();
-  return entity;
+  ++_aliveCount;
+  if (_freeList == ENTITY_INDEX_MASK) {
+    assert(_entities.size() < MAX_ENTITIES && "Entity index space exhausted");
+    const uint32_t index = static_cast<uint32_t>(_entities.size());
+    return _entities.emplace_back(createEntityHandle(index, 0));
+  }
+
+  const uint32_t index = _freeList;
+  const Entity slot = _entities[index];
+  _freeList = getEntityIndex(slot);
+  return _entities[index] = createEntityHandle(index, getEntityGeneration(slot));
+}
+
+void EntityManager::createEntities(std::span<Entity> entities) {
+  _aliveCount += entities.size();
+  size_t i = 0;
+  for (; i < entities.size() && _freeList != ENTITY_INDEX_MASK; ++i) {
+    const uint32_t index = _freeList;
+    const Entity slot = _entities[index];
+    _freeList = getEntityIndex(slot);
+    entities[i] = _entities[index] = createEntityHandle(index, getEntityGeneration(slot));
+  }
+
+  const size_t first = _entities.size();
+  assert(first + entities.size() - i <= MAX_ENTITIES && "Entity index space exhausted");
+  _entities.resize(first + entities.size() - i);
+  for (size_t index = first; i < entities.size(); ++i, ++index) {
+    entities[i] = _entities[index] = createEntityHandle(static_cast<uint32_t>(index), 0);
+  }
 }
 
 void EntityManager::destroyEntity(Entity entity) {
-  _availableEntities.push_back(entity);
+  if (!isAlive(entity)) [[unlikely]] {
+    return;
+  }
+  const uint32_t index = getEntityIndex(entity);
+  _entities[index] = createEntityHandle(_freeList, getEntityGeneration(entity) + 1);
+  _freeList = index;
+  --_aliveCount;
 }
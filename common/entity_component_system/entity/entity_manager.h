@@ -1,16 +1,54 @@
 #pragma once
 
+#include <span>
 #include <vector>
 
 #include "entity.h"
 
+// Hands out generational entity handles. Destroyed slots form an implicit free list threaded
+// through _entities: a free slot stores the index of the next free slot together with the
+// generation its next handle will get. Creating and destroying entities therefore never
+// allocates once the slot array reached its high-water mark.
 class EntityManager {
 private:
-  std::vector<Entity> _availableEntities;
+  std::vector<Entity> _entities;
+  uint32_t _freeList = ENTITY_INDEX_MASK;
+  size_t _aliveCount = 0;
 
 public:
-  EntityManager();
+  explicit EntityManager(size_t capacity = 1024);
 
   Entity createEntity();
+  // Fills entities with new handles, reusing free slots first.
+  void createEntities(std::span<Entity> entities);
   void destroyEntity(Entity entity);
+
+  bool isAlive(Entity entity) const {
+    const uint32_t index = getEntityIndex(entity);
+    return index < _entities.size() && _entities[index] == entity;
+  }
+
+  size_t size() const {
+    return _aliveCount;
+  }
+
+  // Number of slots ever used, every live entity index is below this value.
+  size_t getSlotCount() const {
+    return _entities.size();
+  }
+
+  // Raw state used by Registry snapshots.
+  std::span<const Entity> getSlots() const {
+    return _entities;
+  }
+
+  uint32_t getFreeList() const {
+    return _freeList;
+  }
+
+  void restore(std::span<const Entity> slots, uint32_t freeList, size_t aliveCount) {
+    _entities.assign(slots.begin(), slots.end());
+    _freeList = freeList;
+    _aliveCount = aliveCount;
+  }
 };
@@ -0,0 +1,37 @@
+#include "archetype_registry.h"
+
+Archetype* ArchetypeRegistry::getOrCreateArchetype(Signature signature) {
+  auto [it, inserted] = _archetypesBySignature.try_emplace(signature, nullptr);
+  if (inserted) {
+    it->second =
+        _archetypes.emplace_back(std::make_unique<Archetype>(signature, _componentInfos)).get();
+  }
+  return it->second;
+}
+
+void ArchetypeRegistry::relocate(Entity entity, Archetype* destination) {
+  EntityLocation& location = _locations[getEntityIndex(entity)];
+  if (!location.archetype) {
+    location = {destination, destination->allocate(entity)};
+    return;
+  }
+
+  Entity movedEntity;
+  const size_t row = location.row;
+  const size_t destinationRow = location.archetype->moveTo(row, *destination, movedEntity);
+  _locations[getEntityIndex(movedEntity)].row = row;
+  location = {destination, destinationRow};
+}
+
+void ArchetypeRegistry::destroyEntity(Entity entity) {
+  if (!_entityManager.isAlive(entity)) [[unlikely]] {
+    return;
+  }
+  EntityLocation& location = _locations[getEntityIndex(entity)];
+  if (location.archetype) {
+    const Entity movedEntity = location.archetype->remove(location.row);
+    _locations[getEntityIndex(movedEntity)].row = location.row;
+    location = {};
+  }
+  _entityManager.destroyEntity(entity);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/entity_component_system/archetype/archetype.h"
+#include "common/entity_component_system/component/component_types.h"
+#include "common/entity_component_system/entity/entity_manager.h"
+
+// Archetype storage mode of the Registry. Entities with the same Signature live together in
+// fixed-size SoA chunks, so iterating several components walks parallel arrays linearly instead
+// of jumping between pools through indirection tables.
+class ArchetypeRegistry {
+  struct EntityLocation {
+    Archetype* archetype = nullptr;
+    size_t row = 0;
+  };
+
+  EntityManager _entityManager;
+  std::array<ComponentInfo, MAX_COMPONENTS> _componentInfos{};
+  std::vector<std::unique_ptr<Archetype>> _archetypes;
+  std::unordered_map<Signature, Archetype*> _archetypesBySignature;
+  std::vector<EntityLocation> _locations;
+
+  Archetype* getOrCreateArchetype(Signature signature);
+
+  void relocate(Entity entity, Archetype* destination);
+
+public:
+  explicit ArchetypeRegistry(size_t capacity = 1024) : _entityManager(capacity) {
+    _locations.reserve(capacity);
+  }
+
+  Entity createEntity() {
+    const Entity entity = _entityManager.createEntity();
+    if (getEntityIndex(entity) >= _locations.size()) [[unlikely]] {
+      _locations.resize(getEntityIndex(entity) + 1);
+    }
+    return entity;
+  }
+
+  bool isAlive(Entity entity) const {
+    return _entityManager.isAlive(entity);
+  }
+
+  void destroyEntity(Entity entity);
+
+  // Copies lvalues and moves rvalues into the archetype.
+  template <typename Type>
+  void addComponent(Entity entity, Type&& component) {
+    using Component = std::remove_cvref_t<Type>;
+    constexpr ComponentType componentID = getComponentID<Component>();
+    if (!_componentInfos[componentID].size) [[unlikely]] {
+      _componentInfos[componentID] = ComponentInfo::create<Component>();
+    }
+
+    EntityLocation& location = _locations[getEntityIndex(entity)];
+    if (location.archetype && location.archetype->getSignature().test(componentID)) {
+      getComponent<Component>(entity) = std::forward<Type>(component);
+      return;
+    }
+
+    Archetype* destination = location.archetype ? location.archetype->getAddEdge(componentID)
+                                                : nullptr;
+    if (!destination) [[unlikely]] {
+      Signature signature = location.archetype ? location.archetype->getSignature() : Signature{};
+      destination = getOrCreateArchetype(signature.set(componentID));
+      if (location.archetype) {
+        location.archetype->setAddEdge(componentID, destination);
+      }
+    }
+
+    relocate(entity, destination);
+    new (destination->getComponent(componentID, location.row)) Component(std::forward<Type>(component));
+  }
+
+  template <typename Component>
+  Component& getComponent(Entity entity) {
+    assert(_entityManager.isAlive(entity) && "Stale entity handle");
+    const EntityLocation& location = _locations[getEntityIndex(entity)];
+    return *static_cast<Component*>(
+        location.archetype->getComponent(getComponentID<Component>(), location.row));
+  }
+
+  template <typename... Components>
+  std::tuple<Components&...> getComponents(Entity entity) {
+    return std::tie(getComponent<Components>(entity)...);
+  }
+
+  template <typename... Components, typename Callback>
+  void updateComponents(Callback&& callback) {
+    constexpr Signature signature = getSignature<Components...>();
+    for (const std::unique_ptr<Archetype>& archetype : _archetypes) {
+      if ((archetype->getSignature() & signature) != signature) {
+        continue;
+      }
+      for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk) {
+        const size_t size = archetype->getChunkSize(chunk);
+        std::tuple<Components*...> columns = {archetype->getColumn<Components>(chunk)...};
+        for (size_t row = 0; row < size; ++row) {
+          callback(std::get<Components*>(columns)[row]...);
+        }
+      }
+    }
+  }
+};
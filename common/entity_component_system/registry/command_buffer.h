@@ -0,0 +1,154 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/entity_component_system/component/component_pool.h"
+#include "common/entity_component_system/component/component_types.h"
+#include "common/entity_component_system/entity/entity.h"
+#include "lib/arena/linear_arena.h"
+
+// Entity created through a RegistryCommandBuffer. It becomes a real Entity during playback.
+struct DeferredEntity {
+  uint32_t index;
+};
+
+// Type-erased operations needed to move a recorded component into its pool.
+struct DeferredComponentOps {
+  std::unique_ptr<ComponentPool> (*createPool)();
+  void (*moveIntoPool)(ComponentPool& pool, Entity entity, void* component, uint32_t tick);
+  void (*destroy)(void* component);
+
+  template <typename Component>
+  static const DeferredComponentOps* get() {
+    static constexpr DeferredComponentOps ops{
+      .createPool = []() -> std::unique_ptr<ComponentPool> {
+        return std::make_unique<ComponentPoolImpl<Component>>();
+      },
+      .moveIntoPool =
+          [](ComponentPool& pool, Entity entity, void* component, uint32_t tick) {
+            static_cast<ComponentPoolImpl<Component>&>(pool).addOrReplaceComponent(
+                entity, std::move(*static_cast<Component*>(component)), tick);
+          },
+      .destroy =
+          [](void* component) {
+            static_cast<Component*>(component)->~Component();
+          }};
+    return &ops;
+  }
+};
+
+// Records structural changes (create/destroy entities, add/remove components) without touching
+// the Registry, so they can be issued while systems iterate or from worker threads. Use one
+// buffer per thread. Component data is stored in a linear arena owned by the buffer.
+//
+// Registry::playback applies the buffers at a sync point: creations first, then the commands of
+// each entity in recording order. Pools are grown once for all recorded additions.
+class RegistryCommandBuffer {
+public:
+  enum class CommandType : uint8_t {
+    ADD_COMPONENT,
+    REMOVE_COMPONENT,
+    DESTROY_ENTITY
+  };
+
+  struct Command {
+    CommandType type;
+    ComponentType componentType;
+    bool deferred;
+    Entity entity;
+    void* component;
+    const DeferredComponentOps* ops;
+  };
+
+private:
+  lib::LinearArena _arena;
+  std::vector<Command> _commands;
+  uint32_t _createCount = 0;
+  std::vector<Entity> _createdEntities;
+
+  void record(CommandType type, ComponentType componentType, bool deferred, Entity entity,
+              void* component = nullptr, const DeferredComponentOps* ops = nullptr) {
+    _commands.push_back(Command{type, componentType, deferred, entity, component, ops});
+  }
+
+  template <typename Component>
+  void recordAdd(bool deferred, Entity entity, Component&& component) {
+    using Type = std::remove_cvref_t<Component>;
+    Type* data = _arena.create<Type>(std::forward<Component>(component));
+    record(CommandType::ADD_COMPONENT, getComponentID<Type>(), deferred, entity, data,
+           DeferredComponentOps::get<Type>());
+  }
+
+  // Forgets the commands, component payloads have to be destroyed already.
+  void reset() {
+    _commands.clear();
+    _createCount = 0;
+    _arena.reset();
+  }
+
+  friend class Registry;
+
+public:
+  RegistryCommandBuffer() = default;
+
+  RegistryCommandBuffer(const RegistryCommandBuffer&) = delete;
+  RegistryCommandBuffer& operator=(const RegistryCommandBuffer&) = delete;
+
+  ~RegistryCommandBuffer() {
+    clear();
+  }
+
+  DeferredEntity createEntity() {
+    return DeferredEntity{_createCount++};
+  }
+
+  void destroyEntity(Entity entity) {
+    record(CommandType::DESTROY_ENTITY, 0, false, entity);
+  }
+
+  void destroyEntity(DeferredEntity entity) {
+    record(CommandType::DESTROY_ENTITY, 0, true, entity.index);
+  }
+
+  template <typename Component>
+  void addComponent(Entity entity, Component&& component) {
+    recordAdd(false, entity, std::forward<Component>(component));
+  }
+
+  template <typename Component>
+  void addComponent(DeferredEntity entity, Component&& component) {
+    recordAdd(true, entity.index, std::forward<Component>(component));
+  }
+
+  template <typename Component>
+  void removeComponent(Entity entity) {
+    record(CommandType::REMOVE_COMPONENT, getComponentID<Component>(), false, entity);
+  }
+
+  template <typename Component>
+  void removeComponent(DeferredEntity entity) {
+    record(CommandType::REMOVE_COMPONENT, getComponentID<Component>(), true, entity.index);
+  }
+
+  // Entities created by the last playback, indexed by DeferredEntity::index.
+  const std::vector<Entity>& getCreatedEntities() const {
+    return _createdEntities;
+  }
+
+  bool empty() const {
+    return _commands.empty() && _createCount == 0;
+  }
+
+  // Drops all recorded commands which were not played back.
+  void clear() {
+    for (const Command& command : _commands) {
+      if (command.component) {
+        command.ops->destroy(command.component);
+      }
+    }
+    reset();
+  }
+};
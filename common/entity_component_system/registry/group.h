@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "common/entity_component_system/component/component_pool.h"
+#include "common/entity_component_system/entity/entity.h"
+#include "lib/thread_pool/thread_pool.h"
+
+// Bookkeeping of an owning group. Every owned pool keeps the entities owning all of the group's
+// components in its first size() slots, in the same order in every pool. The Registry calls
+// add() after a component was added and remove() before one is removed, both are O(1) swaps.
+class GroupData {
+  Signature _signature;
+  std::vector<ComponentPool*> _pools;
+  size_t _size = 0;
+
+public:
+  GroupData(Signature signature, std::vector<ComponentPool*> pools)
+    : _signature(signature), _pools(std::move(pools)) {}
+
+  const Signature& getSignature() const {
+    return _signature;
+  }
+
+  bool matches(const Signature& signature) const {
+    return (signature & _signature) == _signature;
+  }
+
+  bool contains(Entity entity) const {
+    return _pools.front()->contains(entity) && _pools.front()->getIndex(entity) < _size;
+  }
+
+  // The entity has to own all of the group's components.
+  void add(Entity entity) {
+    if (contains(entity)) {
+      return;
+    }
+    for (ComponentPool* pool : _pools) {
+      pool->swapEntities(pool->getEntity(_size), entity);
+    }
+    ++_size;
+  }
+
+  void remove(Entity entity) {
+    if (!contains(entity)) {
+      return;
+    }
+    --_size;
+    for (ComponentPool* pool : _pools) {
+      pool->swapEntities(pool->getEntity(_size), entity);
+    }
+  }
+
+  // Collects the members again after the pools were refilled, signatures are indexed by entity.
+  void rebuild(std::span<const Signature> signatures) {
+    _size = 0;
+    const ComponentPool* smallestPool =
+        *std::min_element(_pools.cbegin(), _pools.cend(), [](const auto* lhs, const auto* rhs) {
+          return lhs->size() < rhs->size();
+        });
+    // add() reorders the pools, the smallest one included.
+    const std::vector<Entity> entities(smallestPool->getEntities().begin(),
+                                       smallestPool->getEntities().end());
+    for (Entity entity : entities) {
+      if (matches(signatures[getEntityIndex(entity)])) {
+        add(entity);
+      }
+    }
+  }
+
+  size_t size() const {
+    return _size;
+  }
+};
+
+// Iterates the packed prefix of the owned pools as parallel arrays, without sparse lookups.
+// Like in View, const components are read-only and the others are marked as changed.
+template <typename... Components>
+class Group {
+  template <typename Component>
+  using Pool = ComponentPoolImpl<std::remove_const_t<Component>>;
+
+  std::tuple<Pool<Components>*...> _pools;
+  const GroupData* _data;
+  uint32_t _tick;
+
+  template <typename Component>
+  Component* getData() const {
+    return std::get<Pool<Component>*>(_pools)->getComponents().data();
+  }
+
+  template <typename Component>
+  void markChanged(size_t begin, size_t end) const {
+    if constexpr (!std::is_const_v<Component>) {
+      ComponentTicks* ticks = std::get<Pool<Component>*>(_pools)->getAllTicks().data();
+      for (size_t i = begin; i < end; ++i) {
+        ticks[i].changed = _tick;
+      }
+    }
+  }
+
+  template <typename Callback>
+  void visit(size_t begin, size_t end, Callback& callback) const {
+    const Entity* entities = getEntities().data();
+    const std::tuple<Components*...> data = {getData<Components>()...};
+    for (size_t i = begin; i < end; ++i) {
+      if constexpr (std::is_invocable_v<Callback, Entity, Components&...>) {
+        callback(entities[i], std::get<Components*>(data)[i]...);
+      } else {
+        callback(std::get<Components*>(data)[i]...);
+      }
+    }
+    (markChanged<Components>(begin, end), ...);
+  }
+
+  template <typename Callback>
+  void visitRange(size_t begin, size_t end, Callback& callback) const {
+    callback(std::span<Components>(getData<Components>() + begin, end - begin)...);
+    (markChanged<Components>(begin, end), ...);
+  }
+
+public:
+  Group(Pool<Components>*... pools, const GroupData* data, uint32_t tick)
+    : _pools(pools...), _data(data), _tick(tick) {}
+
+  // Callback may optionally take the Entity as its first argument.
+  template <typename Callback>
+  void each(Callback&& callback) const {
+    visit(0, size(), callback);
+  }
+
+  template <typename Callback>
+  void parallelEach(
+      lib::ThreadPool& threadPool, Callback&& callback, size_t grainSize = 1024) const {
+    threadPool.parallelFor(size(), grainSize, [&](size_t begin, size_t end) {
+      visit(begin, end, callback);
+    });
+  }
+
+  // Hands the callback one span per component over the whole group, for kernels processing
+  // columns at once instead of single entities.
+  template <typename Callback>
+  void eachRange(Callback&& callback) const {
+    visitRange(0, size(), callback);
+  }
+
+  // Like eachRange, with the columns split into chunks of grainSize entities.
+  template <typename Callback>
+  void parallelEachRange(
+      lib::ThreadPool& threadPool, Callback&& callback, size_t grainSize = 16384) const {
+    threadPool.parallelFor(size(), grainSize, [&](size_t begin, size_t end) {
+      visitRange(begin, end, callback);
+    });
+  }
+
+  std::span<const Entity> getEntities() const {
+    return std::get<0>(_pools)->getEntities().first(size());
+  }
+
+  template <typename Component>
+  std::span<Component> getComponents() const {
+    return std::span<Component>(getData<Component>(), size());
+  }
+
+  size_t size() const {
+    return _data->size();
+  }
+};
@@ -1 +1,581 @@
 #include "registry.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+
+namespace {
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x47524a42;  // "BJRG"
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr size_t SNAPSHOT_ALIGNMENT = 16;
+
+// Layout: header, entity slots, then for every pool a pool header followed by the packed
+// entities, ticks and components. Every block starts at a multiple of SNAPSHOT_ALIGNMENT.
+struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slotCount;
+  uint32_t freeList;
+  uint32_t aliveCount;
+  uint32_t poolCount;
+  uint32_t tick;
+  uint32_t reserved;
+};
+
+struct SnapshotPoolHeader {
+  uint32_t componentType;
+  uint32_t componentSize;
+  uint32_t count;
+  uint32_t reserved;
+};
+
+class SnapshotWriter {
+  std::ofstream _file;
+
+public:
+  explicit SnapshotWriter(std::string_view filePath)
+    : _file(std::string(filePath), std::ios::binary | std::ios::trunc) {}
+
+  bool isOpen() const {
+    return _file.is_open();
+  }
+
+  void write(const void* data, size_t size) {
+    static constexpr char padding[SNAPSHOT_ALIGNMENT] = {};
+    _file.write(static_cast<const char*>(data), size);
+    const size_t paddingSize =
+        (SNAPSHOT_ALIGNMENT - size % SNAPSHOT_ALIGNMENT) % SNAPSHOT_ALIGNMENT;
+    _file.write(padding, paddingSize);
+  }
+
+  bool good() const {
+    return _file.good();
+  }
+};
+
+class SnapshotReader {
+  std::span<const std::byte> _data;
+  size_t _offset = 0;
+
+public:
+  explicit SnapshotReader(std::span<const std::byte> data) : _data(data) {}
+
+  // Returns nullptr when the data is truncated.
+  const std::byte* read(size_t size) {
+    if (size > _data.size() - _offset) {
+      return nullptr;
+    }
+    const std::byte* block = _data.data() + _offset;
+    const size_t alignedSize = (size + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT
+                               * SNAPSHOT_ALIGNMENT;
+    _offset = std::min(_data.size(), _offset + alignedSize);
+    return block;
+  }
+
+  template <typename Type>
+  std::optional<std::span<const Type>> readArray(size_t count) {
+    const std::byte* block = read(count * sizeof(Type));
+    if (!block) {
+      return std::nullopt;
+    }
+    return std::span<const Type>(reinterpret_cast<const Type*>(block), count);
+  }
+};
+
+}  // namespace
+
+std::array<Registry::PoolFactory, MAX_COMPONENTS>& Registry::getPoolFactories() {
+  static std::array<PoolFactory, MAX_COMPONENTS> factories = {};
+  return factories;
+}
+
+void Registry::createPools(const Signature& signature) {
+  const std::array<PoolFactory, MAX_COMPONENTS>& factories = getPoolFactories();
+  for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+    if (signature.test(type) && !_componentsData[type] && factories[type]) {
+      _componentsData[type] = factories[type]();
+    }
+  }
+}
+
+void Registry::createEntities(std::span<Entity> entities) {
+  entityManager.createEntities(entities);
+  if (entityManager.getSlotCount() > _signatures.size()) {
+    _signatures.resize(entityManager.getSlotCount());
+  }
+}
+
+Status Registry::instantiate(Entity prefab, std::span<Entity> entities) {
+  if (!entityManager.isAlive(prefab)) {
+    return Error(EngineError::NOT_FOUND);
+  }
+  const Signature signature = _signatures[getEntityIndex(prefab)];
+  for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+    if (signature.test(type) && !_componentsData[type]->isCopyable()) {
+      return Error(EngineError::NOT_RECOGNIZED_TYPE);
+    }
+  }
+  createEntities(entities);
+  for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+    if (signature.test(type)) {
+      _componentsData[type]->cloneComponent(prefab, entities, _currentTick);
+    }
+  }
+  for (Entity entity : entities) {
+    _signatures[getEntityIndex(entity)] = signature;
+  }
+  for (const std::unique_ptr<ViewCache>& cache : _viewCaches) {
+    if (cache->matches(signature)) {
+      for (Entity entity : entities) {
+        cache->add(entity);
+      }
+    }
+  }
+  for (const std::unique_ptr<GroupData>& group : _groups) {
+    if (group->matches(signature)) {
+      for (Entity entity : entities) {
+        group->add(entity);
+      }
+    }
+  }
+  return StatusOk();
+}
+
+void Registry::destroyEntity(Entity entity) {
+  if (!entityManager.isAlive(entity)) [[unlikely]] {
+    return;
+  }
+  Signature& signature = _signatures[getEntityIndex(entity)];
+  for (const std::unique_ptr<ViewCache>& cache : _viewCaches) {
+    if (cache->matches(signature)) {
+      cache->remove(entity);
+    }
+  }
+  for (const std::unique_ptr<GroupData>& group : _groups) {
+    if (group->matches(signature)) {
+      group->remove(entity);
+    }
+  }
+  for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+    if (signature.test(type)) {
+      _componentsData[type]->destroyEntity(entity);
+    }
+  }
+  signature.reset();
+  entityManager.destroyEntity(entity);
+}
+
+uint32_t Registry::getViewIndex(const Signature& signature) {
+  static std::mutex mutex;
+  static std::vector<Signature> signatures;
+  std::lock_guard lock(mutex);
+  const auto it = std::find(signatures.cbegin(), signatures.cend(), signature);
+  if (it != signatures.cend()) {
+    return static_cast<uint32_t>(std::distance(signatures.cbegin(), it));
+  }
+  signatures.push_back(signature);
+  return static_cast<uint32_t>(signatures.size() - 1);
+}
+
+const ViewCache* Registry::getViewCache(uint32_t index, const Signature& signature,
+                                        std::span<const ComponentPool* const> pools) {
+  if (index < _viewCacheIndices.size() && _viewCacheIndices[index]) [[likely]] {
+    return _viewCacheIndices[index];
+  }
+
+  const ComponentPool* smallestPool =
+      *std::min_element(pools.begin(), pools.end(), [](const auto* lhs, const auto* rhs) {
+        return lhs->size() < rhs->size();
+      });
+  auto cache = std::make_unique<ViewCache>(signature);
+  for (Entity entity : smallestPool->getEntities()) {
+    if (cache->matches(_signatures[getEntityIndex(entity)])) {
+      cache->add(entity);
+    }
+  }
+  if (index >= _viewCacheIndices.size()) {
+    _viewCacheIndices.resize(index + 1, nullptr);
+  }
+  _viewCacheIndices[index] = cache.get();
+  return _viewCaches.emplace_back(std::move(cache)).get();
+}
+
+ErrorOr<const GroupData*> Registry::getGroupData(
+    const Signature& signature, std::vector<ComponentPool*> pools) {
+  auto it = std::find_if(_groups.cbegin(), _groups.cend(), [&signature](const auto& group) {
+    return group->getSignature() == signature;
+  });
+  if (it != _groups.cend()) [[likely]] {
+    return static_cast<const GroupData*>(it->get());
+  }
+
+  if ((_ownedComponents & signature).any()) {
+    return Error(EngineError::ALREADY_INITIALIZED);
+  }
+  _ownedComponents |= signature;
+  const ComponentPool* smallestPool =
+      *std::min_element(pools.cbegin(), pools.cend(), [](const auto* lhs, const auto* rhs) {
+        return lhs->size() < rhs->size();
+      });
+  const std::vector<Entity> entities(
+      smallestPool->getEntities().begin(), smallestPool->getEntities().end());
+  auto group = std::make_unique<GroupData>(signature, std::move(pools));
+  for (Entity entity : entities) {
+    if (group->matches(_signatures[getEntityIndex(entity)])) {
+      group->add(entity);
+    }
+  }
+  return static_cast<const GroupData*>(_groups.emplace_back(std::move(group)).get());
+}
+
+void Registry::onComponentAdded(Entity entity, ComponentType type) {
+  Signature& signature = _signatures[getEntityIndex(entity)];
+  if (signature.test(type)) {
+    return;
+  }
+  signature.set(type);
+  for (const std::unique_ptr<ViewCache>& cache : _viewCaches) {
+    if (cache->getSignature().test(type) && cache->matches(signature)) {
+      cache->add(entity);
+    }
+  }
+  for (const std::unique_ptr<GroupData>& group : _groups) {
+    if (group->getSignature().test(type) && group->matches(signature)) {
+      group->add(entity);
+    }
+  }
+}
+
+void Registry::onComponentsAdded(std::span<const Entity> entities, ComponentType type) {
+  std::vector<ViewCache*> caches;
+  for (const std::unique_ptr<ViewCache>& cache : _viewCaches) {
+    if (cache->getSignature().test(type)) {
+      caches.push_back(cache.get());
+    }
+  }
+  GroupData* group = nullptr;
+  for (const std::unique_ptr<GroupData>& candidate : _groups) {
+    if (candidate->getSignature().test(type)) {
+      group = candidate.get();
+    }
+  }
+  for (Entity entity : entities) {
+    Signature& signature = _signatures[getEntityIndex(entity)];
+    if (signature.test(type)) {
+      continue;
+    }
+    signature.set(type);
+    for (ViewCache* cache : caches) {
+      if (cache->matches(signature)) {
+        cache->add(entity);
+      }
+    }
+    if (group && group->matches(signature)) {
+      group->add(entity);
+    }
+  }
+}
+
+void Registry::removeComponent(Entity entity, ComponentType type) {
+  if (!hasComponent(entity, type)) {
+    return;
+  }
+  Signature& signature = _signatures[getEntityIndex(entity)];
+  for (const std::unique_ptr<ViewCache>& cache : _viewCaches) {
+    if (cache->getSignature().test(type) && cache->matches(signature)) {
+      cache->remove(entity);
+    }
+  }
+  for (const std::unique_ptr<GroupData>& group : _groups) {
+    if (group->getSignature().test(type) && group->matches(signature)) {
+      group->remove(entity);
+    }
+  }
+  signature.reset(type);
+  _componentsData[type]->destroyEntity(entity);
+}
+
+void Registry::playback(std::span<RegistryCommandBuffer* const> commandBuffers) {
+  using CommandType = RegistryCommandBuffer::CommandType;
+
+  _pendingCommands.clear();
+  for (RegistryCommandBuffer* commandBuffer : commandBuffers) {
+    std::vector<Entity>& createdEntities = commandBuffer->_createdEntities;
+    createdEntities.clear();
+    for (uint32_t i = 0; i < commandBuffer->_createCount; ++i) {
+      createdEntities.push_back(createEntity());
+    }
+    for (RegistryCommandBuffer::Command& command : commandBuffer->_commands) {
+      _pendingCommands.push_back(
+          {&command, command.deferred ? createdEntities[command.entity] : command.entity});
+    }
+  }
+
+  // Pools only grow once per playback, even though commands are applied entity by entity.
+  std::array<size_t, MAX_COMPONENTS> addCounts{};
+  for (const PendingCommand& pending : _pendingCommands) {
+    const RegistryCommandBuffer::Command& command = *pending.command;
+    if (command.type == CommandType::ADD_COMPONENT) {
+      std::unique_ptr<ComponentPool>& pool = _componentsData[command.componentType];
+      if (!pool) {
+        pool = command.ops->createPool();
+      }
+      ++addCounts[command.componentType];
+    }
+  }
+  for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+    if (addCounts[type] != 0) {
+      _componentsData[type]->reserve(_componentsData[type]->size() + addCounts[type]);
+    }
+  }
+
+  // Commands of one entity have to stay in recording order, a removal followed by an addition of
+  // the same component must leave the component in place.
+  std::stable_sort(_pendingCommands.begin(), _pendingCommands.end(),
+                   [](const PendingCommand& lhs, const PendingCommand& rhs) {
+                     return lhs.entity < rhs.entity;
+                   });
+
+  for (const PendingCommand& pending : _pendingCommands) {
+    const RegistryCommandBuffer::Command& command = *pending.command;
+    switch (command.type) {
+      case CommandType::ADD_COMPONENT:
+        if (entityManager.isAlive(pending.entity)) {
+          command.ops->moveIntoPool(*_componentsData[command.componentType], pending.entity,
+                                    command.component, _currentTick);
+          onComponentAdded(pending.entity, command.componentType);
+        }
+        command.ops->destroy(command.component);
+        break;
+      case CommandType::REMOVE_COMPONENT:
+        removeComponent(pending.entity, command.componentType);
+        break;
+      case CommandType::DESTROY_ENTITY:
+        destroyEntity(pending.entity);
+        break;
+    }
+  }
+
+  for (RegistryCommandBuffer* commandBuffer : commandBuffers) {
+    commandBuffer->reset();
+  }
+}
+
+Status Registry::serialize(std::string_view filePath) const {
+  SnapshotWriter writer(filePath);
+  if (!writer.isOpen()) {
+    return Error(EngineError::LOAD_FAILURE);
+  }
+
+  uint32_t poolCount = 0;
+  for (const std::unique_ptr<ComponentPool>& pool : _componentsData) {
+    poolCount += pool && pool->getComponentSize() != 0;
+  }
+  const std::span<const Entity> slots = entityManager.getSlots();
+  const SnapshotHeader header{.magic = SNAPSHOT_MAGIC,
+                              .version = SNAPSHOT_VERSION,
+                              .slotCount = static_cast<uint32_t>(slots.size()),
+                              .freeList = entityManager.getFreeList(),
+                              .aliveCount = static_cast<uint32_t>(entityManager.size()),
+                              .poolCount = poolCount,
+                              .tick = _currentTick,
+                              .reserved = 0};
+  writer.write(&header, sizeof(header));
+  writer.write(slots.data(), slots.size_bytes());
+
+  for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+    const ComponentPool* pool = _componentsData[type].get();
+    if (!pool || pool->getComponentSize() == 0) {
+      continue;
+    }
+    const SnapshotPoolHeader poolHeader{.componentType = type,
+                                        .componentSize =
+                                            static_cast<uint32_t>(pool->getComponentSize()),
+                                        .count = static_cast<uint32_t>(pool->size()),
+                                        .reserved = 0};
+    writer.write(&poolHeader, sizeof(poolHeader));
+    writer.write(pool->getEntities().data(), pool->getEntities().size_bytes());
+    writer.write(pool->getTickData().data(), pool->getTickData().size_bytes());
+    writer.write(pool->getComponentData(), pool->size() * pool->getComponentSize());
+  }
+  return writer.good() ? StatusOk() : Status(Error(EngineError::LOAD_FAILURE));
+}
+
+Status Registry::deserialize(std::span<const std::byte> data,
+                             std::span<const ComponentType> types,
+                             std::span<ComponentPool* const> pools) {
+  struct PoolBlock {
+    ComponentPool* pool;
+    std::span<const Entity> entities;
+    std::span<const ComponentTicks> ticks;
+    const std::byte* components;
+  };
+
+  // Everything is validated before the registry is modified. Blocks are read in place, which
+  // needs the alignment of their headers, entities and ticks.
+  if (reinterpret_cast<uintptr_t>(data.data()) % alignof(SnapshotHeader) != 0) {
+    return Error(EngineError::NOT_MAPPED);
+  }
+  SnapshotReader reader(data);
+  const std::optional<std::span<const SnapshotHeader>> header =
+      reader.readArray<SnapshotHeader>(1);
+  if (!header) {
+    return Error(EngineError::SIZE_MISMATCH);
+  }
+  const SnapshotHeader& snapshot = header->front();
+  if (snapshot.magic != SNAPSHOT_MAGIC || snapshot.version != SNAPSHOT_VERSION) {
+    return Error(EngineError::NOT_RECOGNIZED_TYPE);
+  }
+  if (snapshot.slotCount > MAX_ENTITIES || snapshot.aliveCount > snapshot.slotCount) {
+    return Error(EngineError::SIZE_MISMATCH);
+  }
+  const std::optional<std::span<const Entity>> slots =
+      reader.readArray<Entity>(snapshot.slotCount);
+  if (!slots) {
+    return Error(EngineError::SIZE_MISMATCH);
+  }
+
+  // A slot is alive when it holds its own index, free slots hold the next one of the free list,
+  // which has to visit every free slot exactly once.
+  const auto isAlive = [&slots](Entity entity) {
+    const uint32_t index = getEntityIndex(entity);
+    return index < slots->size() && (*slots)[index] == entity;
+  };
+  uint32_t aliveCount = 0;
+  for (uint32_t index = 0; index < slots->size(); ++index) {
+    aliveCount += getEntityIndex((*slots)[index]) == index;
+  }
+  if (aliveCount != snapshot.aliveCount) {
+    return Error(EngineError::SIZE_MISMATCH);
+  }
+  uint32_t freeCount = 0;
+  for (uint32_t index = snapshot.freeList; index != ENTITY_INDEX_MASK;
+       index = getEntityIndex((*slots)[index])) {
+    if (index >= slots->size() || getEntityIndex((*slots)[index]) == index
+        || freeCount++ == slots->size() - aliveCount) {
+      return Error(EngineError::INDEX_OUT_OF_RANGE);
+    }
+  }
+  if (freeCount != slots->size() - aliveCount) {
+    return Error(EngineError::SIZE_MISMATCH);
+  }
+
+  // Signatures are built while the entity blocks are validated, a bit which is set already marks
+  // an entity listed twice.
+  std::vector<PoolBlock> blocks;
+  Signature snapshotTypes;
+  std::vector<Signature> signatures(slots->size());
+  for (uint32_t i = 0; i < snapshot.poolCount; ++i) {
+    const std::optional<std::span<const SnapshotPoolHeader>> poolHeader =
+        reader.readArray<SnapshotPoolHeader>(1);
+    if (!poolHeader) {
+      return Error(EngineError::SIZE_MISMATCH);
+    }
+    const SnapshotPoolHeader& pool = poolHeader->front();
+    if (pool.componentType >= MAX_COMPONENTS || snapshotTypes.test(pool.componentType)) {
+      return Error(EngineError::NOT_RECOGNIZED_TYPE);
+    }
+    snapshotTypes.set(pool.componentType);
+    const std::optional<std::span<const Entity>> entities = reader.readArray<Entity>(pool.count);
+    const std::optional<std::span<const ComponentTicks>> ticks =
+        reader.readArray<ComponentTicks>(pool.count);
+    const std::byte* components = reader.read(size_t{pool.count} * pool.componentSize);
+    if (!entities || !ticks || !components) {
+      return Error(EngineError::SIZE_MISMATCH);
+    }
+    const auto it = std::find(types.begin(), types.end(), pool.componentType);
+    if (it == types.end()) {
+      continue;
+    }
+    ComponentPool* target = pools[std::distance(types.begin(), it)];
+    if (target->getComponentSize() != pool.componentSize) {
+      return Error(EngineError::SIZE_MISMATCH);
+    }
+    for (Entity entity : *entities) {
+      Signature& signature = signatures[getEntityIndex(entity)];
+      if (!isAlive(entity) || signature.test(pool.componentType)) {
+        return Error(EngineError::INDEX_OUT_OF_RANGE);
+      }
+      signature.set(pool.componentType);
+    }
+    blocks.push_back(PoolBlock{target, *entities, *ticks, components});
+  }
+
+  entityManager.restore(*slots, snapshot.freeList, snapshot.aliveCount);
+  _signatures = std::move(signatures);
+  // Pools which are not restored keep the components of entities alive in the snapshot.
+  Signature restoredTypes;
+  for (ComponentType type : types) {
+    restoredTypes.set(type);
+  }
+  std::vector<Entity> destroyed;
+  for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+    ComponentPool* pool = _componentsData[type].get();
+    if (!pool) {
+      continue;
+    }
+    if (restoredTypes.test(type)) {
+      // Pools with a block are replaced by restore().
+      if (!snapshotTypes.test(type)) {
+        pool->clear();
+      }
+      continue;
+    }
+    destroyed.clear();
+    for (Entity entity : pool->getEntities()) {
+      if (entityManager.isAlive(entity)) {
+        _signatures[getEntityIndex(entity)].set(type);
+      } else {
+        destroyed.push_back(entity);
+      }
+    }
+    for (Entity entity : destroyed) {
+      pool->destroyEntity(entity);
+    }
+  }
+  for (const PoolBlock& block : blocks) {
+    block.pool->restore(block.entities, block.components, block.ticks);
+  }
+  _currentTick = snapshot.tick;
+  rebuildQueries(restoredTypes);
+  return StatusOk();
+}
+
+void Registry::rebuildQueries(const Signature& restoredTypes) {
+  std::vector<Entity> destroyed;
+  for (const std::unique_ptr<ViewCache>& cache : _viewCaches) {
+    const Signature& signature = cache->getSignature();
+    if ((signature & restoredTypes).none()) {
+      destroyed.clear();
+      for (Entity entity : cache->getEntities()) {
+        if (!entityManager.isAlive(entity)) {
+          destroyed.push_back(entity);
+        }
+      }
+      for (Entity entity : destroyed) {
+        cache->remove(entity);
+      }
+      continue;
+    }
+
+    const ComponentPool* smallestPool = nullptr;
+    for (ComponentType type = 0; type < MAX_COMPONENTS; ++type) {
+      const ComponentPool* pool = _componentsData[type].get();
+      if (signature.test(type) && (!smallestPool || pool->size() < smallestPool->size())) {
+        smallestPool = pool;
+      }
+    }
+    cache->clear();
+    for (Entity entity : smallestPool->getEntities()) {
+      if (cache->matches(_signatures[getEntityIndex(entity)])) {
+        cache->add(entity);
+      }
+    }
+  }
+  for (const std::unique_ptr<GroupData>& group : _groups) {
+    group->rebuild(_signatures);
+  }
+}
@@ -1,99 +1,298 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "common/entity_component_system/component/component_pool.h"
+#include "common/entity_component_system/component/component_types.h"
 #include "common/entity_component_system/entity/entity_manager.h"
+#include "common/file/mapped_file.h"
+#include "common/status/status.h"
+#include "command_buffer.h"
+#include "group.h"
+#include "view.h"
 
 class Registry {
   EntityManager entityManager;
   std::array<std::unique_ptr<ComponentPool>, MAX_COMPONENTS> _componentsData;
-  std::array<Signature, MAX_ENTITIES> _signatures;
+  std::vector<Signature> _signatures;
+  std::vector<std::unique_ptr<ViewCache>> _viewCaches;
+  // Indexed by getViewIndex(), null for views which were not requested from this registry yet.
+  std::vector<const ViewCache*> _viewCacheIndices;
+  std::vector<std::unique_ptr<GroupData>> _groups;
+  Signature _ownedComponents;
+  std::mutex _viewMutex;
+
+  struct PendingCommand {
+    RegistryCommandBuffer::Command* command;
+    Entity entity;
+  };
+  std::vector<PendingCommand> _pendingCommands;
+  uint32_t _currentTick = 1;
+
+  using PoolFactory = std::unique_ptr<ComponentPool> (*)();
+
+  // Factories of every component type whose pool is used in the program, registered during
+  // static initialization, so createPools() can create pools from a runtime Signature.
+  static std::array<PoolFactory, MAX_COMPONENTS>& getPoolFactories();
+
+  template <typename Component>
+  static bool registerPoolFactory() {
+    getPoolFactories()[getComponentID<Component>()] = [] {
+      return std::unique_ptr<ComponentPool>(std::make_unique<ComponentPoolImpl<Component>>());
+    };
+    return true;
+  }
+
+  template <typename Component>
+  static inline const bool _isPoolFactoryRegistered = registerPoolFactory<Component>();
+
+  template <typename Component>
+  ComponentPoolImpl<std::remove_const_t<Component>>* getPool() {
+    using Type = std::remove_const_t<Component>;
+    static_cast<void>(_isPoolFactoryRegistered<Type>);
+    if (!_componentsData[getComponentID<Type>()]) [[unlikely]] {
+      _componentsData[getComponentID<Type>()] = std::make_unique<ComponentPoolImpl<Type>>();
+    }
+    return static_cast<ComponentPoolImpl<Type>*>(_componentsData[getComponentID<Type>()].get());
+  }
+
+  // Process-wide index of a view signature, so that every registry finds its cache of a view in
+  // constant time. Views over the same components in another order share the index.
+  static uint32_t getViewIndex(const Signature& signature);
+
+  template <typename... Components>
+  static uint32_t getViewIndex() {
+    static const uint32_t index = getViewIndex(getSignature<Components...>());
+    return index;
+  }
+
+  const ViewCache* getViewCache(uint32_t index, const Signature& signature,
+                                std::span<const ComponentPool* const> pools);
+
+  ErrorOr<const GroupData*> getGroupData(const Signature& signature,
+                                         std::vector<ComponentPool*> pools);
+
+  void onComponentAdded(Entity entity, ComponentType type);
+
+  void onComponentsAdded(std::span<const Entity> entities, ComponentType type);
+
+  void removeComponent(Entity entity, ComponentType type);
+
+  Status deserialize(std::span<const std::byte> data, std::span<const ComponentType> types,
+                     std::span<ComponentPool* const> pools);
+
+  // Refills groups and the view caches of restored types after the pools were replaced. Other
+  // view caches only drop entities which are no longer alive.
+  void rebuildQueries(const Signature& restoredTypes);
 
 public:
-  Entity createEntity() {
-    return entityManager.createEntity();
+  explicit Registry(size_t capacity = 1024) : entityManager(capacity) {
+    _signatures.reserve(capacity);
   }
 
-  void destroyEntity(Entity entity) {
-    Signature i = 1;
-    for (ComponentType j = 0; j < MAX_COMPONENTS; i <<= 2, ++j) {
-      if ((_signatures[entity] & i) != 0) {
-        _componentsData[j]->destroyEntity(entity);
-      }
+  Entity createEntity() {
+    const Entity entity = entityManager.createEntity();
+    if (getEntityIndex(entity) >= _signatures.size()) [[unlikely]] {
+      _signatures.resize(getEntityIndex(entity) + 1);
     }
-    _signatures[entity].reset();
-    entityManager.destroyEntity(entity);
+    return entity;
+  }
+
+  void createEntities(std::span<Entity> entities);
+
+  std::vector<Entity> createEntities(size_t count) {
+    std::vector<Entity> entities(count);
+    createEntities(entities);
+    return entities;
+  }
+
+  // Creates entities owning copies of every component of the prefab entity. Fails without
+  // creating anything when the prefab is not alive or owns a component which is not copyable.
+  Status instantiate(Entity prefab, std::span<Entity> entities);
+
+  ErrorOr<std::vector<Entity>> instantiate(Entity prefab, size_t count) {
+    std::vector<Entity> entities(count);
+    RETURN_IF_ERROR(instantiate(prefab, entities));
+    return entities;
+  }
+
+  // Creates the missing pools of the components in the signature. Pools are otherwise created
+  // lazily on first access, which must not happen while systems run in parallel.
+  void createPools(const Signature& signature);
+
+  bool hasPool(ComponentType type) const {
+    return _componentsData[type] != nullptr;
+  }
+
+  // Destroying an entity that is not alive anymore is a no-op.
+  void destroyEntity(Entity entity);
+
+  bool isAlive(Entity entity) const {
+    return entityManager.isAlive(entity);
+  }
+
+  // Change ticks are compared against this value. Advance it once per frame so systems can
+  // query what happened since their previous run.
+  uint32_t getTick() const {
+    return _currentTick;
+  }
+
+  void advanceTick() {
+    ++_currentTick;
   }
 
   template <typename Component>
   void addComponent(Entity entity, Component&& component) {
-    if (!_componentsData[Component::getComponentID()]) [[unlikely]] {
-      _componentsData[Component::getComponentID()] =
-          std::make_unique<ComponentPoolImpl<Component>>();
-    }
-    static_cast<ComponentPoolImpl<Component>*>(_componentsData[Component::getComponentID()].get())
-        ->addComponent(entity, std::move(component));
-    _signatures[entity].set(Component::getComponentID());
+    using Type = std::remove_cvref_t<Component>;
+    getPool<Type>()->addOrReplaceComponent(entity, std::forward<Component>(component),
+                                           _currentTick);
+    onComponentAdded(entity, getComponentID<Type>());
+  }
+
+  // Adds components[i] to entities[i]. Entities without the component yet are appended to the
+  // pool in one contiguous copy.
+  template <typename Component>
+  void addComponents(std::span<const Entity> entities, std::span<const Component> components) {
+    getPool<Component>()->addComponents(entities, components, _currentTick);
+    onComponentsAdded(entities, getComponentID<Component>());
+  }
+
+  template <typename Component>
+  void markChanged(Entity entity) {
+    getPool<Component>()->markChanged(entity, _currentTick);
+  }
+
+  // Modifies the component in place and marks it as changed.
+  template <typename Component, typename Func>
+  void patch(Entity entity, Func&& func) {
+    func(getPool<Component>()->getComponent(entity, _currentTick));
+  }
+
+  template <typename Component>
+  void removeComponent(Entity entity) {
+    removeComponent(entity, getComponentID<Component>());
+  }
+
+  template <typename Component>
+  bool hasComponent(Entity entity) const {
+    return hasComponent(entity, getComponentID<Component>());
+  }
+
+  bool hasComponent(Entity entity, ComponentType type) const {
+    return entityManager.isAlive(entity) && _signatures[getEntityIndex(entity)].test(type);
+  }
+
+  // Applies recorded structural changes. Must not run concurrently with systems iterating the
+  // registry. Buffers are reset afterwards and keep their memory for the next frame.
+  void playback(std::span<RegistryCommandBuffer* const> commandBuffers);
+
+  // Writes the entities and every pool of trivially copyable components as contiguous blocks to
+  // a versioned binary file. Other pools are skipped. The file uses the native byte order.
+  Status serialize(std::string_view filePath) const;
+
+  // Replaces the entities of the registry with a snapshot written by serialize(). Only the pools
+  // of the listed Components are restored, their blocks are copied as a whole. Other pools keep
+  // the components of entities which are alive in the snapshot. The data has to be aligned to 4
+  // bytes. Malformed snapshots fail and leave the registry unchanged.
+  template <typename... Components>
+  Status deserialize(std::span<const std::byte> data) {
+    static_assert((std::is_trivially_copyable_v<Components> && ...),
+                  "Only trivially copyable components can be restored");
+    const std::array<ComponentType, sizeof...(Components)> types = {
+      getComponentID<Components>()...};
+    const std::array<ComponentPool*, sizeof...(Components)> pools = {getPool<Components>()...};
+    return deserialize(data, types, pools);
   }
 
+  // Restores from a memory mapped file, see deserialize(std::span<const std::byte>).
+  template <typename... Components>
+  Status deserialize(std::string_view filePath) {
+    ASSIGN_OR_RETURN(const MappedFile file, MappedFile::open(filePath));
+    return deserialize<Components...>(file.getData());
+  }
+
+  // Unchecked: the entity has to be alive and own the component. Only debug builds assert it,
+  // release builds return the component of whichever entity now uses the slot of a stale handle.
+  // Use findComponent() or tryGetComponent() for handles which may be stale. Writes through the
+  // reference are not tracked, use patch() or markChanged() for that.
   template <typename Component>
   Component& getComponent(Entity entity) {
-    if (!_componentsData[Component::getComponentID()]) [[unlikely]] {
-      _componentsData[Component::getComponentID()] =
-          std::make_unique<ComponentPoolImpl<Component>>();
+    return getPool<Component>()->getComponent(entity);
+  }
+
+  // Checked in every build, fails with NOT_FOUND for stale handles and entities without the
+  // component.
+  template <typename Component>
+  ErrorOr<std::reference_wrapper<Component>> findComponent(Entity entity) {
+    Component* component = getPool<Component>()->tryGetComponent(entity);
+    if (!component) {
+      return Error(EngineError::NOT_FOUND);
     }
-    _signatures[entity].set(Component::getComponentID());
-    return static_cast<ComponentPoolImpl<Component>*>(
-               _componentsData[Component::getComponentID()].get())
-        ->getComponent(entity);
+    return std::ref(*component);
+  }
+
+  // Returns nullptr for stale handles and entities without the component.
+  template <typename Component>
+  Component* tryGetComponent(Entity entity) {
+    return getPool<Component>()->tryGetComponent(entity);
   }
 
   template <typename... Components>
   std::tuple<Components&...> getComponents(Entity entity) {
-    return std::tie(static_cast<ComponentPoolImpl<Components>*>(
-                        _componentsData[Components::getComponentID()].get())
-                        ->getComponent(entity)...);
+    return std::tie(getPool<Components>()->getComponent(entity)...);
   }
 
+  // Returns a view over all entities owning the Components. The list of matching entities is
+  // built once, starting from the smallest pool, and updated incrementally afterwards. Request
+  // components as const to iterate them without marking them as changed.
   template <typename... Components>
-  void updateComponents(std::function<void(Components&...)> callback) {
-    Signature signature = getSignature<Components...>();
-    // Ensure the components exist in the registry
-    std::tuple<ComponentPoolImpl<Components>&...> pools = {
-      *(static_cast<ComponentPoolImpl<Components>*>(
-          _componentsData[Components::getComponentID()].get()))...};
-
-    // Iterate over all entities
-    for (Entity entity = 0; entity < MAX_ENTITIES; ++entity) {  // TODO: get entities from system
-                                                                // probably.
-      // Check if the entity matches the signature of these components
-      if ((_signatures[entity] & signature) == signature) {
-        // Get references to the components for the entity
-        callback(std::get<ComponentPoolImpl<Components>&>(pools).getComponent(entity)...);
-      }
-    }
+  View<Components...> view() {
+    // Systems scheduled in parallel may request views concurrently.
+    std::lock_guard lock(_viewMutex);
+    const std::array<const ComponentPool*, sizeof...(Components)> pools = {
+      getPool<Components>()...};
+    const ViewCache* cache =
+        getViewCache(getViewIndex<Components...>(), getSignature<Components...>(), pools);
+    return View<Components...>(getPool<Components>()..., cache, _currentTick);
   }
 
+  // Returns an owning group of the Components: their pools keep the matching entities packed at
+  // the front in the same order, so iteration is a linear walk over parallel arrays. A pool can
+  // be owned by one group only, requesting a group over a pool owned by another group fails with
+  // ALREADY_INITIALIZED. The first call sorts the pools.
   template <typename... Components>
-  void updateComponents(
-      std::function<void(Components&...)> callback, const std::vector<Entity>& entities) {
-    const Signature signature = getSignature<Components...>();
+  ErrorOr<Group<Components...>> group() {
+    std::lock_guard lock(_viewMutex);
+    ASSIGN_OR_RETURN(const GroupData* data,
+                     getGroupData(getSignature<Components...>(), {getPool<Components>()...}));
+    return Group<Components...>(getPool<Components>()..., data, _currentTick);
+  }
 
-    auto components = std::tuple<std::vector<Components>&...>(
-        static_cast<ComponentPoolImpl<Components>*>(
-            _componentsData[Components::getComponentID()].get())
-            ->getComponents()...);
+  template <typename... Components, typename Callback>
+  void updateComponents(Callback&& callback) {
+    view<Components...>().each(std::forward<Callback>(callback));
+  }
 
+  template <typename... Components, typename Callback>
+  void updateComponents(Callback&& callback, const std::vector<Entity>& entities) {
+    constexpr Signature signature = getSignature<Components...>();
+    const std::tuple<ComponentPoolImpl<Components>*...> pools = {getPool<Components>()...};
     for (Entity entity : entities) {
-      if ((_signatures[entity] & signature) == signature) {
-        callback(std::get<std::vector<Components>&>(components)[entity]...);
+      if ((_signatures[getEntityIndex(entity)] & signature) == signature) {
+        callback(
+            std::get<ComponentPoolImpl<Components>*>(pools)->getComponent(entity, _currentTick)...);
       }
     }
   }
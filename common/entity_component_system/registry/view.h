@@ -0,0 +1,147 @@
+#pragma once
+
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+#include "common/entity_component_system/component/component_pool.h"
+#include "common/entity_component_system/entity/entity.h"
+#include "lib/thread_pool/thread_pool.h"
+
+// Entities matching a Signature, kept up to date by the Registry on every structural change.
+class ViewCache {
+  Signature _signature;
+  EntitySparseSet _entities;
+
+public:
+  explicit ViewCache(Signature signature) : _signature(signature) {}
+
+  const Signature& getSignature() const {
+    return _signature;
+  }
+
+  bool matches(const Signature& signature) const {
+    return (signature & _signature) == _signature;
+  }
+
+  void add(Entity entity) {
+    _entities.insert(entity);
+  }
+
+  void remove(Entity entity) {
+    _entities.erase(entity);
+  }
+
+  void clear() {
+    _entities.clear();
+  }
+
+  std::span<const Entity> getEntities() const {
+    return _entities.getPacked();
+  }
+};
+
+// Filters for View::each. They match components added or changed at or after sinceTick, which
+// is usually the Registry tick observed at the beginning of the previous run of a system.
+template <typename Component>
+struct Added {
+  uint32_t sinceTick;
+};
+
+template <typename Component>
+struct Changed {
+  uint32_t sinceTick;
+};
+
+// Components requested as const are read-only. Every other component handed to the callback is
+// considered written and gets its change tick updated.
+template <typename... Components>
+class View {
+  template <typename Component>
+  using Pool = ComponentPoolImpl<std::remove_const_t<Component>>;
+
+  std::tuple<Pool<Components>*...> _pools;
+  const ViewCache* _cache;
+  uint32_t _tick;
+
+  template <typename Component>
+  Component& get(Entity entity) const {
+    if constexpr (std::is_const_v<Component>) {
+      return std::get<Pool<Component>*>(_pools)->getComponent(entity);
+    } else {
+      return std::get<Pool<Component>*>(_pools)->getComponent(entity, _tick);
+    }
+  }
+
+  template <typename Callback>
+  void visit(Entity entity, Callback& callback) const {
+    if constexpr (std::is_invocable_v<Callback, Entity, Components&...>) {
+      callback(entity, get<Components>(entity)...);
+    } else {
+      callback(get<Components>(entity)...);
+    }
+  }
+
+public:
+  View(Pool<Components>*... pools, const ViewCache* cache, uint32_t tick)
+    : _pools(pools...), _cache(cache), _tick(tick) {}
+
+  // Callback may optionally take the Entity as its first argument.
+  template <typename Callback>
+  void each(Callback&& callback) const {
+    for (Entity entity : _cache->getEntities()) {
+      visit(entity, callback);
+    }
+  }
+
+  // Visits only entities whose Component changed at or after the filter tick.
+  template <typename Component, typename Callback>
+  void each(Changed<Component> filter, Callback&& callback) const {
+    const Pool<Component>* pool = std::get<Pool<Component>*>(_pools);
+    for (Entity entity : _cache->getEntities()) {
+      if (pool->getTicks(entity).changed >= filter.sinceTick) {
+        visit(entity, callback);
+      }
+    }
+  }
+
+  // Visits only entities whose Component was added at or after the filter tick.
+  template <typename Component, typename Callback>
+  void each(Added<Component> filter, Callback&& callback) const {
+    const Pool<Component>* pool = std::get<Pool<Component>*>(_pools);
+    for (Entity entity : _cache->getEntities()) {
+      if (pool->getTicks(entity).added >= filter.sinceTick) {
+        visit(entity, callback);
+      }
+    }
+  }
+
+  // Splits the matching entities into fixed ranges processed on the thread pool. The callback
+  // must only touch the components of the entity it is given.
+  template <typename Callback>
+  void parallelEach(
+      lib::ThreadPool& threadPool, Callback&& callback, size_t grainSize = 1024) const {
+    const std::span<const Entity> entities = _cache->getEntities();
+    threadPool.parallelFor(entities.size(), grainSize, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        visit(entities[i], callback);
+      }
+    });
+  }
+
+  std::span<const Entity> getEntities() const {
+    return _cache->getEntities();
+  }
+
+  auto begin() const {
+    return _cache->getEntities().begin();
+  }
+
+  auto end() const {
+    return _cache->getEntities().end();
+  }
+
+  size_t size() const {
+    return _cache->getEntities().size();
+  }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "common/entity_component_system/registry/registry.h"
+#include "lib/thread_pool/thread_pool.h"
+#include "lib/triple_buffer/triple_buffer.h"
+#include "system.h"
+
+template <typename Packet>
+struct FrameSnapshot {
+  std::vector<Packet> packets;
+  uint32_t tick = 0;
+};
+
+// Copies the Components of every visible entity into a flat array of packets, built with
+// Packet::create(const Components&...). The snapshots are triple-buffered: the simulation
+// extracts frame N+1 while the render thread still records frame N from acquireSnapshot(),
+// without locks. Only the render thread may call acquireSnapshot().
+template <typename Packet, typename... Components>
+class ExtractionSystem : public System {
+  static constexpr size_t GRAIN_SIZE = 512;
+
+  Registry* _registry;
+  const std::vector<Entity>* _visibleEntities = nullptr;
+  lib::TripleBuffer<FrameSnapshot<Packet>> _snapshots;
+
+public:
+  explicit ExtractionSystem(Registry* registry) : _registry(registry) {}
+
+  // Entities to extract, e.g. the output of culling. They have to own all Components. Without
+  // a list every entity owning the Components is extracted.
+  void setVisibleEntities(const std::vector<Entity>* entities) {
+    _visibleEntities = entities;
+  }
+
+  void update(float) override {
+    const std::span<const Entity> entities =
+        _visibleEntities ? std::span<const Entity>(*_visibleEntities)
+                         : _registry->view<const Components...>().getEntities();
+    FrameSnapshot<Packet>& snapshot = _snapshots.getWriteBuffer();
+    snapshot.tick = _registry->getTick();
+    snapshot.packets.resize(entities.size());
+
+    const auto extract = [this, entities, &snapshot](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        snapshot.packets[i] =
+            Packet::create(std::as_const(_registry->getComponent<Components>(entities[i]))...);
+      }
+    };
+    if (_threadPool) {
+      _threadPool->parallelFor(entities.size(), GRAIN_SIZE, extract);
+    } else {
+      extract(0, entities.size());
+    }
+    _snapshots.publish();
+  }
+
+  const FrameSnapshot<Packet>& acquireSnapshot() {
+    return _snapshots.acquire();
+  }
+
+  SystemAccess getAccess() const override {
+    return SystemAccess{.reads = getSignature<Components...>(),
+                        .writes = Signature(),
+                        .exclusive = false};
+  }
+};
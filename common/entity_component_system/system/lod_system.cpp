@@ -0,0 +1,101 @@
+#include "lod_system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "common/entity_component_system/component/lod.h"
+#include "common/entity_component_system/component/transform.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+struct PixelScaleVisitor {
+  float viewportHeight;
+
+  float operator()(const OrthographicProjection& ortho) const {
+    return viewportHeight / std::abs(ortho.top - ortho.bottom);
+  }
+
+  float operator()(const PerspectiveProjection& persp) const {
+    return viewportHeight / (2.0f * std::tan(0.5f * persp.fovy));
+  }
+};
+
+}  // namespace
+
+LodSystem::LodSystem(Registry* registry) : _registry(registry) {}
+
+void LodSystem::setView(
+    const glm::vec3& position, const Projection& projection, float viewportHeight) {
+  _viewPosition = position;
+  _pixelScale = std::visit(PixelScaleVisitor{viewportHeight}, projection);
+  _isPerspective = std::holds_alternative<PerspectiveProjection>(projection);
+}
+
+float LodSystem::getScreenSize(const LodComponent& lod, const TransformComponent& transform) const {
+  const glm::vec3 localCenter = 0.5f * (lod.bounds.lowerCorner + lod.bounds.upperCorner);
+  const glm::vec3 center = glm::vec3(transform.world * glm::vec4(localCenter, 1.0f));
+  const float scale = std::sqrt(std::max({glm::dot(transform.world[0], transform.world[0]),
+                                          glm::dot(transform.world[1], transform.world[1]),
+                                          glm::dot(transform.world[2], transform.world[2])}));
+  const float diameter = scale * glm::length(lod.bounds.upperCorner - lod.bounds.lowerCorner);
+  if (!_isPerspective) {
+    return diameter * _pixelScale;
+  }
+  const float distance = glm::length(center - _viewPosition);
+  if (distance <= 0.5f * diameter) {
+    return std::numeric_limits<float>::infinity();
+  }
+  return diameter * _pixelScale / distance;
+}
+
+void LodSystem::selectRange(std::span<const Entity> entities, size_t begin, size_t end) const {
+  const float lower = 1.0f - _hysteresis;
+  const float upper = 1.0f + _hysteresis;
+  for (size_t i = begin; i < end; ++i) {
+    // The selection is derived data, writing it does not mark the component as changed.
+    LodComponent& lod = _registry->getComponent<LodComponent>(entities[i]);
+    assert(lod.levelCount > 0 && lod.levelCount <= LodComponent::MAX_LEVELS);
+    const float size =
+        getScreenSize(lod, _registry->getComponent<TransformComponent>(entities[i]));
+
+    uint32_t level = std::min(lod.currentLevel, lod.levelCount - 1);
+    while (level + 1 < lod.levelCount && size < lod.levels[level].minScreenSize * lower) {
+      ++level;
+    }
+    while (level > 0 && size >= lod.levels[level - 1].minScreenSize * upper) {
+      --level;
+    }
+    lod.currentLevel = level;
+    lod.culled = size < _cullScreenSize * (lod.culled ? upper : lower);
+  }
+}
+
+void LodSystem::update(float) {
+  const std::span<const Entity> entities =
+      _candidates ? std::span<const Entity>(*_candidates)
+                  : _registry->view<const LodComponent, const TransformComponent>().getEntities();
+  if (_threadPool) {
+    _threadPool->parallelFor(entities.size(), GRAIN_SIZE,
+                             [this, entities](size_t begin, size_t end) {
+                               selectRange(entities, begin, end);
+                             });
+  } else {
+    selectRange(entities, 0, entities.size());
+  }
+
+  _visibleEntities.clear();
+  for (Entity entity : entities) {
+    if (!_registry->getComponent<LodComponent>(entity).culled) {
+      _visibleEntities.push_back(entity);
+    }
+  }
+}
+
+SystemAccess LodSystem::getAccess() const {
+  return SystemAccess{.reads = getSignature<TransformComponent>(),
+                      .writes = getSignature<LodComponent>(),
+                      .exclusive = false};
+}
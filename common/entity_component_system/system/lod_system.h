@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "common/camera/projection.h"
+#include "common/entity_component_system/registry/registry.h"
+#include "system.h"
+
+class LodComponent;
+class TransformComponent;
+
+// Selects LodComponent::currentLevel from the projected size in pixels of the bounding sphere of
+// LodComponent::bounds under TransformComponent::world, so the TransformSystem has to update
+// before it. A level only changes once the size leaves the band of +-hysteresis around the
+// threshold, so objects near a threshold do not pop every frame. Entities smaller than the cull
+// size are culled and left out of getVisibleEntities().
+class LodSystem : public System {
+  static constexpr size_t GRAIN_SIZE = 1024;
+
+  Registry* _registry;
+  const std::vector<Entity>* _candidates = nullptr;
+  std::vector<Entity> _visibleEntities;
+  glm::vec3 _viewPosition = glm::vec3(0.0f);
+  // Projected size of a unit sized object, divided by the distance for perspective projections.
+  float _pixelScale = 1.0f;
+  bool _isPerspective = true;
+  float _hysteresis = 0.1f;
+  float _cullScreenSize = 1.0f;
+
+  void selectRange(std::span<const Entity> entities, size_t begin, size_t end) const;
+
+public:
+  explicit LodSystem(Registry* registry);
+
+  void setView(const glm::vec3& position, const Projection& projection, float viewportHeight);
+
+  // Entities to process, e.g. the output of frustum culling. They have to own a LodComponent
+  // and a TransformComponent. Without a list every such entity is processed.
+  void setCandidates(const std::vector<Entity>* entities) {
+    _candidates = entities;
+  }
+
+  // Relative width of the band around every threshold, e.g. 0.1 for +-10%.
+  void setHysteresis(float hysteresis) {
+    _hysteresis = hysteresis;
+  }
+
+  // Entities projected smaller than this many pixels are culled.
+  void setCullScreenSize(float pixels) {
+    _cullScreenSize = pixels;
+  }
+
+  float getScreenSize(const LodComponent& lod, const TransformComponent& transform) const;
+
+  void update(float deltaTime) override;
+
+  // Candidates which were not culled by the last update, in the same order.
+  const std::vector<Entity>& getVisibleEntities() const {
+    return _visibleEntities;
+  }
+
+  SystemAccess getAccess() const override;
+};
@@ -1,19 +1,45 @@
 #include "movement_system.h"
 
-#include <chrono>
-#include <iostream>
-#include <tuple>
-
 #include "common/entity_component_system/component/position.h"
 #include "common/entity_component_system/component/velocity.h"
+#include "lib/simd/kernels.h"
+#include "lib/thread_pool/thread_pool.h"
+
+static_assert(sizeof(PositionComponent) == 2 * sizeof(float));
+static_assert(sizeof(VelocityComponent) == 2 * sizeof(float));
 
-MovementSystem::MovementSystem(Registry* reg) : registry(reg) {}
+MovementSystem::MovementSystem(Registry* reg)
+  : registry(reg),
+    _ownsGroup(registry->group<PositionComponent, const VelocityComponent>().has_value()) {}
 
 void MovementSystem::update(float deltaTime) {
-  //    registry->updateComponents<PositionComponent, VelocityComponent>(
-  //        [deltaTime](PositionComponent& pos, VelocityComponent& vel) {
-  //            pos.x += vel.dx * deltaTime;
-  //            pos.y += vel.dy * deltaTime;
-  //        }
-  //    );
+  // The group keeps both columns packed in the same order, and both components are pairs of
+  // floats, so the whole group integrates as one flat float array.
+  const auto move = [deltaTime](std::span<PositionComponent> positions,
+                                std::span<const VelocityComponent> velocities) {
+    lib::axpy(reinterpret_cast<float*>(positions.data()),
+              reinterpret_cast<const float*>(velocities.data()), deltaTime,
+              positions.size() * 2);
+  };
+  if (!_ownsGroup) [[unlikely]] {
+    registry->view<PositionComponent, const VelocityComponent>().each(
+        [deltaTime](PositionComponent& position, const VelocityComponent& velocity) {
+          position.x += velocity.dx * deltaTime;
+          position.y += velocity.dy * deltaTime;
+        });
+    return;
+  }
+  // The group exists already, so this only looks it up.
+  auto group = registry->group<PositionComponent, const VelocityComponent>().value();
+  if (_threadPool) {
+    group.parallelEachRange(*_threadPool, move);
+  } else {
+    group.eachRange(move);
+  }
+}
+
+SystemAccess MovementSystem::getAccess() const {
+  return SystemAccess{.reads = getSignature<VelocityComponent>(),
+                      .writes = getSignature<PositionComponent>(),
+                      .exclusive = false};
 }
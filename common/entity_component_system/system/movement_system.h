@@ -1,16 +1,20 @@
 #pragma once
 
-#include <vector>
-
 #include "common/entity_component_system/registry/registry.h"
 #include "system.h"
 
+// Integrates positions with the SIMD kernels from lib/simd. Owns the group of PositionComponent
+// and VelocityComponent, so no other group may own either pool. Creating the group reorders both
+// pools, so it is created by the constructor rather than while other systems read them. When
+// another group owns one of the pools, the system falls back to a view.
 class MovementSystem : public System {
   Registry* registry;
-  std::vector<Entity> _entities;
+  bool _ownsGroup;
 
 public:
   MovementSystem(Registry* reg);
 
   void update(float deltaTime) override;
+
+  SystemAccess getAccess() const override;
 };
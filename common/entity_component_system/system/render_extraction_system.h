@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include "common/entity_component_system/component/lod.h"
+#include "common/entity_component_system/component/material.h"
+#include "common/entity_component_system/component/mesh.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/util/bindless_descriptor_handles.h"
+#include "extraction_system.h"
+#include "vulkan_wrapper/memory_objects/buffer.h"
+
+// Everything needed to record the draw of one mesh. Only Vulkan handles are copied, so a packet
+// stays valid while the simulation keeps modifying the Registry. The model matrix is the world
+// matrix computed by the TransformSystem.
+struct RenderPacket {
+  glm::mat4 model;
+  VkBuffer vertexBuffer;
+  VkBuffer indexBuffer;
+  VkIndexType indexType;
+  uint32_t firstIndex;
+  uint32_t indexCount;
+  TextureHandle diffuse;
+  TextureHandle normal;
+  TextureHandle metallicRoughness;
+
+  static RenderPacket create(const MeshComponent& mesh, const TransformComponent& transform,
+                             const MaterialComponent& material) {
+    const uint32_t indexSize = mesh.indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4;
+    return RenderPacket{.model = transform.world,
+                        .vertexBuffer = mesh.vertexBuffer.getVkBuffer(),
+                        .indexBuffer = mesh.indexBuffer.getVkBuffer(),
+                        .indexType = mesh.indexType,
+                        .firstIndex = 0,
+                        .indexCount = mesh.indexBuffer.getSize() / indexSize,
+                        .diffuse = material.diffuse,
+                        .normal = material.normal,
+                        .metallicRoughness = material.metallicRoughness};
+  }
+
+  // Draws the index range of the level selected by the LodSystem.
+  static RenderPacket create(const MeshComponent& mesh, const TransformComponent& transform,
+                             const MaterialComponent& material, const LodComponent& lod) {
+    RenderPacket packet = create(mesh, transform, material);
+    packet.firstIndex = lod.levels[lod.currentLevel].firstIndex;
+    packet.indexCount = lod.levels[lod.currentLevel].indexCount;
+    return packet;
+  }
+};
+
+using RenderExtractionSystem =
+    ExtractionSystem<RenderPacket, MeshComponent, TransformComponent, MaterialComponent>;
+
+// Fed with LodSystem::getVisibleEntities(), which leaves out entities culled for their size.
+using LodRenderExtractionSystem = ExtractionSystem<RenderPacket, MeshComponent,
+                                                   TransformComponent, MaterialComponent,
+                                                   LodComponent>;
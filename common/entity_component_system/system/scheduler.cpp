@@ -0,0 +1,70 @@
+#include "scheduler.h"
+
+#include "common/entity_component_system/registry/registry.h"
+
+Scheduler::Scheduler(lib::ThreadPool& threadPool, Registry* registry)
+  : _threadPool(threadPool), _registry(registry) {}
+
+void Scheduler::addSystem(System* system) {
+  system->setThreadPool(&_threadPool);
+  _systems.push_back(system);
+  _successors.resize(_systems.size());
+  _dependencies = std::make_unique<std::atomic<size_t>[]>(_systems.size());
+}
+
+void Scheduler::buildGraph() {
+  std::vector<SystemAccess> accesses;
+  accesses.reserve(_systems.size());
+  Signature components;
+  for (const System* system : _systems) {
+    accesses.push_back(system->getAccess());
+    components |= accesses.back().reads | accesses.back().writes;
+  }
+  if (_registry) {
+    _registry->createPools(components);
+  }
+
+  for (size_t i = 0; i < _systems.size(); ++i) {
+    _successors[i].clear();
+    _dependencies[i].store(0, std::memory_order_relaxed);
+  }
+  for (size_t j = 1; j < _systems.size(); ++j) {
+    for (size_t i = 0; i < j; ++i) {
+      if (accesses[i].conflictsWith(accesses[j])) {
+        _successors[i].push_back(j);
+        _dependencies[j].fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+void Scheduler::runSystem(size_t index, float deltaTime, lib::TaskGroup& group) {
+  _systems[index]->update(deltaTime);
+  for (size_t successor : _successors[index]) {
+    if (_dependencies[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      _threadPool.submit(group, [this, successor, deltaTime, &group] {
+        runSystem(successor, deltaTime, group);
+      });
+    }
+  }
+}
+
+void Scheduler::update(float deltaTime) {
+  buildGraph();
+
+  // Roots are collected before submitting, a running system may already bring the dependency
+  // count of a successor to zero and submit it.
+  std::vector<size_t> roots;
+  for (size_t i = 0; i < _systems.size(); ++i) {
+    if (_dependencies[i].load(std::memory_order_relaxed) == 0) {
+      roots.push_back(i);
+    }
+  }
+  lib::TaskGroup group;
+  for (size_t root : roots) {
+    _threadPool.submit(group, [this, root, deltaTime, &group] {
+      runSystem(root, deltaTime, group);
+    });
+  }
+  _threadPool.wait(group);
+}
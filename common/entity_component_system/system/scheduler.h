@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "lib/thread_pool/thread_pool.h"
+#include "system.h"
+
+class Registry;
+
+// Runs systems on a thread pool. Every frame a dependency graph is built from the declared
+// component access: a system waits for all previously registered systems it conflicts with, so
+// the results match a sequential run in registration order.
+class Scheduler {
+  lib::ThreadPool& _threadPool;
+  Registry* _registry;
+  std::vector<System*> _systems;
+  std::vector<std::vector<size_t>> _successors;
+  std::unique_ptr<std::atomic<size_t>[]> _dependencies;
+
+  void buildGraph();
+
+  void runSystem(size_t index, float deltaTime, lib::TaskGroup& group);
+
+public:
+  // The pools of every component the systems declare are created in the registry before the
+  // systems run, so no system creates a pool while others access the registry.
+  explicit Scheduler(lib::ThreadPool& threadPool, Registry* registry = nullptr);
+
+  void addSystem(System* system);
+
+  void update(float deltaTime);
+};
@@ -1,6 +1,39 @@
 #pragma once
 
+#include "common/entity_component_system/entity/entity.h"
+
+namespace lib {
+class ThreadPool;
+}  // namespace lib
+
+// Components a system touches during update. Systems which do not declare their access are
+// treated as exclusive and never run concurrently with other systems.
+struct SystemAccess {
+  Signature reads = {};
+  Signature writes = {};
+  bool exclusive = true;
+
+  bool conflictsWith(const SystemAccess& other) const {
+    return exclusive || other.exclusive || (writes & (other.reads | other.writes)).any()
+           || (other.writes & reads).any();
+  }
+};
+
 class System {
+protected:
+  // Set by the Scheduler, allows a system to split its own entity range across cores.
+  lib::ThreadPool* _threadPool = nullptr;
+
 public:
+  virtual ~System() = default;
+
   virtual void update(float deltaTime) = 0;
+
+  virtual SystemAccess getAccess() const {
+    return {};
+  }
+
+  void setThreadPool(lib::ThreadPool* threadPool) {
+    _threadPool = threadPool;
+  }
 };
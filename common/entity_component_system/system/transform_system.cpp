@@ -0,0 +1,160 @@
+#include "transform_system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ranges>
+
+#include "common/entity_component_system/component/hierarchy.h"
+#include "common/entity_component_system/component/transform.h"
+#include "lib/simd/matrix.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+constexpr uint32_t UNKNOWN_DEPTH = UINT32_MAX;
+constexpr uint32_t VISITING = UINT32_MAX - 1;
+constexpr size_t GRAIN_SIZE = 256;
+
+}  // namespace
+
+TransformSystem::TransformSystem(Registry* registry) : _registry(registry) {}
+
+void TransformSystem::rebuild(std::span<const Entity> entities) {
+  const size_t count = entities.size();
+  uint32_t maxIndex = 0;
+  for (Entity entity : entities) {
+    maxIndex = std::max(maxIndex, getEntityIndex(entity));
+  }
+  _slots.assign(count ? maxIndex + 1 : 0, ROOT);
+  for (size_t i = 0; i < count; ++i) {
+    _slots[getEntityIndex(entities[i])] = static_cast<uint32_t>(i);
+  }
+
+  // Parents which are stale or not part of the hierarchy make the entity a root.
+  std::vector<uint32_t> parents(count, ROOT);
+  for (size_t i = 0; i < count; ++i) {
+    const Entity parent = _registry->getComponent<HierarchyComponent>(entities[i]).parent;
+    const uint32_t index = getEntityIndex(parent);
+    if (parent != NULL_ENTITY && index < _slots.size() && _slots[index] != ROOT &&
+        entities[_slots[index]] == parent) {
+      parents[i] = _slots[index];
+    }
+  }
+
+  std::vector<uint32_t> depths(count, UNKNOWN_DEPTH);
+  std::vector<uint32_t> path;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t current = i;
+    while (depths[current] == UNKNOWN_DEPTH && parents[current] != ROOT) {
+      depths[current] = VISITING;
+      path.push_back(current);
+      current = parents[current];
+    }
+    if (depths[current] == VISITING) {
+      assert(false && "Cycle in the entity hierarchy");
+      parents[current] = ROOT;
+      depths[current] = 0;
+    } else if (depths[current] == UNKNOWN_DEPTH) {
+      depths[current] = 0;
+    }
+    for (uint32_t node : path | std::views::reverse) {
+      depths[node] = parents[node] == ROOT ? 0 : depths[parents[node]] + 1;
+    }
+    path.clear();
+  }
+
+  // Counting sort by depth.
+  const uint32_t depth = count ? *std::max_element(depths.cbegin(), depths.cend()) + 1 : 0;
+  _levels.assign(depth + 1, 0);
+  for (uint32_t nodeDepth : depths) {
+    ++_levels[nodeDepth + 1];
+  }
+  for (size_t i = 1; i < _levels.size(); ++i) {
+    _levels[i] += _levels[i - 1];
+  }
+  std::vector<size_t> cursors(_levels.cbegin(), _levels.cend() - 1);
+  for (size_t i = 0; i < count; ++i) {
+    _slots[getEntityIndex(entities[i])] = static_cast<uint32_t>(cursors[depths[i]]++);
+  }
+  _nodes.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t parent =
+        parents[i] == ROOT ? ROOT : _slots[getEntityIndex(entities[parents[i]])];
+    _nodes[_slots[getEntityIndex(entities[i])]] = Node{entities[i], parent};
+  }
+}
+
+void TransformSystem::updateRange(size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) {
+    const Node& node = _nodes[i];
+    if (node.parent != ROOT) {
+      _dirty[i] |= _dirty[node.parent];
+    }
+    if (!_dirty[i]) {
+      continue;
+    }
+    // World matrices are derived data, writing them does not mark the transform as changed.
+    TransformComponent& transform = _registry->getComponent<TransformComponent>(node.entity);
+    if (node.parent == ROOT) {
+      transform.world = transform.model;
+    } else {
+      const TransformComponent& parent =
+          _registry->getComponent<TransformComponent>(_nodes[node.parent].entity);
+      lib::multiplyMat4(&parent.world[0][0], &transform.model[0][0], &transform.world[0][0]);
+    }
+  }
+}
+
+void TransformSystem::update(float) {
+  const uint32_t since = _lastTick;
+  _lastTick = _registry->getTick();
+
+  auto view = _registry->view<const TransformComponent, const HierarchyComponent>();
+  bool structureChanged = view.size() != _nodes.size();
+  if (!structureChanged) {
+    view.each(Changed<HierarchyComponent>{since},
+              [&structureChanged](const TransformComponent&, const HierarchyComponent&) {
+                structureChanged = true;
+              });
+  }
+
+  if (structureChanged) {
+    rebuild(view.getEntities());
+    _dirty.assign(_nodes.size(), 1);
+  } else {
+    _dirty.assign(_nodes.size(), 0);
+    view.each(Changed<TransformComponent>{since},
+              [this](Entity entity, const TransformComponent&, const HierarchyComponent&) {
+                _dirty[_slots[getEntityIndex(entity)]] = 1;
+              });
+  }
+
+  // Entities without a hierarchy use their model matrix as world matrix. A structural change may
+  // have detached entities from the hierarchy, so all of them are refreshed then.
+  _registry->view<const TransformComponent>().each(
+      Changed<TransformComponent>{structureChanged ? 0 : since},
+      [this](Entity entity, const TransformComponent&) {
+        if (!_registry->hasComponent<HierarchyComponent>(entity)) {
+          TransformComponent& transform = _registry->getComponent<TransformComponent>(entity);
+          transform.world = transform.model;
+        }
+      });
+
+  for (size_t level = 0; level + 1 < _levels.size(); ++level) {
+    const size_t begin = _levels[level];
+    const size_t size = _levels[level + 1] - begin;
+    if (_threadPool && size > GRAIN_SIZE) {
+      _threadPool->parallelFor(size, GRAIN_SIZE, [this, begin](size_t first, size_t last) {
+        updateRange(begin + first, begin + last);
+      });
+    } else {
+      updateRange(begin, begin + size);
+    }
+  }
+}
+
+SystemAccess TransformSystem::getAccess() const {
+  return SystemAccess{.reads = getSignature<HierarchyComponent>(),
+                      .writes = getSignature<TransformComponent>(),
+                      .exclusive = false};
+}
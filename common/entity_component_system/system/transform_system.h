@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/entity_component_system/registry/registry.h"
+#include "system.h"
+
+// Computes TransformComponent::world for entities owning a HierarchyComponent, other entities
+// copy their model matrix. Entities of the hierarchy are kept in a flat array sorted by depth,
+// so every level only reads worlds computed by the previous one and can be split across the
+// thread pool. Only subtrees whose local transform changed since the previous update are
+// recomputed.
+class TransformSystem : public System {
+  static constexpr uint32_t ROOT = UINT32_MAX;
+
+  struct Node {
+    Entity entity;
+    uint32_t parent;  // Index into _nodes or ROOT.
+  };
+
+  Registry* _registry;
+  std::vector<Node> _nodes;
+  std::vector<size_t> _levels;    // Offsets of every depth in _nodes followed by the end.
+  std::vector<uint32_t> _slots;   // Entity index to the index in _nodes.
+  std::vector<uint8_t> _dirty;
+  uint32_t _lastTick = 0;
+
+  void rebuild(std::span<const Entity> entities);
+
+  void updateRange(size_t begin, size_t end);
+
+public:
+  explicit TransformSystem(Registry* registry);
+
+  void update(float deltaTime) override;
+
+  SystemAccess getAccess() const override;
+
+  size_t getDepth() const {
+    return _levels.empty() ? 0 : _levels.size() - 1;
+  }
+};
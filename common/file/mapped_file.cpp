@@ -0,0 +1,121 @@
+#include "mapped_file.h"
+
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)) {
+#ifdef _WIN32
+  _file = std::exchange(other._file, nullptr);
+  _mapping = std::exchange(other._mapping, nullptr);
+#endif
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    close();
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+#ifdef _WIN32
+    _file = std::exchange(other._file, nullptr);
+    _mapping = std::exchange(other._mapping, nullptr);
+#endif
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+#ifdef _WIN32
+
+ErrorOr<MappedFile> MappedFile::open(std::string_view filePath) {
+  MappedFile mappedFile;
+  mappedFile._file = CreateFileA(std::string(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                 nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (mappedFile._file == INVALID_HANDLE_VALUE) {
+    mappedFile._file = nullptr;
+    return Error(EngineError::LOAD_FAILURE);
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(mappedFile._file, &size)) {
+    return Error(EngineError::LOAD_FAILURE);
+  }
+  mappedFile._size = static_cast<size_t>(size.QuadPart);
+  if (mappedFile._size == 0) {
+    return mappedFile;
+  }
+  mappedFile._mapping = CreateFileMappingA(mappedFile._file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mappedFile._mapping) {
+    return Error(EngineError::LOAD_FAILURE);
+  }
+  mappedFile._data = static_cast<const std::byte*>(
+      MapViewOfFile(mappedFile._mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!mappedFile._data) {
+    return Error(EngineError::LOAD_FAILURE);
+  }
+  return mappedFile;
+}
+
+void MappedFile::close() {
+  if (_data) {
+    UnmapViewOfFile(_data);
+  }
+  if (_mapping) {
+    CloseHandle(_mapping);
+  }
+  if (_file) {
+    CloseHandle(_file);
+  }
+  _data = nullptr;
+  _mapping = nullptr;
+  _file = nullptr;
+  _size = 0;
+}
+
+#else
+
+ErrorOr<MappedFile> MappedFile::open(std::string_view filePath) {
+  const int file = ::open(std::string(filePath).c_str(), O_RDONLY);
+  if (file < 0) {
+    return Error(EngineError::LOAD_FAILURE);
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0) {
+    ::close(file);
+    return Error(EngineError::LOAD_FAILURE);
+  }
+  MappedFile mappedFile;
+  mappedFile._size = static_cast<size_t>(status.st_size);
+  if (mappedFile._size != 0) {
+    void* data = mmap(nullptr, mappedFile._size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (data == MAP_FAILED) {
+      ::close(file);
+      return Error(EngineError::LOAD_FAILURE);
+    }
+    mappedFile._data = static_cast<const std::byte*>(data);
+  }
+  // The mapping stays valid after closing the descriptor.
+  ::close(file);
+  return mappedFile;
+}
+
+void MappedFile::close() {
+  if (_data) {
+    munmap(const_cast<std::byte*>(_data), _size);
+  }
+  _data = nullptr;
+  _size = 0;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#include "common/status/status.h"
+
+// Read-only memory mapping of a whole file. The pages are loaded lazily by the OS, so opening
+// is cheap regardless of the file size.
+class MappedFile {
+  const std::byte* _data = nullptr;
+  size_t _size = 0;
+#ifdef _WIN32
+  void* _file = nullptr;
+  void* _mapping = nullptr;
+#endif
+
+  void close();
+
+public:
+  MappedFile() = default;
+
+  MappedFile(MappedFile&& other) noexcept;
+
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  ~MappedFile();
+
+  static ErrorOr<MappedFile> open(std::string_view filePath);
+
+  std::span<const std::byte> getData() const {
+    return {_data, _size};
+  }
+};
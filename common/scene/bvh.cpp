@@ -0,0 +1,453 @@
+#include "bvh.h"
+
+#include <atomic>
+#include <cassert>
+#include <numeric>
+
+#include "lib/simd/simd.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+// Subtrees with fewer primitives are built on the thread building their parent.
+constexpr uint32_t PARALLEL_BUILD_SIZE = 4096;
+
+constexpr AABB EMPTY_VOLUME = {.lowerCorner = glm::vec3(std::numeric_limits<float>::max()),
+                               .upperCorner = glm::vec3(std::numeric_limits<float>::lowest())};
+
+// Inlined AABB::extend, the build spends most of its time merging volumes.
+void merge(AABB& volume, const AABB& other) {
+  volume.lowerCorner = glm::min(volume.lowerCorner, other.lowerCorner);
+  volume.upperCorner = glm::max(volume.upperCorner, other.upperCorner);
+}
+
+float getHalfArea(const AABB& volume) {
+  const glm::vec3 size = volume.upperCorner - volume.lowerCorner;
+  return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+}  // namespace
+
+class BvhBuilder {
+  using Node = Bvh::Node;
+
+  struct Range {
+    uint32_t begin;
+    uint32_t end;
+
+    uint32_t size() const {
+      return end - begin;
+    }
+  };
+
+  Bvh& _bvh;
+  std::vector<glm::vec3> _centroids;
+  std::atomic<uint32_t> _nodeCount = 1;
+  lib::ThreadPool* _threadPool;
+
+  AABB getVolume(Range range) const {
+    AABB volume = EMPTY_VOLUME;
+    for (uint32_t i = range.begin; i < range.end; ++i) {
+      merge(volume, _bvh._volumes[_bvh._primitives[i]]);
+    }
+    return volume;
+  }
+
+  uint32_t getBin(uint32_t primitive, uint32_t axis, float lower, float scale) const {
+    const float offset = (_centroids[primitive][axis] - lower) * scale;
+    return std::min(static_cast<uint32_t>(offset), Bvh::BIN_COUNT - 1);
+  }
+
+  uint32_t splitAtMedian(Range range, uint32_t axis) {
+    const uint32_t middle = range.begin + range.size() / 2;
+    std::nth_element(_bvh._primitives.begin() + range.begin, _bvh._primitives.begin() + middle,
+                     _bvh._primitives.begin() + range.end, [&](uint32_t lhs, uint32_t rhs) {
+                       return _centroids[lhs][axis] < _centroids[rhs][axis];
+                     });
+    return middle;
+  }
+
+  // Returns the end of the first half. Both halves are not empty.
+  uint32_t split(Range range, uint32_t depth) {
+    glm::vec3 lower = _centroids[_bvh._primitives[range.begin]];
+    glm::vec3 upper = lower;
+    for (uint32_t i = range.begin; i < range.end; ++i) {
+      lower = glm::min(lower, _centroids[_bvh._primitives[i]]);
+      upper = glm::max(upper, _centroids[_bvh._primitives[i]]);
+    }
+    const glm::vec3 extent = upper - lower;
+    const uint32_t longestAxis =
+        extent.x >= extent.y ? (extent.x >= extent.z ? 0 : 2) : (extent.y >= extent.z ? 1 : 2);
+    if (depth >= Bvh::SAH_DEPTH || extent[longestAxis] == 0.0f) {
+      return splitAtMedian(range, longestAxis);
+    }
+
+    // All axes are binned in one pass over the range.
+    glm::vec3 scale;
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+      scale[axis] = extent[axis] > 0.0f ? static_cast<float>(Bvh::BIN_COUNT) / extent[axis] : 0.0f;
+    }
+    std::array<std::array<uint32_t, Bvh::BIN_COUNT>, 3> counts = {};
+    std::array<std::array<AABB, Bvh::BIN_COUNT>, 3> volumes;
+    for (std::array<AABB, Bvh::BIN_COUNT>& axisVolumes : volumes) {
+      axisVolumes.fill(EMPTY_VOLUME);
+    }
+    for (uint32_t i = range.begin; i < range.end; ++i) {
+      const uint32_t primitive = _bvh._primitives[i];
+      for (uint32_t axis = 0; axis < 3; ++axis) {
+        const uint32_t bin = getBin(primitive, axis, lower[axis], scale[axis]);
+        ++counts[axis][bin];
+        merge(volumes[axis][bin], _bvh._volumes[primitive]);
+      }
+    }
+
+    // Cost of a split after a bin is the half area of each side times its primitive count.
+    float bestCost = std::numeric_limits<float>::infinity();
+    uint32_t bestAxis = 0;
+    uint32_t bestBin = 0;
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+      if (extent[axis] == 0.0f) {
+        continue;
+      }
+      std::array<float, Bvh::BIN_COUNT> rightCosts;
+      AABB rightVolume = EMPTY_VOLUME;
+      uint32_t rightCount = 0;
+      for (uint32_t bin = Bvh::BIN_COUNT - 1; bin > 0; --bin) {
+        merge(rightVolume, volumes[axis][bin]);
+        rightCount += counts[axis][bin];
+        rightCosts[bin - 1] = rightCount > 0 ? getHalfArea(rightVolume) * rightCount : -1.0f;
+      }
+      AABB leftVolume = EMPTY_VOLUME;
+      uint32_t leftCount = 0;
+      for (uint32_t bin = 0; bin + 1 < Bvh::BIN_COUNT; ++bin) {
+        merge(leftVolume, volumes[axis][bin]);
+        leftCount += counts[axis][bin];
+        if (leftCount == 0 || rightCosts[bin] < 0.0f) {
+          continue;
+        }
+        const float cost = getHalfArea(leftVolume) * leftCount + rightCosts[bin];
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestAxis = axis;
+          bestBin = bin;
+        }
+      }
+    }
+    if (bestCost == std::numeric_limits<float>::infinity()) {
+      return splitAtMedian(range, longestAxis);
+    }
+
+    const auto middle = std::partition(
+        _bvh._primitives.begin() + range.begin, _bvh._primitives.begin() + range.end,
+        [&](uint32_t primitive) {
+          return getBin(primitive, bestAxis, lower[bestAxis], scale[bestAxis]) <= bestBin;
+        });
+    return static_cast<uint32_t>(middle - _bvh._primitives.begin());
+  }
+
+  // Splits the largest ranges until the node has WIDTH children or only leaves are left.
+  void buildNode(uint32_t nodeIndex, Range range, uint32_t depth) {
+    std::array<Range, Bvh::WIDTH> ranges;
+    uint32_t rangeCount = 1;
+    ranges[0] = range;
+    while (rangeCount < Bvh::WIDTH) {
+      Range* largest = std::max_element(ranges.begin(), ranges.begin() + rangeCount,
+                                        [](const Range& lhs, const Range& rhs) {
+                                          return lhs.size() < rhs.size();
+                                        });
+      if (largest->size() <= Bvh::LEAF_SIZE) {
+        break;
+      }
+      const uint32_t middle = split(*largest, depth);
+      ranges[rangeCount++] = Range{middle, largest->end};
+      largest->end = middle;
+    }
+
+    Node& node = _bvh._nodes[nodeIndex];
+    node = Node{};
+    node.childCount = rangeCount;
+    lib::TaskGroup group;
+    for (uint32_t i = 0; i < rangeCount; ++i) {
+      const AABB volume = getVolume(ranges[i]);
+      node.minX[i] = volume.lowerCorner.x;
+      node.minY[i] = volume.lowerCorner.y;
+      node.minZ[i] = volume.lowerCorner.z;
+      node.maxX[i] = volume.upperCorner.x;
+      node.maxY[i] = volume.upperCorner.y;
+      node.maxZ[i] = volume.upperCorner.z;
+      if (ranges[i].size() <= Bvh::LEAF_SIZE) {
+        node.children[i] = ranges[i].begin;
+        node.primitiveCounts[i] = ranges[i].size();
+        continue;
+      }
+      const uint32_t child = _nodeCount.fetch_add(1, std::memory_order_relaxed);
+      node.children[i] = child;
+      if (_threadPool && ranges[i].size() >= PARALLEL_BUILD_SIZE) {
+        _threadPool->submit(group, [this, child, childRange = ranges[i], depth] {
+          buildNode(child, childRange, depth + 1);
+        });
+      } else {
+        buildNode(child, ranges[i], depth + 1);
+      }
+    }
+    if (_threadPool) {
+      _threadPool->wait(group);
+    }
+  }
+
+public:
+  BvhBuilder(Bvh& bvh, lib::ThreadPool* threadPool)
+    : _bvh(bvh), _centroids(bvh._volumes.size()), _threadPool(threadPool) {
+    std::transform(bvh._volumes.cbegin(), bvh._volumes.cend(), _centroids.begin(),
+                   [](const AABB& volume) {
+                     return 0.5f * (volume.lowerCorner + volume.upperCorner);
+                   });
+  }
+
+  // Every node has at least two children except the root, so there are fewer nodes than
+  // primitives.
+  void build() {
+    const uint32_t primitiveCount = static_cast<uint32_t>(_bvh._volumes.size());
+    _bvh._primitives.resize(primitiveCount);
+    std::iota(_bvh._primitives.begin(), _bvh._primitives.end(), 0);
+    _bvh._nodes.resize(std::max(primitiveCount, 1u));
+    buildNode(0, Range{0, primitiveCount}, 0);
+    _bvh._nodes.resize(_nodeCount.load(std::memory_order_relaxed));
+  }
+};
+
+size_t Bvh::build(std::span<const AABB> volumes, lib::ThreadPool* threadPool) {
+  _volumes.assign(volumes.begin(), volumes.end());
+  _nodes.clear();
+  _primitives.clear();
+  if (!_volumes.empty()) {
+    BvhBuilder(*this, threadPool).build();
+  }
+  return _nodes.size();
+}
+
+void Bvh::refit(std::span<const AABB> volumes) {
+  assert(volumes.size() == _volumes.size());
+  _volumes.assign(volumes.begin(), volumes.end());
+  for (auto node = _nodes.rbegin(); node != _nodes.rend(); ++node) {
+    for (uint32_t i = 0; i < node->childCount; ++i) {
+      AABB volume = EMPTY_VOLUME;
+      if (node->primitiveCounts[i] > 0) {
+        for (uint32_t j = node->children[i]; j < node->children[i] + node->primitiveCounts[i];
+             ++j) {
+          merge(volume, _volumes[_primitives[j]]);
+        }
+      } else {
+        const Node& child = _nodes[node->children[i]];
+        for (uint32_t j = 0; j < child.childCount; ++j) {
+          merge(volume, AABB{glm::vec3(child.minX[j], child.minY[j], child.minZ[j]),
+                             glm::vec3(child.maxX[j], child.maxY[j], child.maxZ[j])});
+        }
+      }
+      node->minX[i] = volume.lowerCorner.x;
+      node->minY[i] = volume.lowerCorner.y;
+      node->minZ[i] = volume.lowerCorner.z;
+      node->maxX[i] = volume.upperCorner.x;
+      node->maxY[i] = volume.upperCorner.y;
+      node->maxZ[i] = volume.upperCorner.z;
+    }
+  }
+}
+
+uint32_t Bvh::intersectChildren(const Node& node, const Ray& ray,
+                                const glm::vec3& inverseDirection, float maxDistance,
+                                std::array<float, WIDTH>& distances) {
+  uint32_t mask = 0;
+#if defined(LIB_SIMD_SSE)
+  const auto slab = [](const std::array<float, WIDTH>& lower, const std::array<float, WIDTH>& upper,
+                       float origin, float inverse, __m128& near, __m128& far) {
+    const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(lower.data()), _mm_set1_ps(origin)),
+                                 _mm_set1_ps(inverse));
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(upper.data()), _mm_set1_ps(origin)),
+                                 _mm_set1_ps(inverse));
+    near = _mm_min_ps(t0, t1);
+    far = _mm_max_ps(t0, t1);
+  };
+  __m128 nearX, farX, nearY, farY, nearZ, farZ;
+  slab(node.minX, node.maxX, ray.origin.x, inverseDirection.x, nearX, farX);
+  slab(node.minY, node.maxY, ray.origin.y, inverseDirection.y, nearY, farY);
+  slab(node.minZ, node.maxZ, ray.origin.z, inverseDirection.z, nearZ, farZ);
+  const __m128 near =
+      _mm_max_ps(_mm_max_ps(nearX, nearY), _mm_max_ps(nearZ, _mm_setzero_ps()));
+  const __m128 far = _mm_min_ps(_mm_min_ps(farX, farY), _mm_min_ps(farZ, _mm_set1_ps(maxDistance)));
+  mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(near, far)));
+  _mm_storeu_ps(distances.data(), near);
+#elif defined(LIB_SIMD_NEON)
+  const auto slab = [](const std::array<float, WIDTH>& lower, const std::array<float, WIDTH>& upper,
+                       float origin, float inverse, float32x4_t& near, float32x4_t& far) {
+    const float32x4_t t0 = vmulq_f32(vsubq_f32(vld1q_f32(lower.data()), vdupq_n_f32(origin)),
+                                     vdupq_n_f32(inverse));
+    const float32x4_t t1 = vmulq_f32(vsubq_f32(vld1q_f32(upper.data()), vdupq_n_f32(origin)),
+                                     vdupq_n_f32(inverse));
+    near = vminq_f32(t0, t1);
+    far = vmaxq_f32(t0, t1);
+  };
+  float32x4_t nearX, farX, nearY, farY, nearZ, farZ;
+  slab(node.minX, node.maxX, ray.origin.x, inverseDirection.x, nearX, farX);
+  slab(node.minY, node.maxY, ray.origin.y, inverseDirection.y, nearY, farY);
+  slab(node.minZ, node.maxZ, ray.origin.z, inverseDirection.z, nearZ, farZ);
+  const float32x4_t near =
+      vmaxq_f32(vmaxq_f32(nearX, nearY), vmaxq_f32(nearZ, vdupq_n_f32(0.0f)));
+  const float32x4_t far =
+      vminq_f32(vminq_f32(farX, farY), vminq_f32(farZ, vdupq_n_f32(maxDistance)));
+  const uint32x4_t laneBits = {1, 2, 4, 8};
+  mask = vaddvq_u32(vandq_u32(vcleq_f32(near, far), laneBits));
+  vst1q_f32(distances.data(), near);
+#else
+  for (uint32_t i = 0; i < WIDTH; ++i) {
+    const auto slab = [&](float lower, float upper, float origin, float inverse) {
+      const float t0 = (lower - origin) * inverse;
+      const float t1 = (upper - origin) * inverse;
+      return std::pair(std::min(t0, t1), std::max(t0, t1));
+    };
+    const auto [nearX, farX] = slab(node.minX[i], node.maxX[i], ray.origin.x, inverseDirection.x);
+    const auto [nearY, farY] = slab(node.minY[i], node.maxY[i], ray.origin.y, inverseDirection.y);
+    const auto [nearZ, farZ] = slab(node.minZ[i], node.maxZ[i], ray.origin.z, inverseDirection.z);
+    const float near = std::max(std::max(nearX, nearY), std::max(nearZ, 0.0f));
+    const float far = std::min(std::min(farX, farY), std::min(farZ, maxDistance));
+    mask |= uint32_t(near <= far) << i;
+    distances[i] = near;
+  }
+#endif
+  return mask & ((1u << node.childCount) - 1);
+}
+
+uint32_t Bvh::overlapChildren(const Node& node, const AABB& volume) {
+  uint32_t mask = 0;
+#if defined(LIB_SIMD_SSE)
+  const auto overlaps = [](const std::array<float, WIDTH>& lower,
+                           const std::array<float, WIDTH>& upper, float volumeLower,
+                           float volumeUpper) {
+    return _mm_and_ps(_mm_cmple_ps(_mm_load_ps(lower.data()), _mm_set1_ps(volumeUpper)),
+                      _mm_cmpge_ps(_mm_load_ps(upper.data()), _mm_set1_ps(volumeLower)));
+  };
+  const __m128 result = _mm_and_ps(
+      _mm_and_ps(overlaps(node.minX, node.maxX, volume.lowerCorner.x, volume.upperCorner.x),
+                 overlaps(node.minY, node.maxY, volume.lowerCorner.y, volume.upperCorner.y)),
+      overlaps(node.minZ, node.maxZ, volume.lowerCorner.z, volume.upperCorner.z));
+  mask = static_cast<uint32_t>(_mm_movemask_ps(result));
+#elif defined(LIB_SIMD_NEON)
+  const auto overlaps = [](const std::array<float, WIDTH>& lower,
+                           const std::array<float, WIDTH>& upper, float volumeLower,
+                           float volumeUpper) {
+    return vandq_u32(vcleq_f32(vld1q_f32(lower.data()), vdupq_n_f32(volumeUpper)),
+                     vcgeq_f32(vld1q_f32(upper.data()), vdupq_n_f32(volumeLower)));
+  };
+  const uint32x4_t result = vandq_u32(
+      vandq_u32(overlaps(node.minX, node.maxX, volume.lowerCorner.x, volume.upperCorner.x),
+                overlaps(node.minY, node.maxY, volume.lowerCorner.y, volume.upperCorner.y)),
+      overlaps(node.minZ, node.maxZ, volume.lowerCorner.z, volume.upperCorner.z));
+  const uint32x4_t laneBits = {1, 2, 4, 8};
+  mask = vaddvq_u32(vandq_u32(result, laneBits));
+#else
+  for (uint32_t i = 0; i < WIDTH; ++i) {
+    const bool overlaps = node.minX[i] <= volume.upperCorner.x
+                          && node.maxX[i] >= volume.lowerCorner.x
+                          && node.minY[i] <= volume.upperCorner.y
+                          && node.maxY[i] >= volume.lowerCorner.y
+                          && node.minZ[i] <= volume.upperCorner.z
+                          && node.maxZ[i] >= volume.lowerCorner.z;
+    mask |= uint32_t(overlaps) << i;
+  }
+#endif
+  return mask & ((1u << node.childCount) - 1);
+}
+
+std::optional<RayHit> Bvh::raycast(const Ray& ray, float maxDistance) const {
+  return raycast(ray, maxDistance, [&](uint32_t primitive) {
+    return intersectRay(ray, _volumes[primitive]);
+  });
+}
+
+std::optional<RayHit> Bvh::segmentcast(const glm::vec3& start, const glm::vec3& end) const {
+  const float length = glm::length(end - start);
+  if (!(length > 0.0f)) {
+    return std::nullopt;
+  }
+  return raycast(Ray{start, (end - start) / length}, length);
+}
+
+void Bvh::overlap(const AABB& volume, std::vector<uint32_t>& primitives) const {
+  if (_nodes.empty()) {
+    return;
+  }
+  std::array<uint32_t, (WIDTH - 1) * MAX_DEPTH + 1> stack;
+  size_t stackSize = 0;
+  stack[stackSize++] = 0;
+  while (stackSize > 0) {
+    const Node& node = _nodes[stack[--stackSize]];
+    for (uint32_t mask = overlapChildren(node, volume); mask; mask &= mask - 1) {
+      const uint32_t child = std::countr_zero(mask);
+      if (node.primitiveCounts[child] == 0) {
+        stack[stackSize++] = node.children[child];
+        continue;
+      }
+      for (uint32_t i = node.children[child];
+           i < node.children[child] + node.primitiveCounts[child]; ++i) {
+        const AABB& primitiveVolume = _volumes[_primitives[i]];
+        if (glm::all(glm::lessThanEqual(primitiveVolume.lowerCorner, volume.upperCorner))
+            && glm::all(glm::greaterThanEqual(primitiveVolume.upperCorner, volume.lowerCorner))) {
+          primitives.push_back(_primitives[i]);
+        }
+      }
+    }
+  }
+}
+
+std::optional<float> intersectRay(const Ray& ray, const AABB& volume) {
+  const glm::vec3 inverseDirection = 1.0f / ray.direction;
+  const glm::vec3 t0 = (volume.lowerCorner - ray.origin) * inverseDirection;
+  const glm::vec3 t1 = (volume.upperCorner - ray.origin) * inverseDirection;
+  const glm::vec3 near = glm::min(t0, t1);
+  const glm::vec3 far = glm::max(t0, t1);
+  const float entry = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+  const float exit = std::min(std::min(far.x, far.y), far.z);
+  if (!(entry <= exit)) {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+std::optional<float> intersectRay(
+    const Ray& ray, const glm::vec3& vertex0, const glm::vec3& vertex1, const glm::vec3& vertex2) {
+  const glm::vec3 edge1 = vertex1 - vertex0;
+  const glm::vec3 edge2 = vertex2 - vertex0;
+  const glm::vec3 p = glm::cross(ray.direction, edge2);
+  const float determinant = glm::dot(edge1, p);
+  if (std::abs(determinant) < std::numeric_limits<float>::epsilon()) {
+    return std::nullopt;
+  }
+  const float inverseDeterminant = 1.0f / determinant;
+  const glm::vec3 offset = ray.origin - vertex0;
+  const float u = glm::dot(offset, p) * inverseDeterminant;
+  if (u < 0.0f || u > 1.0f) {
+    return std::nullopt;
+  }
+  const glm::vec3 q = glm::cross(offset, edge1);
+  const float v = glm::dot(ray.direction, q) * inverseDeterminant;
+  if (v < 0.0f || u + v > 1.0f) {
+    return std::nullopt;
+  }
+  const float distance = glm::dot(edge2, q) * inverseDeterminant;
+  if (distance < 0.0f) {
+    return std::nullopt;
+  }
+  return distance;
+}
+
+void createTriangleVolumes(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                           std::vector<AABB>& volumes) {
+  volumes.reserve(volumes.size() + indices.size() / 3);
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    const glm::vec3& vertex0 = positions[indices[i]];
+    const glm::vec3& vertex1 = positions[indices[i + 1]];
+    const glm::vec3& vertex2 = positions[indices[i + 2]];
+    volumes.push_back(AABB{glm::min(glm::min(vertex0, vertex1), vertex2),
+                           glm::max(glm::max(vertex0, vertex1), vertex2)});
+  }
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "common/util/geometry.h"
+
+namespace lib {
+class ThreadPool;
+}  // namespace lib
+
+struct Ray {
+  glm::vec3 origin;
+  glm::vec3 direction;
+};
+
+struct RayHit {
+  uint32_t primitive;
+  // Along the ray direction, in multiples of its length.
+  float distance;
+};
+
+// Bounding volume hierarchy over primitive AABBs, e.g. the volumes of objects or the triangles
+// of a mesh. Primitives are referred to by their index in the span given to build().
+//
+// Nodes have up to four children whose bounds are stored as one array per bound, so a ray or a
+// box is tested against all of them at once. build() splits ranges of primitives with a binned
+// surface area heuristic. refit() updates the bounds after primitives moved, keeping the tree.
+class Bvh {
+public:
+  static constexpr uint32_t WIDTH = 4;
+  // Ranges of at most this many primitives become leaves.
+  static constexpr uint32_t LEAF_SIZE = 4;
+  static constexpr uint32_t BIN_COUNT = 16;
+  // Deeper ranges are split at their median, which bounds the depth of the tree.
+  static constexpr uint32_t SAH_DEPTH = 32;
+  static constexpr uint32_t MAX_DEPTH = SAH_DEPTH + 32;
+
+private:
+  struct Node {
+    alignas(16) std::array<float, WIDTH> minX, minY, minZ;
+    alignas(16) std::array<float, WIDTH> maxX, maxY, maxZ;
+    // Index of the child node, or of the first primitive of a leaf in _primitives.
+    std::array<uint32_t, WIDTH> children;
+    // Number of primitives of a leaf, zero for child nodes.
+    std::array<uint32_t, WIDTH> primitiveCounts;
+    uint32_t childCount;
+  };
+
+  // Children are stored after their parent, so refit() updates the nodes in reverse order.
+  std::vector<Node> _nodes;
+  std::vector<uint32_t> _primitives;
+  std::vector<AABB> _volumes;
+
+  friend class BvhBuilder;
+
+  // Returns the mask of the children whose bounds the ray enters within maxDistance, with their
+  // entry distances.
+  static uint32_t intersectChildren(const Node& node, const Ray& ray,
+                                    const glm::vec3& inverseDirection, float maxDistance,
+                                    std::array<float, WIDTH>& distances);
+
+  static uint32_t overlapChildren(const Node& node, const AABB& volume);
+
+public:
+  // Returns the number of nodes. With a thread pool, large subtrees are built in parallel.
+  size_t build(std::span<const AABB> volumes, lib::ThreadPool* threadPool = nullptr);
+
+  // volumes must hold as many primitives as build() was called with.
+  void refit(std::span<const AABB> volumes);
+
+  // Closest primitive along the ray within maxDistance. intersect(primitive) returns the
+  // distance of the exact hit, if any. The overload without it reports hits of the volumes.
+  template <typename Intersect>
+  std::optional<RayHit> raycast(const Ray& ray, float maxDistance, Intersect&& intersect) const;
+
+  std::optional<RayHit> raycast(
+      const Ray& ray, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+  // Closest primitive between start and end, with the distance measured from start. A segment
+  // without hits is a clear line of sight.
+  template <typename Intersect>
+  std::optional<RayHit> segmentcast(const glm::vec3& start, const glm::vec3& end,
+                                    Intersect&& intersect) const {
+    const float length = glm::length(end - start);
+    if (!(length > 0.0f)) {
+      return std::nullopt;
+    }
+    return raycast(Ray{start, (end - start) / length}, length, intersect);
+  }
+
+  std::optional<RayHit> segmentcast(const glm::vec3& start, const glm::vec3& end) const;
+
+  // Appends the primitives whose volume intersects the volume, in no particular order.
+  void overlap(const AABB& volume, std::vector<uint32_t>& primitives) const;
+
+  const AABB& getVolume(uint32_t primitive) const {
+    return _volumes[primitive];
+  }
+
+  size_t getNodeCount() const {
+    return _nodes.size();
+  }
+
+  size_t size() const {
+    return _volumes.size();
+  }
+};
+
+// Distance along the ray to the box, zero if the origin is inside of it.
+std::optional<float> intersectRay(const Ray& ray, const AABB& volume);
+
+// Two sided ray/triangle test.
+std::optional<float> intersectRay(
+    const Ray& ray, const glm::vec3& vertex0, const glm::vec3& vertex1, const glm::vec3& vertex2);
+
+// Appends the volume of every triangle of an indexed triangle list, e.g. of the positions kept
+// in VertexData, to build a Bvh over the triangles of a mesh.
+void createTriangleVolumes(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                           std::vector<AABB>& volumes);
+
+template <typename Intersect>
+std::optional<RayHit> Bvh::raycast(const Ray& ray, float maxDistance,
+                                   Intersect&& intersect) const {
+  if (_nodes.empty()) {
+    return std::nullopt;
+  }
+  const glm::vec3 inverseDirection = 1.0f / ray.direction;
+  std::optional<RayHit> closest;
+
+  // Entries are children entered by the ray, the closest one is popped first.
+  struct Entry {
+    uint32_t child;
+    uint32_t primitiveCount;
+    float distance;
+  };
+  std::array<Entry, (WIDTH - 1) * MAX_DEPTH + 1> stack;
+  size_t stackSize = 0;
+  stack[stackSize++] = Entry{0, 0, 0.0f};
+  while (stackSize > 0) {
+    const Entry entry = stack[--stackSize];
+    if (entry.distance > maxDistance) {
+      continue;
+    }
+    if (entry.primitiveCount > 0) {
+      for (uint32_t i = entry.child; i < entry.child + entry.primitiveCount; ++i) {
+        const std::optional<float> distance = intersect(_primitives[i]);
+        if (distance && *distance >= 0.0f && *distance <= maxDistance) {
+          maxDistance = *distance;
+          closest = RayHit{_primitives[i], *distance};
+        }
+      }
+      continue;
+    }
+
+    const Node& node = _nodes[entry.child];
+    std::array<float, WIDTH> distances;
+    const size_t first = stackSize;
+    for (uint32_t mask = intersectChildren(node, ray, inverseDirection, maxDistance, distances);
+         mask; mask &= mask - 1) {
+      const uint32_t child = std::countr_zero(mask);
+      stack[stackSize++] =
+          Entry{node.children[child], node.primitiveCounts[child], distances[child]};
+    }
+    // Farthest first, so the closest child is on top.
+    std::sort(stack.begin() + first, stack.begin() + stackSize,
+              [](const Entry& lhs, const Entry& rhs) {
+                return lhs.distance > rhs.distance;
+              });
+  }
+  return closest;
+}
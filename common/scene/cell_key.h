@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Keys of uniform grid cells, every coordinate is stored in 21 bits. Coordinates beyond
+// +-MAX_CELL_COORDINATE wrap around and share the key of a nearer cell.
+constexpr uint32_t CELL_COORDINATE_BITS = 21;
+constexpr int32_t MAX_CELL_COORDINATE = (1 << (CELL_COORDINATE_BITS - 1)) - 1;
+constexpr uint64_t CELL_COORDINATE_MASK = (uint64_t(1) << CELL_COORDINATE_BITS) - 1;
+
+inline uint64_t packCellKey(const glm::ivec3& coordinates) {
+  return ((static_cast<uint64_t>(coordinates.x) & CELL_COORDINATE_MASK)
+          << (2 * CELL_COORDINATE_BITS))
+         | ((static_cast<uint64_t>(coordinates.y) & CELL_COORDINATE_MASK) << CELL_COORDINATE_BITS)
+         | (static_cast<uint64_t>(coordinates.z) & CELL_COORDINATE_MASK);
+}
@@ -0,0 +1,298 @@
+#include "linear_octree.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <limits>
+
+#include "lib/radix_sort/radix_sort.h"
+#include "lib/simd/plane_set.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+constexpr uint32_t GRID_SIZE = 1u << LinearOctree::MAX_DEPTH;
+constexpr unsigned INDEX_BITS = 30;
+constexpr uint64_t INDEX_MASK = (uint64_t(1) << INDEX_BITS) - 1;
+constexpr uint64_t INVALID_KEY = std::numeric_limits<uint64_t>::max();
+constexpr size_t GRAIN_SIZE = 16384;
+
+uint64_t expandBits(uint32_t value) {
+  uint64_t bits = value & 0x3ff;
+  bits = (bits | (bits << 16)) & 0x30000ff;
+  bits = (bits | (bits << 8)) & 0x300f00f;
+  bits = (bits | (bits << 4)) & 0x30c30c3;
+  bits = (bits | (bits << 2)) & 0x9249249;
+  return bits;
+}
+
+uint64_t getMortonCode(glm::uvec3 cell) {
+  return expandBits(cell.x) | (expandBits(cell.y) << 1) | (expandBits(cell.z) << 2);
+}
+
+uint32_t getLevel(uint64_t code) {
+  return (std::bit_width(code) - 1) / 3;
+}
+
+// Depth-first order of cells: by the Morton code of their lower corner at the finest level,
+// parents before their first child.
+uint64_t getSortKey(uint64_t code) {
+  const uint32_t level = getLevel(code);
+  const uint64_t morton = (code ^ (uint64_t(1) << (3 * level)))
+                          << (3 * (LinearOctree::MAX_DEPTH - level));
+  return (morton << 4) | level;
+}
+
+lib::PlaneSet createPlaneSet(std::span<const glm::vec4> planes) {
+  return lib::PlaneSet(std::span<const float>(&planes.data()->x, planes.size() * 4));
+}
+
+// Plane bits of the first view of a view plane set, its padding planes always contain boxes.
+constexpr uint64_t VIEW_PLANE_BITS = (uint64_t(1) << LinearOctree::VIEW_PLANE_COUNT) - 1;
+
+void appendVisible(std::span<const Object* const> objects, uint32_t viewMask,
+                   std::vector<VisibleObject>& visible) {
+  const size_t offset = visible.size();
+  visible.resize(offset + objects.size());
+  std::transform(objects.begin(), objects.end(), visible.begin() + offset,
+                 [viewMask](const Object* object) {
+                   return VisibleObject{object, viewMask};
+                 });
+}
+
+AABB getChildVolume(const AABB& volume, uint32_t child) {
+  const glm::vec3 middle = 0.5f * (volume.lowerCorner + volume.upperCorner);
+  AABB result = volume;
+  for (int axis = 0; axis < 3; ++axis) {
+    if (child & (1u << axis)) {
+      result.lowerCorner[axis] = middle[axis];
+    } else {
+      result.upperCorner[axis] = middle[axis];
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+LinearOctree::LinearOctree(const AABB& volume) : _volume(volume) {}
+
+size_t LinearOctree::build(std::span<const Entry> entries, lib::ThreadPool* threadPool) {
+  assert(entries.size() <= INDEX_MASK && "Too many objects for the packed sort keys");
+  const glm::vec3 scale =
+      float(GRID_SIZE) / glm::max(_volume.upperCorner - _volume.lowerCorner, glm::vec3(1e-6f));
+  const auto quantize = [&](const glm::vec3& point) {
+    const glm::vec3 cell = glm::clamp((point - _volume.lowerCorner) * scale, glm::vec3(0.0f),
+                                      glm::vec3(float(GRID_SIZE - 1)));
+    return glm::uvec3(cell);
+  };
+
+  // Key of an entry: the sort key of its cell in the high bits, its index in the low ones.
+  _keys.resize(entries.size());
+  _scratch.resize(entries.size());
+  const auto computeKeys = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (!_volume.contains(entries[i].volume)) [[unlikely]] {
+        _keys[i] = INVALID_KEY;
+        continue;
+      }
+      const glm::uvec3 lower = quantize(entries[i].volume.lowerCorner);
+      const glm::uvec3 upper = quantize(entries[i].volume.upperCorner);
+      const glm::uvec3 difference = lower ^ upper;
+      const uint32_t level =
+          MAX_DEPTH - std::bit_width(difference.x | difference.y | difference.z);
+      const uint64_t code = (uint64_t(1) << (3 * level))
+                            | (getMortonCode(lower) >> (3 * (MAX_DEPTH - level)));
+      _keys[i] = (getSortKey(code) << INDEX_BITS) | i;
+    }
+  };
+  if (threadPool) {
+    threadPool->parallelFor(entries.size(), GRAIN_SIZE, computeKeys);
+  } else {
+    computeKeys(0, entries.size());
+  }
+  lib::radixSort<uint64_t>(_keys, _scratch, INDEX_BITS, 64, threadPool);
+
+  const size_t count =
+      std::lower_bound(_keys.cbegin(), _keys.cend(), INVALID_KEY) - _keys.cbegin();
+  _objects.resize(count);
+  _nodes.clear();
+  _nodes.push_back(Node{.code = 1,
+                        .volume = _volume,
+                        .firstObject = 0,
+                        .objectCount = 0,
+                        .subtreeEnd = 0,
+                        .subtreeObjectEnd = 0});
+
+  // Walks the sorted objects keeping the path from the root to the current cell on a stack.
+  // Cells are opened on first use, a cell is closed once an object outside of it shows up.
+  std::array<uint32_t, MAX_DEPTH + 1> path;
+  uint32_t depth = 0;
+  path[0] = 0;
+  const auto close = [&](uint32_t objectEnd) {
+    Node& node = _nodes[path[depth]];
+    node.subtreeEnd = static_cast<uint32_t>(_nodes.size());
+    node.subtreeObjectEnd = objectEnd;
+  };
+  for (size_t i = 0; i < count; ++i) {
+    const uint64_t sortKey = _keys[i] >> INDEX_BITS;
+    const uint32_t level = sortKey & 0xf;
+    const uint64_t code = (uint64_t(1) << (3 * level))
+                          | ((sortKey >> 4) >> (3 * (MAX_DEPTH - level)));
+    while (depth > level || (code >> (3 * (level - depth))) != _nodes[path[depth]].code) {
+      close(static_cast<uint32_t>(i));
+      --depth;
+    }
+    while (depth < level) {
+      ++depth;
+      const uint64_t childCode = code >> (3 * (level - depth));
+      path[depth] = static_cast<uint32_t>(_nodes.size());
+      _nodes.push_back(Node{.code = childCode,
+                            .volume = getChildVolume(_nodes[path[depth - 1]].volume,
+                                                     childCode & 7),
+                            .firstObject = static_cast<uint32_t>(i),
+                            .objectCount = 0,
+                            .subtreeEnd = 0,
+                            .subtreeObjectEnd = 0});
+    }
+    ++_nodes[path[depth]].objectCount;
+    _objects[i] = entries[_keys[i] & INDEX_MASK].object;
+  }
+  for (;; --depth) {
+    close(static_cast<uint32_t>(count));
+    if (depth == 0) {
+      break;
+    }
+  }
+  return count;
+}
+
+void LinearOctree::querySubtree(uint32_t nodeIndex, std::span<const glm::vec4> planes,
+                                std::vector<const Object*>& objects) const {
+  if (_nodes.empty()) {
+    return;
+  }
+  const lib::PlaneSet planeSet = createPlaneSet(planes);
+  const uint64_t allPlanes = planes.empty() ? 0 : ~uint64_t(0) >> (64 - planes.size());
+  const uint32_t end = _nodes[nodeIndex].subtreeEnd;
+  uint32_t i = nodeIndex;
+  while (i < end) {
+    const Node& node = _nodes[i];
+    uint64_t outside;
+    uint64_t inside;
+    planeSet.classifyBox(&node.volume.lowerCorner.x, &node.volume.upperCorner.x, outside, inside);
+    if (outside) {
+      i = node.subtreeEnd;
+    } else if (inside == allPlanes) {
+      objects.insert(objects.end(), _objects.cbegin() + node.firstObject,
+                     _objects.cbegin() + node.subtreeObjectEnd);
+      i = node.subtreeEnd;
+    } else {
+      const auto first = _objects.cbegin() + node.firstObject;
+      objects.insert(objects.end(), first, first + node.objectCount);
+      ++i;
+    }
+  }
+}
+
+lib::PlaneSet LinearOctree::createViewPlanes(std::span<const Frustum> frustums) {
+  assert(frustums.size() <= MAX_VIEWS);
+  std::array<glm::vec4, lib::PlaneSet::MAX_PLANES> planes;
+  for (size_t view = 0; view < frustums.size(); ++view) {
+    const auto first = planes.begin() + view * VIEW_PLANE_COUNT;
+    std::copy(frustums[view].cbegin(), frustums[view].cend(), first);
+    std::fill(first + NUM_CUBE_FACES, first + VIEW_PLANE_COUNT, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+  }
+  return createPlaneSet(std::span(planes).first(frustums.size() * VIEW_PLANE_COUNT));
+}
+
+LinearOctree::ViewMasks LinearOctree::classifyViews(const lib::PlaneSet& viewPlanes,
+                                                    const Node& node, ViewMasks parentMasks) {
+  uint32_t visible = 0;
+  uint32_t inside = 0;
+  for (size_t firstPlane = 0; firstPlane < viewPlanes.size(); firstPlane += VIEW_PLANE_COUNT) {
+    const uint32_t view = 1u << (firstPlane / VIEW_PLANE_COUNT);
+    if (parentMasks.partial & view) {
+      uint64_t viewOutside;
+      uint64_t viewInside;
+      viewPlanes.classifyBox(&node.volume.lowerCorner.x, &node.volume.upperCorner.x, firstPlane,
+                             VIEW_PLANE_COUNT, viewOutside, viewInside);
+      visible |= viewOutside ? 0 : view;
+      inside |= viewInside == VIEW_PLANE_BITS << firstPlane ? view : 0;
+    }
+  }
+  return ViewMasks{.partial = visible & ~inside, .inside = parentMasks.inside | (visible & inside)};
+}
+
+void LinearOctree::queryViews(uint32_t nodeIndex, const lib::PlaneSet& viewPlanes,
+                              ViewMasks parentMasks, std::vector<VisibleObject>& objects) const {
+  if (_nodes.empty()) {
+    return;
+  }
+  const auto append = [&](uint32_t begin, uint32_t end, uint32_t viewMask) {
+    appendVisible(std::span(_objects).subspan(begin, end - begin), viewMask, objects);
+  };
+
+  // View masks of the current path, indexed by the depth below nodeIndex plus one.
+  std::array<ViewMasks, MAX_DEPTH + 2> pathMasks;
+  pathMasks[0] = parentMasks;
+  const uint32_t rootDepth = getDepth(_nodes[nodeIndex]);
+  const uint32_t end = _nodes[nodeIndex].subtreeEnd;
+  uint32_t i = nodeIndex;
+  while (i < end) {
+    const Node& node = _nodes[i];
+    const uint32_t level = getDepth(node) - rootDepth + 1;
+    const ViewMasks masks = classifyViews(viewPlanes, node, pathMasks[level - 1]);
+    if (masks.partial == 0) {
+      if (masks.inside) {
+        append(node.firstObject, node.subtreeObjectEnd, masks.inside);
+      }
+      i = node.subtreeEnd;
+    } else if (masks.inside == 0 && std::has_single_bit(masks.partial)) {
+      queryView(i, viewPlanes, std::countr_zero(masks.partial), objects);
+      i = node.subtreeEnd;
+    } else {
+      append(node.firstObject, node.firstObject + node.objectCount, masks.partial | masks.inside);
+      pathMasks[level] = masks;
+      ++i;
+    }
+  }
+}
+
+void LinearOctree::queryView(uint32_t nodeIndex, const lib::PlaneSet& viewPlanes, uint32_t view,
+                             std::vector<VisibleObject>& objects) const {
+  const uint32_t viewMask = 1u << view;
+  const size_t firstPlane = view * VIEW_PLANE_COUNT;
+  const uint64_t allPlanes = VIEW_PLANE_BITS << firstPlane;
+  const auto append = [&](uint32_t begin, uint32_t end) {
+    appendVisible(std::span(_objects).subspan(begin, end - begin), viewMask, objects);
+  };
+  const uint32_t end = _nodes[nodeIndex].subtreeEnd;
+  uint32_t i = nodeIndex;
+  while (i < end) {
+    const Node& node = _nodes[i];
+    uint64_t outside;
+    uint64_t inside;
+    viewPlanes.classifyBox(&node.volume.lowerCorner.x, &node.volume.upperCorner.x, firstPlane,
+                           VIEW_PLANE_COUNT, outside, inside);
+    if (outside) {
+      i = node.subtreeEnd;
+    } else if (inside == allPlanes) {
+      append(node.firstObject, node.subtreeObjectEnd);
+      i = node.subtreeEnd;
+    } else {
+      append(node.firstObject, node.firstObject + node.objectCount);
+      ++i;
+    }
+  }
+}
+
+const LinearOctree::Node* LinearOctree::findNode(uint64_t code) const {
+  const uint64_t sortKey = getSortKey(code);
+  auto it = std::lower_bound(_nodes.cbegin(), _nodes.cend(), sortKey,
+                             [](const Node& node, uint64_t key) {
+                               return getSortKey(node.code) < key;
+                             });
+  return it != _nodes.cend() && it->code == code ? &*it : nullptr;
+}
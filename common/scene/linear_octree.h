@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "common/object/object.h"
+#include "common/util/geometry.h"
+#include "lib/simd/plane_set.h"
+
+namespace lib {
+class ThreadPool;
+}  // namespace lib
+
+using Frustum = std::array<glm::vec4, NUM_CUBE_FACES>;
+
+// Object visible in at least one view of a multi-view query, bit i of viewMask stands for view i.
+struct VisibleObject {
+  const Object* object;
+  uint32_t viewMask;
+};
+
+// Pointerless octree. Objects are stored in the deepest cell fully containing their volume, like
+// in Octree, but nodes live in one array in depth-first Morton order and the objects of every
+// node are a range of one flat array. The subtree of a node is the contiguous node range
+// [node, subtreeEnd), so traversal skips culled subtrees by jumping instead of recursing.
+class LinearOctree {
+public:
+  static constexpr uint32_t MAX_DEPTH = 10;
+  // The faces of every view are padded to two groups of four planes, so a view is classified
+  // without the planes of the others.
+  static constexpr size_t VIEW_PLANE_COUNT = 8;
+  static constexpr size_t MAX_VIEWS = lib::PlaneSet::MAX_PLANES / VIEW_PLANE_COUNT;
+
+  struct Node {
+    // A leading 1 followed by the 3-bit child index of every level, the root is 1.
+    uint64_t code;
+    AABB volume;
+    uint32_t firstObject;
+    uint32_t objectCount;
+    uint32_t subtreeEnd;
+    uint32_t subtreeObjectEnd;
+  };
+
+  struct Entry {
+    const Object* object;
+    AABB volume;
+  };
+
+  // Views of a multi-view query intersecting a node without containing it, and views containing
+  // it. The views containing a node contain its whole subtree.
+  struct ViewMasks {
+    uint32_t partial;
+    uint32_t inside;
+  };
+
+private:
+  AABB _volume;
+  std::vector<Node> _nodes;
+  std::vector<const Object*> _objects;
+  std::vector<uint64_t> _keys;
+  std::vector<uint64_t> _scratch;
+
+  // Culls the subtree of the node at nodeIndex against a single view of viewPlanes, like
+  // querySubtree.
+  void queryView(uint32_t nodeIndex, const lib::PlaneSet& viewPlanes, uint32_t view,
+                 std::vector<VisibleObject>& objects) const;
+
+public:
+  explicit LinearOctree(const AABB& volume);
+
+  // Replaces the content with the entries. Their cells are computed and radix sorted on the
+  // thread pool if one is given. Entries outside the volume are skipped, returns the number of
+  // stored objects.
+  size_t build(std::span<const Entry> entries, lib::ThreadPool* threadPool = nullptr);
+
+  // Appends the objects of every node intersecting the frustum. Nodes fully inside of it are
+  // accepted with their whole subtree without testing the children.
+  void query(std::span<const glm::vec4> planes, std::vector<const Object*>& objects) const {
+    querySubtree(0, planes, objects);
+  }
+
+  // Like query, limited to the subtree of the node at nodeIndex.
+  void querySubtree(uint32_t nodeIndex, std::span<const glm::vec4> planes,
+                    std::vector<const Object*>& objects) const;
+
+  // Planes of the frustums laid out for classifyViews and queryViews.
+  static lib::PlaneSet createViewPlanes(std::span<const Frustum> frustums);
+
+  // Classifies a node against the views partially intersecting its parent only, the views
+  // containing the parent are inherited.
+  static ViewMasks classifyViews(const lib::PlaneSet& viewPlanes, const Node& node,
+                                 ViewMasks parentMasks);
+
+  // Culls the subtree of the node at nodeIndex against all views in one traversal, starting with
+  // the masks of its parent. Every node is classified against its still partial views only, so
+  // overlapping views share the traversal, and a subtree seen by one partial view only is culled
+  // like in querySubtree. Appends every object of a node visible in any view.
+  void queryViews(uint32_t nodeIndex, const lib::PlaneSet& viewPlanes, ViewMasks parentMasks,
+                  std::vector<VisibleObject>& objects) const;
+
+  // Returns nullptr if no object lies in or below the cell of the code.
+  const Node* findNode(uint64_t code) const;
+
+  static uint32_t getDepth(const Node& node) {
+    return (std::bit_width(node.code) - 1) / 3;
+  }
+
+  std::span<const Node> getNodes() const {
+    return _nodes;
+  }
+
+  std::span<const Object* const> getObjects(const Node& node) const {
+    return std::span<const Object* const>(_objects).subspan(node.firstObject, node.objectCount);
+  }
+
+  std::span<const Object* const> getObjects() const {
+    return _objects;
+  }
+
+  const AABB& getVolume() const {
+    return _volume;
+  }
+};
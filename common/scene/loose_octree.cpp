@@ -0,0 +1,160 @@
+#include "loose_octree.h"
+
+#include <algorithm>
+
+LooseOctree::LooseOctree(const AABB& volume) {
+  _nodes.push_back(Node{.center = 0.5f * (volume.lowerCorner + volume.upperCorner),
+                        .halfSize = 0.5f * (volume.upperCorner - volume.lowerCorner),
+                        .children = {INVALID_INDEX, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX,
+                                     INVALID_INDEX, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX},
+                        .parent = INVALID_INDEX,
+                        .depth = 0,
+                        .childCount = 0,
+                        .firstObject = INVALID_INDEX,
+                        .objectCount = 0});
+}
+
+uint32_t LooseOctree::allocateNode(uint32_t parent, uint32_t child) {
+  const glm::vec3 halfSize = 0.5f * _nodes[parent].halfSize;
+  const glm::vec3 offset((child & 1) ? halfSize.x : -halfSize.x,
+                         (child & 2) ? halfSize.y : -halfSize.y,
+                         (child & 4) ? halfSize.z : -halfSize.z);
+  const Node node = {.center = _nodes[parent].center + offset,
+                     .halfSize = halfSize,
+                     .children = {INVALID_INDEX, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX,
+                                  INVALID_INDEX, INVALID_INDEX, INVALID_INDEX, INVALID_INDEX},
+                     .parent = parent,
+                     .depth = _nodes[parent].depth + 1,
+                     .childCount = 0,
+                     .firstObject = INVALID_INDEX,
+                     .objectCount = 0};
+  uint32_t index;
+  if (_freeNodes.empty()) {
+    index = static_cast<uint32_t>(_nodes.size());
+    _nodes.push_back(node);
+  } else {
+    index = _freeNodes.back();
+    _freeNodes.pop_back();
+    _nodes[index] = node;
+  }
+  _nodes[parent].children[child] = index;
+  ++_nodes[parent].childCount;
+  return index;
+}
+
+// Descends while the child containing the center of the volume is at least as large as it.
+// Volumes centered outside of the root cell stay in the root, whose objects are always tested,
+// since no cell below it contains their center.
+uint32_t LooseOctree::findNode(const AABB& volume) {
+  const glm::vec3 center = 0.5f * (volume.lowerCorner + volume.upperCorner);
+  const glm::vec3 extent = volume.upperCorner - volume.lowerCorner;
+  uint32_t index = 0;
+  if (glm::any(glm::greaterThan(glm::abs(center - _nodes[0].center), _nodes[0].halfSize))) {
+    return index;
+  }
+  while (_nodes[index].depth < MAX_DEPTH) {
+    const Node& node = _nodes[index];
+    if (glm::any(glm::greaterThan(extent, node.halfSize))) {
+      break;
+    }
+    const uint32_t child = (center.x >= node.center.x ? 1 : 0)
+                           | (center.y >= node.center.y ? 2 : 0)
+                           | (center.z >= node.center.z ? 4 : 0);
+    index = node.children[child] != INVALID_INDEX ? node.children[child]
+                                                  : allocateNode(index, child);
+  }
+  return index;
+}
+
+void LooseOctree::link(Handle handle, uint32_t node) {
+  ObjectSlot& slot = _objects[handle];
+  slot.node = node;
+  slot.previous = INVALID_INDEX;
+  slot.next = _nodes[node].firstObject;
+  if (slot.next != INVALID_INDEX) {
+    _objects[slot.next].previous = handle;
+  }
+  _nodes[node].firstObject = handle;
+  ++_nodes[node].objectCount;
+}
+
+// Unlinks the object and returns nodes left empty to the pool, bottom up.
+void LooseOctree::unlink(Handle handle) {
+  const ObjectSlot& slot = _objects[handle];
+  if (slot.previous != INVALID_INDEX) {
+    _objects[slot.previous].next = slot.next;
+  } else {
+    _nodes[slot.node].firstObject = slot.next;
+  }
+  if (slot.next != INVALID_INDEX) {
+    _objects[slot.next].previous = slot.previous;
+  }
+  uint32_t index = slot.node;
+  --_nodes[index].objectCount;
+  while (index != 0 && _nodes[index].objectCount == 0 && _nodes[index].childCount == 0) {
+    Node& parent = _nodes[_nodes[index].parent];
+    *std::find(parent.children.begin(), parent.children.end(), index) = INVALID_INDEX;
+    --parent.childCount;
+    _freeNodes.push_back(index);
+    index = _nodes[index].parent;
+  }
+}
+
+LooseOctree::Handle LooseOctree::insert(const Object* object, const AABB& volume) {
+  Handle handle;
+  if (_freeObjects.empty()) {
+    handle = static_cast<Handle>(_objects.size());
+    _objects.emplace_back();
+  } else {
+    handle = _freeObjects.back();
+    _freeObjects.pop_back();
+  }
+  _objects[handle].object = object;
+  _objects[handle].volume = volume;
+  link(handle, findNode(volume));
+  ++_size;
+  return handle;
+}
+
+void LooseOctree::remove(Handle handle) {
+  unlink(handle);
+  _objects[handle].object = nullptr;
+  _freeObjects.push_back(handle);
+  --_size;
+}
+
+void LooseOctree::update(Handle handle, const AABB& volume) {
+  ObjectSlot& slot = _objects[handle];
+  slot.volume = volume;
+  if (slot.node != 0 && getLooseBounds(_nodes[slot.node]).contains(volume)) [[likely]] {
+    return;
+  }
+  unlink(handle);
+  link(handle, findNode(volume));
+}
+
+void LooseOctree::query(
+    std::span<const glm::vec4> planes, std::vector<const Object*>& objects) const {
+  // Every node pushes at most 8 children after popping itself.
+  std::array<uint32_t, 7 * MAX_DEPTH + 1> stack;
+  size_t stackSize = 0;
+  stack[stackSize++] = 0;
+  while (stackSize > 0) {
+    const uint32_t index = stack[--stackSize];
+    const Node& node = _nodes[index];
+    // The root also holds objects outside of its loose bounds.
+    if (index != 0 && !getLooseBounds(node).intersectsFrustum(planes)) {
+      continue;
+    }
+    for (uint32_t i = node.firstObject; i != INVALID_INDEX; i = _objects[i].next) {
+      if (_objects[i].volume.intersectsFrustum(planes)) {
+        objects.push_back(_objects[i].object);
+      }
+    }
+    for (uint32_t child : node.children) {
+      if (child != INVALID_INDEX) {
+        stack[stackSize++] = child;
+      }
+    }
+  }
+}
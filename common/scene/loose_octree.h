@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "common/object/object.h"
+#include "common/util/geometry.h"
+
+// Octree for moving objects. Every node's loose bounds are its cell grown by half a cell on each
+// side, so an object is stored in the deepest cell which contains its center and is at least as
+// large as the object. Objects straddling a split therefore still sink down instead of piling up
+// near the root. insert, remove and update are O(depth). update keeps an object in its node as
+// long as it stays within the loose bounds. Nodes and object slots are pooled and reused.
+class LooseOctree {
+public:
+  using Handle = uint32_t;
+
+  static constexpr uint32_t MAX_DEPTH = 10;
+  static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+private:
+  struct Node {
+    glm::vec3 center;
+    glm::vec3 halfSize;
+    std::array<uint32_t, 8> children;
+    uint32_t parent;
+    uint32_t depth;
+    uint32_t childCount;
+    uint32_t firstObject;
+    uint32_t objectCount;
+  };
+
+  // Objects of a node form an intrusive doubly-linked list.
+  struct ObjectSlot {
+    const Object* object;
+    AABB volume;
+    uint32_t node;
+    uint32_t previous;
+    uint32_t next;
+  };
+
+  std::vector<Node> _nodes;
+  std::vector<uint32_t> _freeNodes;
+  std::vector<ObjectSlot> _objects;
+  std::vector<uint32_t> _freeObjects;
+  size_t _size = 0;
+
+  uint32_t allocateNode(uint32_t parent, uint32_t child);
+
+  void link(Handle handle, uint32_t node);
+
+  void unlink(Handle handle);
+
+  uint32_t findNode(const AABB& volume);
+
+  AABB getLooseBounds(const Node& node) const {
+    return AABB{node.center - 2.0f * node.halfSize, node.center + 2.0f * node.halfSize};
+  }
+
+public:
+  // Objects centered outside of the volume are kept in the root.
+  explicit LooseOctree(const AABB& volume);
+
+  Handle insert(const Object* object, const AABB& volume);
+
+  void remove(Handle handle);
+
+  void update(Handle handle, const AABB& volume);
+
+  // Appends the objects whose volume intersects the frustum.
+  void query(std::span<const glm::vec4> planes, std::vector<const Object*>& objects) const;
+
+  const AABB& getVolume(Handle handle) const {
+    return _objects[handle].volume;
+  }
+
+  uint32_t getDepth(Handle handle) const {
+    return _nodes[_objects[handle].node].depth;
+  }
+
+  size_t getNodeCount() const {
+    return _nodes.size() - _freeNodes.size();
+  }
+
+  size_t size() const {
+    return _size;
+  }
+};
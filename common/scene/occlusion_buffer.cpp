@@ -0,0 +1,261 @@
+#include "occlusion_buffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+#include "lib/simd/simd.h"
+
+namespace {
+
+// Vertices closer to the camera plane are clipped away.
+constexpr float MIN_W = 1e-4f;
+constexpr uint32_t LANE_COUNT = 4;
+constexpr std::array<float, LANE_COUNT> LANE_OFFSETS = {0.5f, 1.5f, 2.5f, 3.5f};
+
+// Two triangles per face, corner i of a box takes the upper bound on axis a if bit a is set.
+constexpr std::array<uint32_t, 36> BOX_INDICES = {
+  0, 2, 6, 0, 6, 4, 1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4,
+  2, 3, 7, 2, 7, 6, 0, 1, 3, 0, 3, 2, 4, 5, 7, 4, 7, 6};
+
+std::array<glm::vec3, 8> getCorners(const AABB& volume) {
+  std::array<glm::vec3, 8> corners;
+  for (uint32_t i = 0; i < corners.size(); ++i) {
+    corners[i] = glm::vec3(i & 1 ? volume.upperCorner.x : volume.lowerCorner.x,
+                           i & 2 ? volume.upperCorner.y : volume.lowerCorner.y,
+                           i & 4 ? volume.upperCorner.z : volume.lowerCorner.z);
+  }
+  return corners;
+}
+
+// Line equation a * x + b * y + c of the edge from start to end, positive on its left side.
+struct Edge {
+  float a, b, c;
+
+  Edge(const glm::vec3& start, const glm::vec3& end)
+    : a(start.y - end.y), b(end.x - start.x), c(start.x * end.y - start.y * end.x) {}
+};
+
+uint32_t toPixel(float coordinate, uint32_t size) {
+  return static_cast<uint32_t>(std::clamp(coordinate, 0.0f, static_cast<float>(size)));
+}
+
+}  // namespace
+
+OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+  : _width(width), _height(height), _depth(width * height, CLEAR_DEPTH),
+    _tileMaxDepth((width / TILE_SIZE) * (height / TILE_SIZE), CLEAR_DEPTH) {
+  assert(width % TILE_SIZE == 0 && height % TILE_SIZE == 0);
+}
+
+void OcclusionBuffer::clear() {
+  std::fill(_depth.begin(), _depth.end(), CLEAR_DEPTH);
+  std::fill(_tileMaxDepth.begin(), _tileMaxDepth.end(), CLEAR_DEPTH);
+}
+
+glm::vec3 OcclusionBuffer::toScreen(const glm::vec4& clip) const {
+  const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+  return glm::vec3((ndc.x * 0.5f + 0.5f) * static_cast<float>(_width),
+                   (ndc.y * 0.5f + 0.5f) * static_cast<float>(_height), ndc.z);
+}
+
+void OcclusionBuffer::renderOccluder(std::span<const glm::vec3> positions,
+                                     std::span<const uint32_t> indices,
+                                     const glm::mat4& modelViewProjection) {
+  std::vector<glm::vec4> clip(positions.size());
+  std::transform(positions.begin(), positions.end(), clip.begin(), [&](const glm::vec3& position) {
+    return modelViewProjection * glm::vec4(position, 1.0f);
+  });
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    renderTriangle(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]);
+  }
+}
+
+void OcclusionBuffer::renderBox(const AABB& volume, const glm::mat4& viewProjection) {
+  const std::array<glm::vec3, 8> corners = getCorners(volume);
+  renderOccluder(corners, BOX_INDICES, viewProjection);
+}
+
+void OcclusionBuffer::renderTriangle(const glm::vec4& clip0, const glm::vec4& clip1,
+                                     const glm::vec4& clip2) {
+  const std::array<glm::vec4, 3> vertices = {clip0, clip1, clip2};
+  // Clipping a triangle against one plane leaves at most a quad.
+  std::array<glm::vec4, 4> polygon;
+  size_t size = 0;
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    const glm::vec4& current = vertices[i];
+    const glm::vec4& next = vertices[(i + 1) % vertices.size()];
+    if (current.w >= MIN_W) {
+      polygon[size++] = current;
+    }
+    if ((current.w >= MIN_W) != (next.w >= MIN_W)) {
+      polygon[size++] = glm::mix(current, next, (MIN_W - current.w) / (next.w - current.w));
+    }
+  }
+  for (size_t i = 2; i < size; ++i) {
+    rasterize(toScreen(polygon[0]), toScreen(polygon[i - 1]), toScreen(polygon[i]));
+  }
+}
+
+void OcclusionBuffer::rasterize(const glm::vec3& vertex0, const glm::vec3& vertex1,
+                                const glm::vec3& vertex2) {
+  float area = (vertex1.x - vertex0.x) * (vertex2.y - vertex0.y)
+               - (vertex1.y - vertex0.y) * (vertex2.x - vertex0.x);
+  if (!(std::abs(area) > 0.0f)) {
+    return;
+  }
+  // Both windings are rendered, the edges are oriented so inside pixels are positive.
+  const glm::vec3& first = area > 0.0f ? vertex1 : vertex2;
+  const glm::vec3& second = area > 0.0f ? vertex2 : vertex1;
+  const std::array<Edge, 3> edges = {
+    Edge(first, second), Edge(second, vertex0), Edge(vertex0, first)};
+  area = std::abs(area);
+
+  // Depth plane z = dzdx * x + dzdy * y + dz.
+  const float dzdx = ((first.z - vertex0.z) * (second.y - vertex0.y)
+                      - (second.z - vertex0.z) * (first.y - vertex0.y))
+                     / area;
+  const float dzdy = ((second.z - vertex0.z) * (first.x - vertex0.x)
+                      - (first.z - vertex0.z) * (second.x - vertex0.x))
+                     / area;
+  const float dz = vertex0.z - dzdx * vertex0.x - dzdy * vertex0.y;
+
+  // Rows start at a multiple of the lane count, the extra pixels fail the edge tests.
+  const glm::vec3 lower = glm::min(glm::min(vertex0, vertex1), vertex2);
+  const glm::vec3 upper = glm::max(glm::max(vertex0, vertex1), vertex2);
+  const uint32_t beginX = toPixel(std::floor(lower.x), _width) & ~(LANE_COUNT - 1);
+  const uint32_t endX = toPixel(std::ceil(upper.x), _width);
+  const uint32_t beginY = toPixel(std::floor(lower.y), _height);
+  const uint32_t endY = toPixel(std::ceil(upper.y), _height);
+
+  for (uint32_t y = beginY; y < endY; ++y) {
+    const float centerY = static_cast<float>(y) + 0.5f;
+    float* row = &_depth[y * _width];
+    for (uint32_t x = beginX; x < endX; x += LANE_COUNT) {
+#if defined(LIB_SIMD_SSE)
+      const __m128 centerX =
+          _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), _mm_loadu_ps(LANE_OFFSETS.data()));
+      const __m128 py = _mm_set1_ps(centerY);
+      const auto isInside = [&](const Edge& edge) {
+        const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge.a), centerX),
+                                                      _mm_mul_ps(_mm_set1_ps(edge.b), py)),
+                                           _mm_set1_ps(edge.c));
+        return _mm_cmpge_ps(distance, _mm_setzero_ps());
+      };
+      const __m128 inside =
+          _mm_and_ps(_mm_and_ps(isInside(edges[0]), isInside(edges[1])), isInside(edges[2]));
+      const __m128 depth = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), centerX), _mm_mul_ps(_mm_set1_ps(dzdy), py)),
+          _mm_set1_ps(dz));
+      const __m128 previous = _mm_loadu_ps(row + x);
+      const __m128 closest = _mm_min_ps(previous, depth);
+      _mm_storeu_ps(row + x,
+                    _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, previous)));
+#elif defined(LIB_SIMD_NEON)
+      const float32x4_t centerX =
+          vaddq_f32(vdupq_n_f32(static_cast<float>(x)), vld1q_f32(LANE_OFFSETS.data()));
+      const float32x4_t py = vdupq_n_f32(centerY);
+      uint32x4_t inside = vdupq_n_u32(~0u);
+      for (const Edge& edge : edges) {
+        const float32x4_t distance = vaddq_f32(vaddq_f32(vmulq_f32(vdupq_n_f32(edge.a), centerX),
+                                                         vmulq_f32(vdupq_n_f32(edge.b), py)),
+                                               vdupq_n_f32(edge.c));
+        inside = vandq_u32(inside, vcgeq_f32(distance, vdupq_n_f32(0.0f)));
+      }
+      const float32x4_t depth = vaddq_f32(
+          vaddq_f32(vmulq_f32(vdupq_n_f32(dzdx), centerX), vmulq_f32(vdupq_n_f32(dzdy), py)),
+          vdupq_n_f32(dz));
+      const float32x4_t previous = vld1q_f32(row + x);
+      vst1q_f32(row + x, vbslq_f32(inside, vminq_f32(previous, depth), previous));
+#else
+      for (uint32_t lane = 0; lane < LANE_COUNT; ++lane) {
+        const float centerX = static_cast<float>(x) + LANE_OFFSETS[lane];
+        const bool inside = std::all_of(edges.cbegin(), edges.cend(), [&](const Edge& edge) {
+          return edge.a * centerX + edge.b * centerY + edge.c >= 0.0f;
+        });
+        if (inside) {
+          row[x + lane] = std::min(row[x + lane], dzdx * centerX + dzdy * centerY + dz);
+        }
+      }
+#endif
+    }
+  }
+}
+
+void OcclusionBuffer::updateHierarchy() {
+  const uint32_t tileCountX = _width / TILE_SIZE;
+  for (uint32_t tileY = 0; tileY < _height / TILE_SIZE; ++tileY) {
+    for (uint32_t tileX = 0; tileX < tileCountX; ++tileX) {
+      float maxDepth = -std::numeric_limits<float>::infinity();
+      for (uint32_t y = tileY * TILE_SIZE; y < (tileY + 1) * TILE_SIZE; ++y) {
+        const float* row = &_depth[y * _width + tileX * TILE_SIZE];
+        maxDepth = std::max(maxDepth, *std::max_element(row, row + TILE_SIZE));
+      }
+      _tileMaxDepth[tileY * tileCountX + tileX] = maxDepth;
+    }
+  }
+}
+
+bool OcclusionBuffer::isVisible(const AABB& volume, const glm::mat4& viewProjection) const {
+  glm::vec3 lower(std::numeric_limits<float>::max());
+  glm::vec3 upper(std::numeric_limits<float>::lowest());
+  uint32_t behindCount = 0;
+  for (const glm::vec3& corner : getCorners(volume)) {
+    const glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+    if (clip.w < MIN_W) {
+      ++behindCount;
+      continue;
+    }
+    const glm::vec3 screen = toScreen(clip);
+    lower = glm::min(lower, screen);
+    upper = glm::max(upper, screen);
+  }
+  if (behindCount > 0) {
+    return behindCount < 8;
+  }
+
+  // Every pixel the rectangle touches is tested, not only the ones with a covered center.
+  const uint32_t beginX = toPixel(std::floor(lower.x), _width);
+  const uint32_t endX = toPixel(std::ceil(upper.x), _width);
+  const uint32_t beginY = toPixel(std::floor(lower.y), _height);
+  const uint32_t endY = toPixel(std::ceil(upper.y), _height);
+  const uint32_t tileCountX = _width / TILE_SIZE;
+  for (uint32_t tileY = beginY / TILE_SIZE; tileY * TILE_SIZE < endY; ++tileY) {
+    for (uint32_t tileX = beginX / TILE_SIZE; tileX * TILE_SIZE < endX; ++tileX) {
+      if (lower.z > _tileMaxDepth[tileY * tileCountX + tileX]) {
+        continue;
+      }
+      // Only part of the tile may be farther than the box, check the pixels it overlaps.
+      const uint32_t tileEndX = std::min(endX, (tileX + 1) * TILE_SIZE);
+      const uint32_t tileEndY = std::min(endY, (tileY + 1) * TILE_SIZE);
+      for (uint32_t y = std::max(beginY, tileY * TILE_SIZE); y < tileEndY; ++y) {
+        for (uint32_t x = std::max(beginX, tileX * TILE_SIZE); x < tileEndX; ++x) {
+          if (lower.z <= _depth[y * _width + x]) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+void selectOccluders(std::span<const AABB> volumes, const glm::vec3& viewPosition, size_t count,
+                     std::vector<uint32_t>& occluders) {
+  std::vector<float> sizes(volumes.size());
+  std::transform(volumes.begin(), volumes.end(), sizes.begin(), [&](const AABB& volume) {
+    const glm::vec3 diagonal = volume.upperCorner - volume.lowerCorner;
+    const glm::vec3 offset = 0.5f * (volume.lowerCorner + volume.upperCorner) - viewPosition;
+    return glm::dot(diagonal, diagonal) / std::max(glm::dot(offset, offset), 1e-6f);
+  });
+  std::vector<uint32_t> indices(volumes.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  count = std::min(count, indices.size());
+  std::partial_sort(indices.begin(), indices.begin() + count, indices.end(),
+                    [&](uint32_t lhs, uint32_t rhs) {
+                      return sizes[lhs] > sizes[rhs];
+                    });
+  occluders.insert(occluders.end(), indices.cbegin(), indices.cbegin() + count);
+}
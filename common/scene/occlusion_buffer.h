@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "common/util/geometry.h"
+
+// Low resolution depth buffer for software occlusion culling. The largest occluders are
+// rasterized on the CPU, then updateHierarchy() stores the farthest depth of every tile, and
+// isVisible() tests the screen rectangle of a box against it before its draw is recorded.
+//
+// Depth is the clip space z / w of the view projection, smaller values are closer. Pixels are
+// covered when their center is inside of a triangle and keep the closest depth written to them.
+// The row y = 0 corresponds to clip space y = -1. Rows are rasterized several pixels at once.
+class OcclusionBuffer {
+  uint32_t _width;
+  uint32_t _height;
+  std::vector<float> _depth;
+  std::vector<float> _tileMaxDepth;
+
+  void renderTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2);
+
+  void rasterize(const glm::vec3& vertex0, const glm::vec3& vertex1, const glm::vec3& vertex2);
+
+  glm::vec3 toScreen(const glm::vec4& clip) const;
+
+public:
+  // Width and height have to be multiples of TILE_SIZE.
+  static constexpr uint32_t TILE_SIZE = 8;
+  static constexpr float CLEAR_DEPTH = std::numeric_limits<float>::infinity();
+
+  OcclusionBuffer(uint32_t width, uint32_t height);
+
+  void clear();
+
+  // Renders the triangles of an occluder mesh. Triangles crossing the camera plane are clipped.
+  void renderOccluder(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                      const glm::mat4& modelViewProjection);
+
+  // Renders the faces of the box. Only meshes filling their AABB, like walls or buildings,
+  // should be rendered that way, anything else would hide objects which are visible.
+  void renderBox(const AABB& volume, const glm::mat4& viewProjection);
+
+  // Has to be called after rendering the occluders and before testing boxes.
+  void updateHierarchy();
+
+  // Conservative, returns true unless every pixel of the screen rectangle of the box is covered
+  // by occluders closer than the closest corner of the box. Boxes crossing the camera plane are
+  // always visible, boxes behind the camera or off screen never are.
+  bool isVisible(const AABB& volume, const glm::mat4& viewProjection) const;
+
+  float getDepth(uint32_t x, uint32_t y) const {
+    return _depth[y * _width + x];
+  }
+
+  uint32_t getWidth() const {
+    return _width;
+  }
+
+  uint32_t getHeight() const {
+    return _height;
+  }
+};
+
+// Appends the indices of the count volumes covering the largest part of the view seen from
+// viewPosition, which are the best candidates to render into an OcclusionBuffer. The size on
+// screen is estimated from the squared diagonal of a volume over its squared distance.
+void selectOccluders(std::span<const AABB> volumes, const glm::vec3& viewPosition, size_t count,
+                     std::vector<uint32_t>& occluders);
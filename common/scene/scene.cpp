@@ -0,0 +1,159 @@
+#include "scene.h"
+
+#include <algorithm>
+#include <array>
+
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+// Few subtrees per range keep the workers balanced when the frustum covers a corner only.
+constexpr size_t SUBTREE_GRAIN_SIZE = 4;
+constexpr size_t MAX_RANGE_COUNT =
+    ((size_t(1) << (3 * Scene::TASK_DEPTH)) + SUBTREE_GRAIN_SIZE - 1) / SUBTREE_GRAIN_SIZE;
+
+template <typename Type>
+void appendBuffers(std::span<const std::vector<Type>> buffers, std::vector<Type>& result) {
+  size_t size = result.size();
+  for (const std::vector<Type>& buffer : buffers) {
+    size += buffer.size();
+  }
+  result.reserve(size);
+  for (const std::vector<Type>& buffer : buffers) {
+    result.insert(result.end(), buffer.cbegin(), buffer.cend());
+  }
+}
+
+void appendVisible(std::span<const Object* const> objects, uint32_t viewMask,
+                   std::vector<VisibleObject>& visible) {
+  const size_t offset = visible.size();
+  visible.resize(offset + objects.size());
+  std::transform(objects.begin(), objects.end(), visible.begin() + offset,
+                 [viewMask](const Object* object) {
+                   return VisibleObject{object, viewMask};
+                 });
+}
+
+}  // namespace
+
+Scene::Scene(const AABB& volume)
+  : _octree(volume), _visibleBuffers(MAX_RANGE_COUNT), _visibleViewBuffers(MAX_RANGE_COUNT) {}
+
+size_t Scene::build(std::span<const LinearOctree::Entry> entries) {
+  return _octree.build(entries, _threadPool);
+}
+
+template <typename Visit, typename CullRange>
+size_t Scene::cullParallel(Visit&& visit, CullRange&& cullRange) {
+  const std::span<const LinearOctree::Node> nodes = _octree.getNodes();
+  _subtrees.clear();
+  uint32_t i = 0;
+  while (i < nodes.size()) {
+    if (LinearOctree::getDepth(nodes[i]) == TASK_DEPTH) {
+      _subtrees.push_back(i);
+      i = nodes[i].subtreeEnd;
+    } else {
+      i = visit(i);
+    }
+  }
+  _threadPool->parallelFor(_subtrees.size(), SUBTREE_GRAIN_SIZE, [&](size_t begin, size_t end) {
+    cullRange(std::span<const uint32_t>(_subtrees).subspan(begin, end - begin),
+              begin / SUBTREE_GRAIN_SIZE);
+  });
+  return (_subtrees.size() + SUBTREE_GRAIN_SIZE - 1) / SUBTREE_GRAIN_SIZE;
+}
+
+void Scene::cull(std::span<const glm::vec4> planes, std::vector<const Object*>& visible) {
+  if (!_threadPool) {
+    _octree.query(planes, visible);
+    return;
+  }
+
+  const std::span<const LinearOctree::Node> nodes = _octree.getNodes();
+  const std::span<const Object* const> objects = _octree.getObjects();
+  const size_t rangeCount = cullParallel(
+      [&](uint32_t i) -> uint32_t {
+        const LinearOctree::Node& node = nodes[i];
+        const FrustumContainment containment = node.volume.classifyFrustum(planes);
+        if (containment == FrustumContainment::OUTSIDE) {
+          return node.subtreeEnd;
+        }
+        if (containment == FrustumContainment::INSIDE) {
+          visible.insert(visible.end(), objects.begin() + node.firstObject,
+                         objects.begin() + node.subtreeObjectEnd);
+          return node.subtreeEnd;
+        }
+        const auto first = objects.begin() + node.firstObject;
+        visible.insert(visible.end(), first, first + node.objectCount);
+        return i + 1;
+      },
+      [&](std::span<const uint32_t> subtrees, size_t range) {
+        std::vector<const Object*>& buffer = _visibleBuffers[range];
+        buffer.clear();
+        for (uint32_t subtree : subtrees) {
+          _octree.querySubtree(subtree, planes, buffer);
+        }
+      });
+  appendBuffers<const Object*>(std::span(_visibleBuffers).first(rangeCount), visible);
+}
+
+void Scene::cullViews(std::span<const Frustum> frustums, std::vector<VisibleObject>& visible) {
+  if (frustums.size() == 1) {
+    _singleViewVisible.clear();
+    cull(frustums.front(), _singleViewVisible);
+    appendVisible(_singleViewVisible, 1, visible);
+    return;
+  }
+  if (frustums.empty()) {
+    return;
+  }
+  const lib::PlaneSet viewPlanes = LinearOctree::createViewPlanes(frustums);
+  const LinearOctree::ViewMasks allViews = {
+    .partial = static_cast<uint32_t>((uint64_t(1) << frustums.size()) - 1), .inside = 0};
+  if (!_threadPool) {
+    _octree.queryViews(0, viewPlanes, allViews, visible);
+    return;
+  }
+
+  // The masks of a node above the subtrees are indexed by its depth plus one. A node right above
+  // them records its masks for each of its subtrees, in the order of _subtrees.
+  const std::span<const LinearOctree::Node> nodes = _octree.getNodes();
+  const std::span<const Object* const> objects = _octree.getObjects();
+  std::array<LinearOctree::ViewMasks, TASK_DEPTH + 1> pathMasks;
+  pathMasks[0] = allViews;
+  _subtreeViewMasks.clear();
+  const size_t rangeCount = cullParallel(
+      [&](uint32_t i) -> uint32_t {
+        const LinearOctree::Node& node = nodes[i];
+        const uint32_t depth = LinearOctree::getDepth(node);
+        const LinearOctree::ViewMasks masks =
+            LinearOctree::classifyViews(viewPlanes, node, pathMasks[depth]);
+        if (masks.partial == 0) {
+          if (masks.inside) {
+            appendVisible(objects.subspan(node.firstObject,
+                                          node.subtreeObjectEnd - node.firstObject),
+                          masks.inside, visible);
+          }
+          return node.subtreeEnd;
+        }
+        appendVisible(objects.subspan(node.firstObject, node.objectCount),
+                      masks.partial | masks.inside, visible);
+        pathMasks[depth + 1] = masks;
+        if (depth + 1 == TASK_DEPTH) {
+          for (uint32_t child = i + 1; child < node.subtreeEnd; child = nodes[child].subtreeEnd) {
+            _subtreeViewMasks.push_back(masks);
+          }
+        }
+        return i + 1;
+      },
+      [&](std::span<const uint32_t> subtrees, size_t range) {
+        std::vector<VisibleObject>& buffer = _visibleViewBuffers[range];
+        buffer.clear();
+        const size_t first = subtrees.data() - _subtrees.data();
+        for (size_t subtree = 0; subtree < subtrees.size(); ++subtree) {
+          _octree.queryViews(subtrees[subtree], viewPlanes, _subtreeViewMasks[first + subtree],
+                             buffer);
+        }
+      });
+  appendBuffers<VisibleObject>(std::span(_visibleViewBuffers).first(rangeCount), visible);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "common/object/object.h"
+#include "common/util/geometry.h"
+#include "linear_octree.h"
+
+namespace lib {
+class ThreadPool;
+}  // namespace lib
+
+// Static objects of a level, culled through a LinearOctree.
+class Scene {
+  LinearOctree _octree;
+  lib::ThreadPool* _threadPool = nullptr;
+  std::vector<uint32_t> _subtrees;
+  std::vector<std::vector<const Object*>> _visibleBuffers;
+  std::vector<std::vector<VisibleObject>> _visibleViewBuffers;
+  std::vector<LinearOctree::ViewMasks> _subtreeViewMasks;
+  std::vector<const Object*> _singleViewVisible;
+
+  // Visits the nodes above TASK_DEPTH on the calling thread, visit(nodeIndex) returns the next
+  // node to visit. The subtrees below are split into ranges passed to cullRange(subtrees, range)
+  // on the thread pool. Returns the number of ranges.
+  template <typename Visit, typename CullRange>
+  size_t cullParallel(Visit&& visit, CullRange&& cullRange);
+
+public:
+  // Subtrees rooted at this depth are culled as independent tasks.
+  static constexpr uint32_t TASK_DEPTH = 2;
+
+  explicit Scene(const AABB& volume);
+
+  // Replaces the objects of the scene, returns the number of objects inside of its volume.
+  size_t build(std::span<const LinearOctree::Entry> entries);
+
+  // Appends the objects of every octree node intersecting the frustum to visible. With a thread
+  // pool, the nodes above TASK_DEPTH are culled on the calling thread and the subtrees below are
+  // handed to the workers, each range of subtrees filling its own buffer. The buffers are
+  // appended in subtree order, so the result does not depend on the thread count.
+  void cull(std::span<const glm::vec4> planes, std::vector<const Object*>& visible);
+
+  // Culls for up to LinearOctree::MAX_VIEWS views (e.g. both XR eyes and the shadow cascades) in
+  // a single traversal. Every object visible in any view is appended once together with the mask
+  // of the views it is visible in. A node is only classified against the views partially
+  // intersecting its parent, so overlapping views share most of the work. The subtree tasks start
+  // with the masks of their parents. A single view is culled with cull().
+  void cullViews(std::span<const Frustum> frustums, std::vector<VisibleObject>& visible);
+
+  void setThreadPool(lib::ThreadPool* threadPool) {
+    _threadPool = threadPool;
+  }
+
+  const LinearOctree& getOctree() const {
+    return _octree;
+  }
+};
@@ -0,0 +1,287 @@
+#include "spatial_hash_grid.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "common/scene/cell_key.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+constexpr float MAX_COORDINATE = 1e9f;
+constexpr size_t MIN_CELL_CAPACITY = 64;
+constexpr size_t QUERY_GRAIN_SIZE = 256;
+
+// Whether the coordinates of the key lie within extent cells from lower on. They are compared
+// modulo 2^21 like the keys, so far cells sharing a key with a cell in range are visited as well.
+// Objects are always tested against the query, so that only costs time.
+bool isInWrappedRange(uint64_t key, const glm::ivec3& lower, const glm::i64vec3& extent) {
+  for (int axis = 0; axis < 3; ++axis) {
+    const uint32_t shift = (2 - axis) * CELL_COORDINATE_BITS;
+    const uint64_t offset =
+        ((key >> shift) - static_cast<uint64_t>(lower[axis])) & CELL_COORDINATE_MASK;
+    if (extent[axis] <= static_cast<int64_t>(CELL_COORDINATE_MASK)
+        && offset > static_cast<uint64_t>(extent[axis])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool intersects(const AABB& lhs, const AABB& rhs) {
+  return glm::all(glm::lessThanEqual(lhs.lowerCorner, rhs.upperCorner))
+         && glm::all(glm::greaterThanEqual(lhs.upperCorner, rhs.lowerCorner));
+}
+
+bool intersectsSphere(const AABB& volume, const glm::vec3& center, float radius) {
+  const glm::vec3 offset = glm::clamp(center, volume.lowerCorner, volume.upperCorner) - center;
+  return glm::dot(offset, offset) <= radius * radius;
+}
+
+// Runs query(i, objects) for every query, appending the objects found to objects.
+template <typename Query>
+void queryBatch(size_t count, GridQueryResults& results, lib::ThreadPool* threadPool,
+                Query&& query) {
+  results.offsets.assign(count + 1, 0);
+  results.objects.clear();
+  if (!threadPool) {
+    for (size_t i = 0; i < count; ++i) {
+      query(i, results.objects);
+      results.offsets[i + 1] = static_cast<uint32_t>(results.objects.size());
+    }
+    return;
+  }
+
+  // Every range of queries fills its own buffer, they are concatenated in order afterwards.
+  const size_t rangeCount = (count + QUERY_GRAIN_SIZE - 1) / QUERY_GRAIN_SIZE;
+  if (results.rangeObjects.size() < rangeCount) {
+    results.rangeObjects.resize(rangeCount);
+  }
+  threadPool->parallelFor(count, QUERY_GRAIN_SIZE, [&](size_t begin, size_t end) {
+    std::vector<const Object*>& objects = results.rangeObjects[begin / QUERY_GRAIN_SIZE];
+    objects.clear();
+    for (size_t i = begin; i < end; ++i) {
+      const size_t offset = objects.size();
+      query(i, objects);
+      results.offsets[i + 1] = static_cast<uint32_t>(objects.size() - offset);
+    }
+  });
+  std::partial_sum(results.offsets.cbegin(), results.offsets.cend(), results.offsets.begin());
+  results.objects.reserve(results.offsets.back());
+  for (size_t range = 0; range < rangeCount; ++range) {
+    results.objects.insert(results.objects.end(), results.rangeObjects[range].cbegin(),
+                           results.rangeObjects[range].cend());
+  }
+}
+
+}  // namespace
+
+SpatialHashGrid::SpatialHashGrid(float cellSize)
+  : _cellSize(cellSize), _inverseCellSize(1.0f / cellSize),
+    _cells(MIN_CELL_CAPACITY, Cell{EMPTY_KEY, INVALID_INDEX, 0}) {}
+
+glm::ivec3 SpatialHashGrid::getCellCoordinates(const glm::vec3& position) const {
+  return glm::ivec3(
+      glm::floor(glm::clamp(position * _inverseCellSize, -MAX_COORDINATE, MAX_COORDINATE)));
+}
+
+uint64_t SpatialHashGrid::getKey(const AABB& volume) const {
+  return packCellKey(getCellCoordinates(0.5f * (volume.lowerCorner + volume.upperCorner)));
+}
+
+size_t SpatialHashGrid::getHome(uint64_t key) const {
+  return ((key * 0x9E3779B97F4A7C15ull) >> 32) & (_cells.size() - 1);
+}
+
+uint32_t SpatialHashGrid::findCell(uint64_t key) const {
+  const size_t mask = _cells.size() - 1;
+  for (size_t i = getHome(key); _cells[i].key != EMPTY_KEY; i = (i + 1) & mask) {
+    if (_cells[i].key == key) {
+      return static_cast<uint32_t>(i);
+    }
+  }
+  return INVALID_INDEX;
+}
+
+uint32_t SpatialHashGrid::findOrCreateCell(uint64_t key) {
+  if (2 * (_cellCount + 1) > _cells.size()) {
+    grow();
+  }
+  const size_t mask = _cells.size() - 1;
+  size_t i = getHome(key);
+  while (_cells[i].key != EMPTY_KEY) {
+    if (_cells[i].key == key) {
+      return static_cast<uint32_t>(i);
+    }
+    i = (i + 1) & mask;
+  }
+  _cells[i] = Cell{key, INVALID_INDEX, 0};
+  ++_cellCount;
+  return static_cast<uint32_t>(i);
+}
+
+// Backward shift deletion: entries after the hole move into it unless the hole lies before
+// their home slot, so probing never has to skip tombstones.
+void SpatialHashGrid::eraseCell(uint32_t cell) {
+  const size_t mask = _cells.size() - 1;
+  size_t hole = cell;
+  for (size_t i = (hole + 1) & mask; _cells[i].key != EMPTY_KEY; i = (i + 1) & mask) {
+    const size_t home = getHome(_cells[i].key);
+    const bool isHomeReachable = hole <= i ? hole < home && home <= i : hole < home || home <= i;
+    if (!isHomeReachable) {
+      _cells[hole] = _cells[i];
+      hole = i;
+    }
+  }
+  _cells[hole].key = EMPTY_KEY;
+  --_cellCount;
+}
+
+void SpatialHashGrid::grow() {
+  std::vector<Cell> cells(2 * _cells.size(), Cell{EMPTY_KEY, INVALID_INDEX, 0});
+  std::swap(cells, _cells);
+  const size_t mask = _cells.size() - 1;
+  for (const Cell& cell : cells) {
+    if (cell.key == EMPTY_KEY) {
+      continue;
+    }
+    size_t i = getHome(cell.key);
+    while (_cells[i].key != EMPTY_KEY) {
+      i = (i + 1) & mask;
+    }
+    _cells[i] = cell;
+  }
+}
+
+void SpatialHashGrid::link(Handle handle, uint64_t key) {
+  Cell& cell = _cells[findOrCreateCell(key)];
+  ObjectSlot& slot = _objects[handle];
+  slot.cell = key;
+  slot.previous = INVALID_INDEX;
+  slot.next = cell.firstObject;
+  if (slot.next != INVALID_INDEX) {
+    _objects[slot.next].previous = handle;
+  }
+  cell.firstObject = handle;
+  ++cell.objectCount;
+}
+
+void SpatialHashGrid::unlink(Handle handle) {
+  const ObjectSlot& slot = _objects[handle];
+  const uint32_t cellIndex = findCell(slot.cell);
+  Cell& cell = _cells[cellIndex];
+  if (slot.previous != INVALID_INDEX) {
+    _objects[slot.previous].next = slot.next;
+  } else {
+    cell.firstObject = slot.next;
+  }
+  if (slot.next != INVALID_INDEX) {
+    _objects[slot.next].previous = slot.previous;
+  }
+  if (--cell.objectCount == 0) {
+    eraseCell(cellIndex);
+  }
+}
+
+SpatialHashGrid::Handle SpatialHashGrid::insert(const Object* object, const AABB& volume) {
+  Handle handle;
+  if (_freeObjects.empty()) {
+    handle = static_cast<Handle>(_objects.size());
+    _objects.emplace_back();
+  } else {
+    handle = _freeObjects.back();
+    _freeObjects.pop_back();
+  }
+  _objects[handle].object = object;
+  _objects[handle].volume = volume;
+  _maxHalfExtent = glm::max(_maxHalfExtent, 0.5f * (volume.upperCorner - volume.lowerCorner));
+  link(handle, getKey(volume));
+  ++_size;
+  return handle;
+}
+
+void SpatialHashGrid::remove(Handle handle) {
+  unlink(handle);
+  _objects[handle].object = nullptr;
+  _freeObjects.push_back(handle);
+  --_size;
+}
+
+void SpatialHashGrid::update(Handle handle, const AABB& volume) {
+  ObjectSlot& slot = _objects[handle];
+  slot.volume = volume;
+  _maxHalfExtent = glm::max(_maxHalfExtent, 0.5f * (volume.upperCorner - volume.lowerCorner));
+  const uint64_t key = getKey(volume);
+  if (key == slot.cell) [[likely]] {
+    return;
+  }
+  unlink(handle);
+  link(handle, key);
+}
+
+template <typename Visit>
+void SpatialHashGrid::visitCells(const AABB& volume, Visit&& visit) const {
+  const glm::ivec3 lower = getCellCoordinates(volume.lowerCorner - _maxHalfExtent);
+  const glm::ivec3 upper = getCellCoordinates(volume.upperCorner + _maxHalfExtent);
+  const auto visitObjects = [&](const Cell& cell) {
+    for (uint32_t i = cell.firstObject; i != INVALID_INDEX; i = _objects[i].next) {
+      visit(_objects[i]);
+    }
+  };
+
+  // Large ranges are cheaper to answer from the occupied cells.
+  const glm::i64vec3 size = glm::i64vec3(upper) - glm::i64vec3(lower) + int64_t(1);
+  if (size.x * size.y * size.z > static_cast<int64_t>(_cellCount)) {
+    for (const Cell& cell : _cells) {
+      if (cell.key != EMPTY_KEY) {
+        if (isInWrappedRange(cell.key, lower, size - int64_t(1))) {
+          visitObjects(cell);
+        }
+      }
+    }
+    return;
+  }
+  for (int32_t x = lower.x; x <= upper.x; ++x) {
+    for (int32_t y = lower.y; y <= upper.y; ++y) {
+      for (int32_t z = lower.z; z <= upper.z; ++z) {
+        const uint32_t cell = findCell(packCellKey(glm::ivec3(x, y, z)));
+        if (cell != INVALID_INDEX) {
+          visitObjects(_cells[cell]);
+        }
+      }
+    }
+  }
+}
+
+void SpatialHashGrid::query(const AABB& volume, std::vector<const Object*>& objects) const {
+  visitCells(volume, [&](const ObjectSlot& slot) {
+    if (intersects(slot.volume, volume)) {
+      objects.push_back(slot.object);
+    }
+  });
+}
+
+void SpatialHashGrid::queryRadius(
+    const glm::vec3& center, float radius, std::vector<const Object*>& objects) const {
+  visitCells(AABB{center - radius, center + radius}, [&](const ObjectSlot& slot) {
+    if (intersectsSphere(slot.volume, center, radius)) {
+      objects.push_back(slot.object);
+    }
+  });
+}
+
+void SpatialHashGrid::query(std::span<const AABB> volumes, GridQueryResults& results,
+                            lib::ThreadPool* threadPool) const {
+  queryBatch(volumes.size(), results, threadPool,
+             [&](size_t i, std::vector<const Object*>& objects) {
+               query(volumes[i], objects);
+             });
+}
+
+void SpatialHashGrid::queryRadius(std::span<const glm::vec4> spheres, GridQueryResults& results,
+                                  lib::ThreadPool* threadPool) const {
+  queryBatch(spheres.size(), results, threadPool,
+             [&](size_t i, std::vector<const Object*>& objects) {
+               queryRadius(glm::vec3(spheres[i]), spheres[i].w, objects);
+             });
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "common/object/object.h"
+#include "common/util/geometry.h"
+
+namespace lib {
+class ThreadPool;
+}  // namespace lib
+
+// Results of a batch of queries, the objects found by query i are objects[offsets[i]] up to
+// objects[offsets[i + 1]]. Reusing it between batches keeps its memory.
+struct GridQueryResults {
+  std::vector<uint32_t> offsets;
+  std::vector<const Object*> objects;
+  std::vector<std::vector<const Object*>> rangeObjects;
+};
+
+// Uniform grid for proximity queries between objects of similar size, e.g. triggers and
+// neighbour searches. Every object is stored in the cell containing the center of its volume.
+// Occupied cells are kept in an open addressing hash table with linear probing, so the grid is
+// unbounded and its memory only grows with the number of occupied cells.
+//
+// update() only relinks an object when its center moved to another cell. Queries extend their
+// range by half of the largest object inserted so far, the cell size should therefore be at
+// least as large as most objects.
+class SpatialHashGrid {
+public:
+  using Handle = uint32_t;
+
+  static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+private:
+  static constexpr uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+
+  struct Cell {
+    uint64_t key;
+    uint32_t firstObject;
+    uint32_t objectCount;
+  };
+
+  // Objects of a cell form an intrusive doubly-linked list.
+  struct ObjectSlot {
+    const Object* object;
+    AABB volume;
+    uint64_t cell;
+    uint32_t previous;
+    uint32_t next;
+  };
+
+  float _cellSize;
+  float _inverseCellSize;
+  glm::vec3 _maxHalfExtent = glm::vec3(0.0f);
+  // Power of two sized, at most half full.
+  std::vector<Cell> _cells;
+  size_t _cellCount = 0;
+  std::vector<ObjectSlot> _objects;
+  std::vector<uint32_t> _freeObjects;
+  size_t _size = 0;
+
+  glm::ivec3 getCellCoordinates(const glm::vec3& position) const;
+
+  uint64_t getKey(const AABB& volume) const;
+
+  size_t getHome(uint64_t key) const;
+
+  uint32_t findCell(uint64_t key) const;
+
+  uint32_t findOrCreateCell(uint64_t key);
+
+  void eraseCell(uint32_t cell);
+
+  void grow();
+
+  void link(Handle handle, uint64_t key);
+
+  void unlink(Handle handle);
+
+  // Calls visit(slot) for the objects of the cells overlapping the extended volume.
+  template <typename Visit>
+  void visitCells(const AABB& volume, Visit&& visit) const;
+
+public:
+  explicit SpatialHashGrid(float cellSize);
+
+  Handle insert(const Object* object, const AABB& volume);
+
+  void remove(Handle handle);
+
+  void update(Handle handle, const AABB& volume);
+
+  // Appends the objects whose volume intersects the volume.
+  void query(const AABB& volume, std::vector<const Object*>& objects) const;
+
+  // Appends the objects whose volume intersects the sphere.
+  void queryRadius(
+      const glm::vec3& center, float radius, std::vector<const Object*>& objects) const;
+
+  // Runs one query per volume. With a thread pool, ranges of queries run in parallel and the
+  // results do not depend on the thread count.
+  void query(std::span<const AABB> volumes, GridQueryResults& results,
+             lib::ThreadPool* threadPool = nullptr) const;
+
+  // Runs one query per sphere, given as center and radius in w.
+  void queryRadius(std::span<const glm::vec4> spheres, GridQueryResults& results,
+                   lib::ThreadPool* threadPool = nullptr) const;
+
+  const AABB& getVolume(Handle handle) const {
+    return _objects[handle].volume;
+  }
+
+  float getCellSize() const {
+    return _cellSize;
+  }
+
+  size_t getCellCount() const {
+    return _cellCount;
+  }
+
+  size_t size() const {
+    return _size;
+  }
+};
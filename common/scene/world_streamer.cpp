@@ -0,0 +1,191 @@
+#include "world_streamer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/scene/cell_key.h"
+
+namespace {
+
+bool isInRange(const glm::ivec3& coordinates) {
+  return glm::all(glm::lessThanEqual(glm::abs(coordinates), glm::ivec3(MAX_CELL_COORDINATE)));
+}
+
+}  // namespace
+
+WorldStreamer::WorldStreamer(float cellSize, const StreamingSettings& settings)
+  : _cellSize(cellSize), _settings(settings) {}
+
+Status WorldStreamer::addCell(const glm::ivec3& coordinates, std::span<const CellAsset> assets) {
+  if (!isInRange(coordinates)) {
+    return Error(EngineError::INDEX_OUT_OF_RANGE);
+  }
+  const uint64_t key = packCellKey(coordinates);
+  if (_cellIndices.contains(key)) {
+    return Error(EngineError::ALREADY_INITIALIZED);
+  }
+  for (const CellAsset& asset : assets) {
+    const auto it = _assetIndices.find(asset.path);
+    if (it != _assetIndices.cend() && (_assets[it->second].asset.type != asset.type
+                                       || _assets[it->second].asset.size != asset.size)) {
+      return Error(EngineError::SIZE_MISMATCH);
+    }
+  }
+
+  Cell cell;
+  cell.coordinates = coordinates;
+  for (const CellAsset& asset : assets) {
+    const auto [it, inserted] =
+        _assetIndices.try_emplace(asset.path, static_cast<uint32_t>(_assets.size()));
+    if (inserted) {
+      _assets.push_back(Asset{.asset = asset});
+    }
+    if (std::find(cell.assets.cbegin(), cell.assets.cend(), it->second) == cell.assets.cend()) {
+      cell.assets.push_back(it->second);
+    }
+  }
+  _cellIndices.emplace(key, static_cast<uint32_t>(_cells.size()));
+  _cells.push_back(std::move(cell));
+  return StatusOk();
+}
+
+glm::ivec3 WorldStreamer::getCellCoordinates(const glm::vec3& position) const {
+  return glm::ivec3(glm::floor(glm::clamp(position / _cellSize, float(-MAX_CELL_COORDINATE),
+                                          float(MAX_CELL_COORDINATE))));
+}
+
+AABB WorldStreamer::getCellVolume(const glm::ivec3& coordinates) const {
+  const glm::vec3 lowerCorner = glm::vec3(coordinates) * _cellSize;
+  return AABB{lowerCorner, lowerCorner + _cellSize};
+}
+
+bool WorldStreamer::isResident(const glm::ivec3& coordinates) const {
+  const auto it = _cellIndices.find(packCellKey(coordinates));
+  return it != _cellIndices.cend() && _cells[it->second].resident;
+}
+
+float WorldStreamer::getDistance(const glm::ivec3& coordinates, const glm::vec3& position) const {
+  const AABB volume = getCellVolume(coordinates);
+  return glm::length(glm::clamp(position, volume.lowerCorner, volume.upperCorner) - position);
+}
+
+void WorldStreamer::loadCell(uint32_t cell) {
+  _cells[cell].resident = true;
+  _residentCells.push_back(cell);
+  for (uint32_t asset : _cells[cell].assets) {
+    if (_assets[asset].referenceCount++ == 0) {
+      _memoryUsage += _assets[asset].asset.size;
+      // An asset released by this update is simply kept.
+      if (std::erase(_requests.releases, asset) == 0) {
+        _requests.loads.push_back(asset);
+      }
+    }
+  }
+}
+
+void WorldStreamer::releaseCell(uint32_t cell) {
+  _cells[cell].resident = false;
+  std::erase(_residentCells, cell);
+  for (uint32_t asset : _cells[cell].assets) {
+    if (--_assets[asset].referenceCount == 0) {
+      _memoryUsage -= _assets[asset].asset.size;
+      // An asset requested by this update is simply not loaded.
+      if (std::erase(_requests.loads, asset) == 0) {
+        _requests.releases.push_back(asset);
+      }
+    }
+  }
+}
+
+bool WorldStreamer::makeRoom(uint32_t cell, size_t firstEviction) {
+  // Simulates the releases on the reference counts and reverts them afterwards.
+  const auto getMemoryNeeded = [this, cell] {
+    size_t size = 0;
+    for (uint32_t asset : _cells[cell].assets) {
+      size += _assets[asset].referenceCount == 0 ? _assets[asset].asset.size : 0;
+    }
+    return size;
+  };
+  size_t memoryUsage = _memoryUsage;
+  size_t eviction = _evictions.size();
+  while (memoryUsage + getMemoryNeeded() > _settings.memoryBudget && eviction > firstEviction) {
+    for (uint32_t asset : _cells[_evictions[--eviction].cell].assets) {
+      if (--_assets[asset].referenceCount == 0) {
+        memoryUsage -= _assets[asset].asset.size;
+      }
+    }
+  }
+  const bool fits = memoryUsage + getMemoryNeeded() <= _settings.memoryBudget;
+  for (size_t i = eviction; i < _evictions.size(); ++i) {
+    for (uint32_t asset : _cells[_evictions[i].cell].assets) {
+      ++_assets[asset].referenceCount;
+    }
+  }
+  if (!fits) {
+    return false;
+  }
+  while (_evictions.size() > eviction) {
+    releaseCell(_evictions.back().cell);
+    _evictions.pop_back();
+  }
+  return true;
+}
+
+const StreamingRequests& WorldStreamer::update(const glm::vec3& viewPosition) {
+  _requests.loads.clear();
+  _requests.releases.clear();
+
+  _evictions.clear();
+  for (size_t i = 0; i < _residentCells.size();) {
+    const uint32_t cell = _residentCells[i];
+    const float distance = getDistance(_cells[cell].coordinates, viewPosition);
+    if (distance > _settings.releaseRadius) {
+      releaseCell(cell);
+    } else {
+      _evictions.push_back(Candidate{distance, cell});
+      ++i;
+    }
+  }
+  std::sort(_evictions.begin(), _evictions.end(),
+            [](const Candidate& lhs, const Candidate& rhs) { return lhs.distance < rhs.distance; });
+
+  _candidates.clear();
+  const glm::ivec3 lower = getCellCoordinates(viewPosition - _settings.loadRadius);
+  const glm::ivec3 upper = getCellCoordinates(viewPosition + _settings.loadRadius);
+  for (int32_t x = lower.x; x <= upper.x; ++x) {
+    for (int32_t y = lower.y; y <= upper.y; ++y) {
+      for (int32_t z = lower.z; z <= upper.z; ++z) {
+        const auto it = _cellIndices.find(packCellKey(glm::ivec3(x, y, z)));
+        if (it == _cellIndices.cend() || _cells[it->second].resident) {
+          continue;
+        }
+        const float distance = getDistance(glm::ivec3(x, y, z), viewPosition);
+        if (distance <= _settings.loadRadius) {
+          _candidates.push_back(Candidate{distance, it->second});
+        }
+      }
+    }
+  }
+  std::sort(_candidates.begin(), _candidates.end(),
+            [](const Candidate& lhs, const Candidate& rhs) { return lhs.distance < rhs.distance; });
+
+  uint32_t loadCount = 0;
+  size_t firstEviction = 0;
+  for (const Candidate& candidate : _candidates) {
+    if (loadCount == _settings.maxLoadsPerUpdate) {
+      break;
+    }
+    // Only cells further away than the candidate may make room for it.
+    while (firstEviction < _evictions.size()
+           && _evictions[firstEviction].distance <= candidate.distance) {
+      ++firstEviction;
+    }
+    // Further candidates are not loaded before a nearer one.
+    if (!makeRoom(candidate.cell, firstEviction)) {
+      break;
+    }
+    loadCell(candidate.cell);
+    ++loadCount;
+  }
+  return _requests;
+}
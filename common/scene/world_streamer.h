@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/status/status.h"
+#include "common/util/asset_manager.h"
+#include "common/util/geometry.h"
+
+enum class StreamedAssetType : uint8_t {
+  IMAGE,
+  MODEL
+};
+
+// Asset of the manifest of a cell. Assets shared by several cells are loaded once.
+struct CellAsset {
+  std::string path;
+  StreamedAssetType type;
+  // Memory the asset occupies once loaded, counted against the budget.
+  size_t size;
+};
+
+struct StreamingSettings {
+  // Cells closer than loadRadius to the view are loaded, cells further than releaseRadius are
+  // released. The gap between both keeps cells near the border from streaming every frame.
+  float loadRadius;
+  float releaseRadius;
+  size_t memoryBudget;
+  // Limits the cells requested by one update, so loads spread over several frames.
+  uint32_t maxLoadsPerUpdate = 4;
+};
+
+// Indices into the assets of the WorldStreamer. Loads are sorted from the nearest cell.
+struct StreamingRequests {
+  std::vector<uint32_t> loads;
+  std::vector<uint32_t> releases;
+};
+
+// Partitions the world into a uniform grid of cells with a manifest of the assets each cell
+// needs. update() requests the cells around the view position, nearest first, and releases the
+// cells which left the release radius, so that the loaded assets stay within a memory budget
+// independently of the size of the world. When a cell does not fit, resident cells further away
+// than it are released to make room.
+//
+// The streamer only tracks which assets should be resident, issueRequests() forwards the
+// requests of the last update to an AssetManager.
+class WorldStreamer {
+  struct Asset {
+    CellAsset asset;
+    uint32_t referenceCount = 0;
+  };
+
+  struct Cell {
+    glm::ivec3 coordinates = glm::ivec3(0);
+    std::vector<uint32_t> assets;
+    bool resident = false;
+  };
+
+  struct Candidate {
+    float distance;
+    uint32_t cell;
+  };
+
+  float _cellSize;
+  StreamingSettings _settings;
+  std::vector<Asset> _assets;
+  std::unordered_map<std::string, uint32_t> _assetIndices;
+  std::vector<Cell> _cells;
+  std::unordered_map<uint64_t, uint32_t> _cellIndices;
+  std::vector<uint32_t> _residentCells;
+  size_t _memoryUsage = 0;
+  StreamingRequests _requests;
+  std::vector<Candidate> _candidates;
+  std::vector<Candidate> _evictions;
+
+  float getDistance(const glm::ivec3& coordinates, const glm::vec3& position) const;
+
+  void loadCell(uint32_t cell);
+
+  void releaseCell(uint32_t cell);
+
+  // Releases cells of _evictions from firstEviction on, furthest first, until the cell fits into
+  // the budget. Returns false and releases nothing when it does not fit even without them.
+  bool makeRoom(uint32_t cell, size_t firstEviction);
+
+public:
+  WorldStreamer(float cellSize, const StreamingSettings& settings);
+
+  Status addCell(const glm::ivec3& coordinates, std::span<const CellAsset> assets);
+
+  const StreamingRequests& update(const glm::vec3& viewPosition);
+
+  // Loads images through the AssetManager and models with loadModel(path). Released images are
+  // dropped from the AssetManager, released models are passed to releaseModel(path).
+  template <typename AssetManagerImpl, typename LoadModel, typename ReleaseModel>
+  void issueRequests(common::AssetManager<AssetManagerImpl>& assetManager, LoadModel&& loadModel,
+                     ReleaseModel&& releaseModel) const;
+
+  glm::ivec3 getCellCoordinates(const glm::vec3& position) const;
+
+  AABB getCellVolume(const glm::ivec3& coordinates) const;
+
+  bool isResident(const glm::ivec3& coordinates) const;
+
+  const CellAsset& getAsset(uint32_t asset) const {
+    return _assets[asset].asset;
+  }
+
+  const StreamingRequests& getRequests() const {
+    return _requests;
+  }
+
+  size_t getResidentCellCount() const {
+    return _residentCells.size();
+  }
+
+  size_t getMemoryUsage() const {
+    return _memoryUsage;
+  }
+};
+
+template <typename AssetManagerImpl, typename LoadModel, typename ReleaseModel>
+void WorldStreamer::issueRequests(common::AssetManager<AssetManagerImpl>& assetManager,
+                                  LoadModel&& loadModel, ReleaseModel&& releaseModel) const {
+  for (uint32_t asset : _requests.releases) {
+    const CellAsset& cellAsset = getAsset(asset);
+    if (cellAsset.type == StreamedAssetType::IMAGE) {
+      assetManager.releaseImage(cellAsset.path);
+    } else {
+      releaseModel(cellAsset.path);
+    }
+  }
+  for (uint32_t asset : _requests.loads) {
+    const CellAsset& cellAsset = getAsset(asset);
+    if (cellAsset.type == StreamedAssetType::IMAGE) {
+      assetManager.loadImageAsync(cellAsset.path);
+    } else {
+      loadModel(cellAsset.path);
+    }
+  }
+}
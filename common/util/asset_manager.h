@@ -14,6 +14,14 @@ public:
     static_cast<AssetManagerImpl*>(this)->loadImageAsync(filePath);
   }
 
+  void releaseImage(const std::string& filePath) {
+    static_cast<AssetManagerImpl*>(this)->releaseImage(filePath);
+  }
+
+  void releaseVertexData(const std::string& name) {
+    static_cast<AssetManagerImpl*>(this)->releaseVertexData(name);
+  }
+
   template <typename Model, typename... Type>
   void loadVertexDataInterleavingAsync(
       std::shared_ptr<Model>& modelPtr, const std::string& name, std::span<const std::byte> indices,
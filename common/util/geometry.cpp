@@ -1,5 +1,7 @@
 #include "geometry.h"
 
+#include "lib/simd/kernels.h"
+
 bool AABB::contains(const AABB& other) const {
   const glm::vec3 otherLowerCorner = other.lowerCorner;
   const glm::vec3 otherUpperCorner = other.upperCorner;
@@ -18,6 +20,42 @@ void AABB::extend(const AABB& other) {
   upperCorner.z = std::max(upperCorner.z, other.upperCorner.z);
 }
 
+void AABBBatch::push_back(const AABB& volume) {
+  minX.push_back(volume.lowerCorner.x);
+  minY.push_back(volume.lowerCorner.y);
+  minZ.push_back(volume.lowerCorner.z);
+  maxX.push_back(volume.upperCorner.x);
+  maxY.push_back(volume.upperCorner.y);
+  maxZ.push_back(volume.upperCorner.z);
+}
+
+void AABBBatch::reserve(size_t size) {
+  for (std::vector<float>* bounds : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+    bounds->reserve(size);
+  }
+}
+
+void AABBBatch::clear() {
+  for (std::vector<float>* bounds : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+    bounds->clear();
+  }
+}
+
+void cullAABBs(const AABBBatch& boxes, std::span<const glm::vec4> planes,
+               std::vector<uint32_t>& visible) {
+  const size_t offset = visible.size();
+  visible.resize(offset + boxes.size());
+  const lib::BoxArrays arrays = {.minX = boxes.minX.data(),
+                                 .minY = boxes.minY.data(),
+                                 .minZ = boxes.minZ.data(),
+                                 .maxX = boxes.maxX.data(),
+                                 .maxY = boxes.maxY.data(),
+                                 .maxZ = boxes.maxZ.data(),
+                                 .count = boxes.size()};
+  const std::span<const float> planeValues(&planes.data()->x, planes.size() * 4);
+  visible.resize(offset + lib::cullBoxes(arrays, planeValues, visible.data() + offset));
+}
+
 AABB createAABBfromVertices(std::span<const glm::vec3> vertices, const glm::mat4& transform) {
   AABB volume = {
     .lowerCorner = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
@@ -74,6 +112,44 @@ bool AABB::intersectsFrustum(std::span<const glm::vec4> planes) const {
   return true;
 }
 
+bool AABB::isInsideFrustum(std::span<const glm::vec4> planes) const {
+  for (const glm::vec4& plane : planes) {
+    glm::vec3 normal(plane.x, plane.y, plane.z);
+    glm::vec3 negativeVertex =
+        glm::vec3((plane.x >= 0.0f) ? lowerCorner.x : upperCorner.x,
+                  (plane.y >= 0.0f) ? lowerCorner.y : upperCorner.y,
+                  (plane.z >= 0.0f) ? lowerCorner.z : upperCorner.z);
+
+    if (glm::dot(normal, negativeVertex) + plane.w < 0.0f) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+FrustumContainment AABB::classifyFrustum(std::span<const glm::vec4> planes) const {
+  bool isInside = true;
+  for (const glm::vec4& plane : planes) {
+    glm::vec3 normal(plane.x, plane.y, plane.z);
+    glm::vec3 positiveVertex =
+        glm::vec3((plane.x >= 0.0f) ? upperCorner.x : lowerCorner.x,
+                  (plane.y >= 0.0f) ? upperCorner.y : lowerCorner.y,
+                  (plane.z >= 0.0f) ? upperCorner.z : lowerCorner.z);
+    glm::vec3 negativeVertex =
+        glm::vec3((plane.x >= 0.0f) ? lowerCorner.x : upperCorner.x,
+                  (plane.y >= 0.0f) ? lowerCorner.y : upperCorner.y,
+                  (plane.z >= 0.0f) ? lowerCorner.z : upperCorner.z);
+
+    if (glm::dot(normal, positiveVertex) + plane.w < 0.0f) {
+      return FrustumContainment::OUTSIDE;
+    }
+    isInside &= glm::dot(normal, negativeVertex) + plane.w >= 0.0f;
+  }
+
+  return isInside ? FrustumContainment::INSIDE : FrustumContainment::INTERSECTS;
+}
+
 namespace {
 
 template <typename IndexType>
@@ -12,15 +12,43 @@
 
 constexpr size_t NUM_CUBE_FACES = 6;
 
+enum class FrustumContainment : uint8_t {
+  OUTSIDE,
+  INTERSECTS,
+  INSIDE
+};
+
 struct AABB {
   glm::vec3 lowerCorner;
   glm::vec3 upperCorner;
 
   bool contains(const AABB& other) const;
   bool intersectsFrustum(std::span<const glm::vec4> planes) const;
+  bool isInsideFrustum(std::span<const glm::vec4> planes) const;
+  // Both tests above in a single pass over the planes.
+  FrustumContainment classifyFrustum(std::span<const glm::vec4> planes) const;
   void extend(const AABB& other);
 };
 
+// AABBs stored as one array per bound, so batches of them can be culled with SIMD.
+struct AABBBatch {
+  std::vector<float> minX, minY, minZ;
+  std::vector<float> maxX, maxY, maxZ;
+
+  void push_back(const AABB& volume);
+  void reserve(size_t size);
+  void clear();
+
+  size_t size() const {
+    return minX.size();
+  }
+};
+
+// Appends the indices of the boxes for which AABB::intersectsFrustum holds to visible, in
+// ascending order. Several boxes are tested at once with the best instruction set available.
+void cullAABBs(const AABBBatch& boxes, std::span<const glm::vec4> planes,
+               std::vector<uint32_t>& visible);
+
 AABB createAABBfromVertices(
     std::span<const glm::vec3> vertices, const glm::mat4& transform = glm::mat4(1.0f));
 
@@ -1,5 +1,8 @@
 #include "vertex_builder.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "common/status/status.h"
 
 ErrorOr<lib::Buffer<VertexPT>> buildInterleavingVertexData(
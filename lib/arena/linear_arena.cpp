@@ -0,0 +1,34 @@
+#include "linear_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace lib {
+
+LinearArena::LinearArena(size_t blockSize) : _blockSize(blockSize) {}
+
+void* LinearArena::allocate(size_t size, size_t alignment) {
+  while (_blockIndex < _blocks.size()) {
+    Block& block = _blocks[_blockIndex];
+    const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+    const size_t offset = ((base + _offset + alignment - 1) & ~(alignment - 1)) - base;
+    if (offset + size <= block.size) {
+      _offset = offset + size;
+      return block.data.get() + offset;
+    }
+    ++_blockIndex;
+    _offset = 0;
+  }
+
+  const size_t blockSize = std::max(_blockSize, size + alignment);
+  _blocks.push_back(Block{std::make_unique_for_overwrite<std::byte[]>(blockSize), blockSize});
+  _blockIndex = _blocks.size() - 1;
+  return allocate(size, alignment);
+}
+
+void LinearArena::reset() {
+  _blockIndex = 0;
+  _offset = 0;
+}
+
+}  // namespace lib
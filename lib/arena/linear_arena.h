@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace lib {
+
+// Bump allocator handing out memory from a list of blocks. Nothing is freed individually,
+// reset() rewinds the arena and keeps the blocks for reuse.
+class LinearArena {
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    size_t size;
+  };
+
+  std::vector<Block> _blocks;
+  size_t _blockIndex = 0;
+  size_t _offset = 0;
+  size_t _blockSize;
+
+public:
+  explicit LinearArena(size_t blockSize = 64 * 1024);
+
+  void* allocate(size_t size, size_t alignment);
+
+  template <typename T, typename... Args>
+  T* create(Args&&... args) {
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  void reset();
+};
+
+}  // namespace lib
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "lib/thread_pool/thread_pool.h"
+
+namespace lib {
+
+// Stable LSD radix sort of unsigned integers by their bits [beginBit, endBit). The order of
+// values differing only outside that range is kept, so e.g. an index packed into the low bits
+// survives the sort. scratch must be as large as values. Every pass sorts by 11 bits. With a
+// thread pool, each pass counts digits per chunk in parallel, prefix sums the histograms and
+// scatters the chunks in parallel.
+template <typename Type>
+void radixSort(std::span<Type> values, std::span<Type> scratch, unsigned beginBit,
+               unsigned endBit = sizeof(Type) * CHAR_BIT, ThreadPool* threadPool = nullptr) {
+  static_assert(std::is_unsigned_v<Type>, "radixSort requires an unsigned type");
+  constexpr unsigned RADIX_BITS = 11;
+  constexpr size_t BUCKET_COUNT = size_t(1) << RADIX_BITS;
+  constexpr size_t MIN_CHUNK_SIZE = 16384;
+
+  const size_t count = values.size();
+  const size_t threadCount = threadPool ? threadPool->getThreadCount() + 1 : 1;
+  const size_t chunkSize =
+      std::max(MIN_CHUNK_SIZE, (count + threadCount * 4 - 1) / (threadCount * 4));
+  const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+  std::vector<std::array<size_t, BUCKET_COUNT>> histograms(chunkCount);
+
+  const auto forEachChunk = [&](auto&& func) {
+    const auto run = [&](size_t begin, size_t end) {
+      for (size_t chunk = begin; chunk < end; ++chunk) {
+        func(chunk, chunk * chunkSize, std::min((chunk + 1) * chunkSize, count));
+      }
+    };
+    if (threadPool) {
+      threadPool->parallelFor(chunkCount, 1, run);
+    } else {
+      run(0, chunkCount);
+    }
+  };
+
+  std::span<Type> source = values;
+  std::span<Type> destination = scratch;
+  for (unsigned shift = beginBit; shift < endBit; shift += RADIX_BITS) {
+    const Type mask = static_cast<Type>((Type(1) << std::min(RADIX_BITS, endBit - shift)) - 1);
+    forEachChunk([&](size_t chunk, size_t begin, size_t end) {
+      std::array<size_t, BUCKET_COUNT>& histogram = histograms[chunk];
+      histogram.fill(0);
+      for (size_t i = begin; i < end; ++i) {
+        ++histogram[(source[i] >> shift) & mask];
+      }
+    });
+
+    // Turns the counts into scatter offsets, digit-major so that chunks stay in order.
+    size_t offset = 0;
+    bool isSorted = false;
+    for (size_t digit = 0; digit < BUCKET_COUNT; ++digit) {
+      size_t digitCount = 0;
+      for (std::array<size_t, BUCKET_COUNT>& histogram : histograms) {
+        const size_t chunkDigitCount = histogram[digit];
+        histogram[digit] = offset;
+        offset += chunkDigitCount;
+        digitCount += chunkDigitCount;
+      }
+      isSorted |= digitCount == count;
+    }
+    if (isSorted) {
+      continue;
+    }
+
+    forEachChunk([&](size_t chunk, size_t begin, size_t end) {
+      std::array<size_t, BUCKET_COUNT>& offsets = histograms[chunk];
+      for (size_t i = begin; i < end; ++i) {
+        destination[offsets[(source[i] >> shift) & mask]++] = source[i];
+      }
+    });
+    std::swap(source, destination);
+  }
+  if (source.data() != values.data()) {
+    std::copy(source.begin(), source.end(), values.begin());
+  }
+}
+
+}  // namespace lib
@@ -0,0 +1,375 @@
+#include "kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define LIB_SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define LIB_SIMD_TARGET_AVX2
+#else
+#define LIB_SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LIB_SIMD_NEON
+#endif
+
+namespace lib {
+
+namespace {
+
+struct Kernels {
+  void (*axpy)(float* y, const float* x, float a, size_t count);
+  void (*clamp)(float* values, float min, float max, size_t count);
+  void (*scale)(float* values, float factor, size_t count);
+  size_t (*cullBoxes)(const BoxArrays& boxes, std::span<const float> planes, uint32_t* visible);
+};
+
+// A frustum plane with the box bounds farthest along its normal, the box intersects the
+// positive side if that corner does.
+struct CullPlane {
+  const float* x;
+  const float* y;
+  const float* z;
+  float a;
+  float b;
+  float c;
+  float d;
+};
+
+struct CullPlanes {
+  std::array<CullPlane, MAX_CULL_PLANES> planes;
+  size_t count;
+};
+
+CullPlanes getCullPlanes(const BoxArrays& boxes, std::span<const float> planes) {
+  assert(planes.size() % 4 == 0 && planes.size() / 4 <= MAX_CULL_PLANES);
+  CullPlanes result = {.planes = {}, .count = planes.size() / 4};
+  for (size_t i = 0; i < result.count; ++i) {
+    const float* plane = planes.data() + i * 4;
+    result.planes[i] = {.x = plane[0] >= 0.0f ? boxes.maxX : boxes.minX,
+                        .y = plane[1] >= 0.0f ? boxes.maxY : boxes.minY,
+                        .z = plane[2] >= 0.0f ? boxes.maxZ : boxes.minZ,
+                        .a = plane[0],
+                        .b = plane[1],
+                        .c = plane[2],
+                        .d = plane[3]};
+  }
+  return result;
+}
+
+// Vector paths evaluate the planes with the same operations in the same order, so every path
+// agrees with AABB::intersectsFrustum on boxes touching a plane. This file and geometry.cpp are
+// built with -ffp-contract=off, otherwise the AVX2 target fuses the multiply-adds.
+size_t cullBoxRange(const CullPlanes& planes, size_t begin, size_t end, uint32_t* visible) {
+  size_t visibleCount = 0;
+  for (size_t i = begin; i < end; ++i) {
+    bool inside = true;
+    for (size_t p = 0; p < planes.count; ++p) {
+      const CullPlane& plane = planes.planes[p];
+      inside &= plane.a * plane.x[i] + plane.b * plane.y[i] + plane.c * plane.z[i] + plane.d
+                >= 0.0f;
+    }
+    visible[visibleCount] = static_cast<uint32_t>(i);
+    visibleCount += inside;
+  }
+  return visibleCount;
+}
+
+size_t appendVisible(uint32_t mask, size_t base, uint32_t* visible) {
+  size_t visibleCount = 0;
+  for (; mask; mask &= mask - 1) {
+    visible[visibleCount++] = static_cast<uint32_t>(base + std::countr_zero(mask));
+  }
+  return visibleCount;
+}
+
+// Tails of the vector kernels use the same arithmetic as their bodies, fused where the body
+// is fused, so a value never depends on its position in the array.
+void axpyScalar(float* y, const float* x, float a, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    y[i] += a * x[i];
+  }
+}
+
+void clampScalar(float* values, float min, float max, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = std::min(std::max(values[i], min), max);
+  }
+}
+
+void scaleScalar(float* values, float factor, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    values[i] *= factor;
+  }
+}
+
+size_t cullBoxesScalar(const BoxArrays& boxes, std::span<const float> planes, uint32_t* visible) {
+  return cullBoxRange(getCullPlanes(boxes, planes), 0, boxes.count, visible);
+}
+
+constexpr Kernels SCALAR_KERNELS = {axpyScalar, clampScalar, scaleScalar, cullBoxesScalar};
+
+#if defined(LIB_SIMD_X86)
+void axpySse(float* y, const float* x, float a, size_t count) {
+  const __m128 factor = _mm_set1_ps(a);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 result = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(factor, _mm_loadu_ps(x + i)));
+    _mm_storeu_ps(y + i, result);
+  }
+  axpyScalar(y + i, x + i, a, count - i);
+}
+
+void clampSse(float* values, float min, float max, size_t count) {
+  const __m128 lower = _mm_set1_ps(min);
+  const __m128 upper = _mm_set1_ps(max);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(values + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i), lower), upper));
+  }
+  clampScalar(values + i, min, max, count - i);
+}
+
+void scaleSse(float* values, float factor, size_t count) {
+  const __m128 scale = _mm_set1_ps(factor);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(values + i, _mm_mul_ps(_mm_loadu_ps(values + i), scale));
+  }
+  scaleScalar(values + i, factor, count - i);
+}
+
+size_t cullBoxesSse(const BoxArrays& boxes, std::span<const float> planes, uint32_t* visible) {
+  const CullPlanes cullPlanes = getCullPlanes(boxes, planes);
+  size_t visibleCount = 0;
+  size_t i = 0;
+  for (; i + 4 <= boxes.count; i += 4) {
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (size_t p = 0; p < cullPlanes.count; ++p) {
+      const CullPlane& plane = cullPlanes.planes[p];
+      __m128 distance = _mm_mul_ps(_mm_set1_ps(plane.a), _mm_loadu_ps(plane.x + i));
+      distance =
+          _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.b), _mm_loadu_ps(plane.y + i)));
+      distance =
+          _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.c), _mm_loadu_ps(plane.z + i)));
+      distance = _mm_add_ps(distance, _mm_set1_ps(plane.d));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+    }
+    visibleCount += appendVisible(_mm_movemask_ps(inside), i, visible + visibleCount);
+  }
+  return visibleCount + cullBoxRange(cullPlanes, i, boxes.count, visible + visibleCount);
+}
+
+constexpr Kernels SSE_KERNELS = {axpySse, clampSse, scaleSse, cullBoxesSse};
+
+LIB_SIMD_TARGET_AVX2 void axpyAvx2(float* y, const float* x, float a, size_t count) {
+  const __m256 factor = _mm256_set1_ps(a);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    _mm256_storeu_ps(
+        y + i, _mm256_fmadd_ps(factor, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    _mm256_storeu_ps(
+        y + i + 8, _mm256_fmadd_ps(factor, _mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8)));
+  }
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(
+        y + i, _mm256_fmadd_ps(factor, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+  }
+  for (; i < count; ++i) {
+    y[i] = std::fma(a, x[i], y[i]);
+  }
+}
+
+LIB_SIMD_TARGET_AVX2 void clampAvx2(float* values, float min, float max, size_t count) {
+  const __m256 lower = _mm256_set1_ps(min);
+  const __m256 upper = _mm256_set1_ps(max);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(
+        values + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(values + i), lower), upper));
+  }
+  clampScalar(values + i, min, max, count - i);
+}
+
+LIB_SIMD_TARGET_AVX2 void scaleAvx2(float* values, float factor, size_t count) {
+  const __m256 scale = _mm256_set1_ps(factor);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(values + i, _mm256_mul_ps(_mm256_loadu_ps(values + i), scale));
+  }
+  scaleScalar(values + i, factor, count - i);
+}
+
+LIB_SIMD_TARGET_AVX2 size_t cullBoxesAvx2(
+    const BoxArrays& boxes, std::span<const float> planes, uint32_t* visible) {
+  const CullPlanes cullPlanes = getCullPlanes(boxes, planes);
+  size_t visibleCount = 0;
+  size_t i = 0;
+  for (; i + 8 <= boxes.count; i += 8) {
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (size_t p = 0; p < cullPlanes.count; ++p) {
+      const CullPlane& plane = cullPlanes.planes[p];
+      __m256 distance = _mm256_mul_ps(_mm256_set1_ps(plane.a), _mm256_loadu_ps(plane.x + i));
+      distance = _mm256_add_ps(
+          distance, _mm256_mul_ps(_mm256_set1_ps(plane.b), _mm256_loadu_ps(plane.y + i)));
+      distance = _mm256_add_ps(
+          distance, _mm256_mul_ps(_mm256_set1_ps(plane.c), _mm256_loadu_ps(plane.z + i)));
+      distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.d));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    visibleCount += appendVisible(_mm256_movemask_ps(inside), i, visible + visibleCount);
+  }
+  return visibleCount + cullBoxRange(cullPlanes, i, boxes.count, visible + visibleCount);
+}
+
+constexpr Kernels AVX2_KERNELS = {axpyAvx2, clampAvx2, scaleAvx2, cullBoxesAvx2};
+
+bool supportsAvx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+  const bool fma = info[2] & (1 << 12);
+  __cpuidex(info, 7, 0);
+  return osSavesYmm && fma && (info[1] & (1 << 5));
+#else
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif
+
+#if defined(LIB_SIMD_NEON)
+void axpyNeon(float* y, const float* x, float a, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(y + i, vfmaq_n_f32(vld1q_f32(y + i), vld1q_f32(x + i), a));
+  }
+  for (; i < count; ++i) {
+    y[i] = std::fma(a, x[i], y[i]);
+  }
+}
+
+void clampNeon(float* values, float min, float max, size_t count) {
+  const float32x4_t lower = vdupq_n_f32(min);
+  const float32x4_t upper = vdupq_n_f32(max);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(values + i, vminq_f32(vmaxq_f32(vld1q_f32(values + i), lower), upper));
+  }
+  clampScalar(values + i, min, max, count - i);
+}
+
+void scaleNeon(float* values, float factor, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(values + i, vmulq_n_f32(vld1q_f32(values + i), factor));
+  }
+  scaleScalar(values + i, factor, count - i);
+}
+
+size_t cullBoxesNeon(const BoxArrays& boxes, std::span<const float> planes, uint32_t* visible) {
+  const CullPlanes cullPlanes = getCullPlanes(boxes, planes);
+  const uint32x4_t laneBits = {1, 2, 4, 8};
+  size_t visibleCount = 0;
+  size_t i = 0;
+  for (; i + 4 <= boxes.count; i += 4) {
+    uint32x4_t inside = vdupq_n_u32(~0u);
+    for (size_t p = 0; p < cullPlanes.count; ++p) {
+      const CullPlane& plane = cullPlanes.planes[p];
+      float32x4_t distance = vmulq_n_f32(vld1q_f32(plane.x + i), plane.a);
+      distance = vaddq_f32(distance, vmulq_n_f32(vld1q_f32(plane.y + i), plane.b));
+      distance = vaddq_f32(distance, vmulq_n_f32(vld1q_f32(plane.z + i), plane.c));
+      distance = vaddq_f32(distance, vdupq_n_f32(plane.d));
+      inside = vandq_u32(inside, vcgeq_f32(distance, vdupq_n_f32(0.0f)));
+    }
+    visibleCount +=
+        appendVisible(vaddvq_u32(vandq_u32(inside, laneBits)), i, visible + visibleCount);
+  }
+  return visibleCount + cullBoxRange(cullPlanes, i, boxes.count, visible + visibleCount);
+}
+
+constexpr Kernels NEON_KERNELS = {axpyNeon, clampNeon, scaleNeon, cullBoxesNeon};
+#endif
+
+SimdLevel detectSimdLevel() {
+#if defined(LIB_SIMD_X86)
+  return supportsAvx2() ? SimdLevel::AVX2 : SimdLevel::SSE;
+#elif defined(LIB_SIMD_NEON)
+  return SimdLevel::NEON;
+#else
+  return SimdLevel::SCALAR;
+#endif
+}
+
+const Kernels* getKernels(SimdLevel level) {
+  switch (level) {
+#if defined(LIB_SIMD_X86)
+    case SimdLevel::SSE:
+      return &SSE_KERNELS;
+    case SimdLevel::AVX2:
+      return &AVX2_KERNELS;
+#elif defined(LIB_SIMD_NEON)
+    case SimdLevel::NEON:
+      return &NEON_KERNELS;
+#endif
+    default:
+      return &SCALAR_KERNELS;
+  }
+}
+
+struct Dispatch {
+  SimdLevel level;
+  const Kernels* kernels;
+};
+
+Dispatch& getDispatch() {
+  static Dispatch dispatch = {getSupportedSimdLevel(), getKernels(getSupportedSimdLevel())};
+  return dispatch;
+}
+
+}  // namespace
+
+SimdLevel getSupportedSimdLevel() {
+  static const SimdLevel level = detectSimdLevel();
+  return level;
+}
+
+SimdLevel getSimdLevel() {
+  return getDispatch().level;
+}
+
+bool setSimdLevel(SimdLevel level) {
+  const SimdLevel supported = getSupportedSimdLevel();
+  const bool isSupported = level == SimdLevel::SCALAR || level == supported
+                           || (level == SimdLevel::SSE && supported == SimdLevel::AVX2);
+  if (!isSupported) {
+    return false;
+  }
+  getDispatch() = {level, getKernels(level)};
+  return true;
+}
+
+void axpy(float* y, const float* x, float a, size_t count) {
+  getDispatch().kernels->axpy(y, x, a, count);
+}
+
+void clamp(float* values, float min, float max, size_t count) {
+  getDispatch().kernels->clamp(values, min, max, count);
+}
+
+void damp(float* values, float damping, float deltaTime, size_t count) {
+  getDispatch().kernels->scale(values, 1.0f / (1.0f + damping * deltaTime), count);
+}
+
+size_t cullBoxes(const BoxArrays& boxes, std::span<const float> planes, uint32_t* visible) {
+  return getDispatch().kernels->cullBoxes(boxes, planes, visible);
+}
+
+}  // namespace lib
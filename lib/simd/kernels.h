@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace lib {
+
+// Instruction sets the kernels below can run on. The best one supported by the CPU is picked
+// on first use.
+enum class SimdLevel : uint8_t {
+  SCALAR,
+  SSE,
+  AVX2,
+  NEON
+};
+
+SimdLevel getSupportedSimdLevel();
+
+SimdLevel getSimdLevel();
+
+// Forces the kernels onto another instruction set, e.g. for benchmarks. Returns false and
+// keeps the current level if the CPU does not support it. Must not be called while kernels run.
+bool setSimdLevel(SimdLevel level);
+
+// Kernels over float arrays. Results don't depend on how an array is split between calls, so
+// chunks can be processed on different threads.
+
+// y[i] += a * x[i]
+void axpy(float* y, const float* x, float a, size_t count);
+
+// values[i] = min(max(values[i], min), max)
+void clamp(float* values, float min, float max, size_t count);
+
+// Exponential-like decay which stays stable for large time steps:
+// values[i] *= 1 / (1 + damping * deltaTime)
+void damp(float* values, float damping, float deltaTime, size_t count);
+
+// Axis-aligned boxes stored as one array per bound.
+struct BoxArrays {
+  const float* minX;
+  const float* minY;
+  const float* minZ;
+  const float* maxX;
+  const float* maxY;
+  const float* maxZ;
+  size_t count;
+};
+
+constexpr size_t MAX_CULL_PLANES = 8;
+
+// Writes the indices of the boxes intersecting the positive side of every plane to visible, in
+// ascending order, and returns their number. Planes are (a, b, c, d) quadruples, at most
+// MAX_CULL_PLANES of them. visible must have room for boxes.count indices. SSE and NEON test 4
+// boxes at once, AVX2 8.
+size_t cullBoxes(const BoxArrays& boxes, std::span<const float> planes, uint32_t* visible);
+
+}  // namespace lib
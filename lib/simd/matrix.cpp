@@ -0,0 +1 @@
+#include "matrix.h"
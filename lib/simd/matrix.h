@@ -0,0 +1,46 @@
+#pragma once
+
+#include "simd.h"
+
+namespace lib {
+
+// out = lhs * rhs for column-major 4x4 float matrices (the glm layout). out must not alias the
+// inputs. Each column of the result is a linear combination of the columns of lhs.
+inline void multiplyMat4(const float* lhs, const float* rhs, float* out) {
+#if defined(LIB_SIMD_SSE)
+  const __m128 c0 = _mm_loadu_ps(lhs);
+  const __m128 c1 = _mm_loadu_ps(lhs + 4);
+  const __m128 c2 = _mm_loadu_ps(lhs + 8);
+  const __m128 c3 = _mm_loadu_ps(lhs + 12);
+  for (int i = 0; i < 4; ++i) {
+    const float* column = rhs + i * 4;
+    __m128 result = _mm_mul_ps(c0, _mm_set1_ps(column[0]));
+    result = _mm_add_ps(result, _mm_mul_ps(c1, _mm_set1_ps(column[1])));
+    result = _mm_add_ps(result, _mm_mul_ps(c2, _mm_set1_ps(column[2])));
+    result = _mm_add_ps(result, _mm_mul_ps(c3, _mm_set1_ps(column[3])));
+    _mm_storeu_ps(out + i * 4, result);
+  }
+#elif defined(LIB_SIMD_NEON)
+  const float32x4_t c0 = vld1q_f32(lhs);
+  const float32x4_t c1 = vld1q_f32(lhs + 4);
+  const float32x4_t c2 = vld1q_f32(lhs + 8);
+  const float32x4_t c3 = vld1q_f32(lhs + 12);
+  for (int i = 0; i < 4; ++i) {
+    const float32x4_t column = vld1q_f32(rhs + i * 4);
+    float32x4_t result = vmulq_laneq_f32(c0, column, 0);
+    result = vfmaq_laneq_f32(result, c1, column, 1);
+    result = vfmaq_laneq_f32(result, c2, column, 2);
+    result = vfmaq_laneq_f32(result, c3, column, 3);
+    vst1q_f32(out + i * 4, result);
+  }
+#else
+  for (int i = 0; i < 4; ++i) {
+    for (int row = 0; row < 4; ++row) {
+      out[i * 4 + row] = lhs[row] * rhs[i * 4] + lhs[4 + row] * rhs[i * 4 + 1] +
+                         lhs[8 + row] * rhs[i * 4 + 2] + lhs[12 + row] * rhs[i * 4 + 3];
+    }
+  }
+#endif
+}
+
+}  // namespace lib
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "simd.h"
+
+namespace lib {
+
+// Up to MAX_PLANES planes (a, b, c, d) stored as separate arrays in groups of four, so a box is
+// classified against all of them in one pass. The distances are computed exactly like the
+// scalar positive/negative vertex test, (a * x + b * y) + c * z + d, so the results match it.
+class PlaneSet {
+public:
+  static constexpr size_t MAX_PLANES = 64;
+
+private:
+  alignas(16) std::array<float, MAX_PLANES> _a;
+  alignas(16) std::array<float, MAX_PLANES> _b;
+  alignas(16) std::array<float, MAX_PLANES> _c;
+  alignas(16) std::array<float, MAX_PLANES> _d;
+  size_t _size;
+
+public:
+  // planes holds (a, b, c, d) quadruples. The last group is padded with planes every box is
+  // inside of.
+  explicit PlaneSet(std::span<const float> planes) : _size(planes.size() / 4) {
+    assert(planes.size() % 4 == 0 && _size <= MAX_PLANES);
+    for (size_t i = 0; i < (_size + 3) / 4 * 4; ++i) {
+      const bool isPadding = i >= _size;
+      _a[i] = isPadding ? 0.0f : planes[i * 4];
+      _b[i] = isPadding ? 0.0f : planes[i * 4 + 1];
+      _c[i] = isPadding ? 0.0f : planes[i * 4 + 2];
+      _d[i] = isPadding ? 1.0f : planes[i * 4 + 3];
+    }
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+  // Sets bit i of outside if the box is fully on the negative side of plane i, and bit i of
+  // inside if it is fully on the non-negative side.
+  void classifyBox(const float* lower, const float* upper, uint64_t& outside,
+                   uint64_t& inside) const {
+    outside = 0;
+    inside = 0;
+    for (size_t i = 0; i < _size; i += 4) {
+      classifyGroup(lower, upper, i, outside, inside);
+    }
+    maskPlanes(outside, inside);
+  }
+
+  // Like classifyBox, but only evaluates the groups of four planes overlapping [first,
+  // first + count). The bits of the other groups stay zero.
+  void classifyBox(const float* lower, const float* upper, size_t first, size_t count,
+                   uint64_t& outside, uint64_t& inside) const {
+    assert(first + count <= _size);
+    outside = 0;
+    inside = 0;
+    for (size_t i = first / 4 * 4; i < first + count; i += 4) {
+      classifyGroup(lower, upper, i, outside, inside);
+    }
+    maskPlanes(outside, inside);
+  }
+
+private:
+  void classifyGroup(const float* lower, const float* upper, size_t i, uint64_t& outside,
+                     uint64_t& inside) const {
+#if defined(LIB_SIMD_SSE)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 a = _mm_load_ps(&_a[i]);
+    const __m128 b = _mm_load_ps(&_b[i]);
+    const __m128 c = _mm_load_ps(&_c[i]);
+    const __m128 signA = _mm_cmpge_ps(a, zero);
+    const __m128 signB = _mm_cmpge_ps(b, zero);
+    const __m128 signC = _mm_cmpge_ps(c, zero);
+    const auto select = [](__m128 mask, float ifSet, float otherwise) {
+      return _mm_or_ps(_mm_and_ps(mask, _mm_set1_ps(ifSet)),
+                       _mm_andnot_ps(mask, _mm_set1_ps(otherwise)));
+    };
+    const auto distance = [&](__m128 x, __m128 y, __m128 z) {
+      __m128 result = _mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y));
+      result = _mm_add_ps(result, _mm_mul_ps(c, z));
+      return _mm_add_ps(result, _mm_load_ps(&_d[i]));
+    };
+    const __m128 positive =
+        distance(select(signA, upper[0], lower[0]), select(signB, upper[1], lower[1]),
+                 select(signC, upper[2], lower[2]));
+    const __m128 negative =
+        distance(select(signA, lower[0], upper[0]), select(signB, lower[1], upper[1]),
+                 select(signC, lower[2], upper[2]));
+    outside |= uint64_t(_mm_movemask_ps(_mm_cmplt_ps(positive, zero))) << i;
+    inside |= uint64_t(_mm_movemask_ps(_mm_cmpge_ps(negative, zero))) << i;
+#elif defined(LIB_SIMD_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t a = vld1q_f32(&_a[i]);
+    const float32x4_t b = vld1q_f32(&_b[i]);
+    const float32x4_t c = vld1q_f32(&_c[i]);
+    const uint32x4_t signA = vcgeq_f32(a, zero);
+    const uint32x4_t signB = vcgeq_f32(b, zero);
+    const uint32x4_t signC = vcgeq_f32(c, zero);
+    const auto distance = [&](float32x4_t x, float32x4_t y, float32x4_t z) {
+      float32x4_t result = vaddq_f32(vmulq_f32(a, x), vmulq_f32(b, y));
+      result = vaddq_f32(result, vmulq_f32(c, z));
+      return vaddq_f32(result, vld1q_f32(&_d[i]));
+    };
+    const float32x4_t positive = distance(
+        vbslq_f32(signA, vdupq_n_f32(upper[0]), vdupq_n_f32(lower[0])),
+        vbslq_f32(signB, vdupq_n_f32(upper[1]), vdupq_n_f32(lower[1])),
+        vbslq_f32(signC, vdupq_n_f32(upper[2]), vdupq_n_f32(lower[2])));
+    const float32x4_t negative = distance(
+        vbslq_f32(signA, vdupq_n_f32(lower[0]), vdupq_n_f32(upper[0])),
+        vbslq_f32(signB, vdupq_n_f32(lower[1]), vdupq_n_f32(upper[1])),
+        vbslq_f32(signC, vdupq_n_f32(lower[2]), vdupq_n_f32(upper[2])));
+    const uint32x4_t laneBits = {1, 2, 4, 8};
+    outside |= uint64_t(vaddvq_u32(vandq_u32(vcltq_f32(positive, zero), laneBits))) << i;
+    inside |= uint64_t(vaddvq_u32(vandq_u32(vcgeq_f32(negative, zero), laneBits))) << i;
+#else
+    for (size_t plane = i; plane < i + 4; ++plane) {
+      const float positive = _a[plane] * (_a[plane] >= 0.0f ? upper[0] : lower[0])
+                             + _b[plane] * (_b[plane] >= 0.0f ? upper[1] : lower[1])
+                             + _c[plane] * (_c[plane] >= 0.0f ? upper[2] : lower[2])
+                             + _d[plane];
+      const float negative = _a[plane] * (_a[plane] >= 0.0f ? lower[0] : upper[0])
+                             + _b[plane] * (_b[plane] >= 0.0f ? lower[1] : upper[1])
+                             + _c[plane] * (_c[plane] >= 0.0f ? lower[2] : upper[2])
+                             + _d[plane];
+      outside |= uint64_t(positive < 0.0f) << plane;
+      inside |= uint64_t(negative >= 0.0f) << plane;
+    }
+#endif
+  }
+
+  void maskPlanes(uint64_t& outside, uint64_t& inside) const {
+    const uint64_t planeMask = _size == MAX_PLANES ? ~uint64_t(0) : (uint64_t(1) << _size) - 1;
+    outside &= planeMask;
+    inside &= planeMask;
+  }
+};
+
+}  // namespace lib
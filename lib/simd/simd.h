@@ -0,0 +1,11 @@
+#pragma once
+
+// Instruction set available at compile time, used by the inline helpers of this directory.
+// Kernels dispatched at runtime live in kernels.h.
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define LIB_SIMD_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LIB_SIMD_NEON
+#endif
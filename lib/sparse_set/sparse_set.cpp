@@ -0,0 +1 @@
+#include "sparse_set.h"
@@ -1,10 +1,149 @@
 #pragma once
 
-#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-template <typename Type, size_t N>
+namespace lib {
+
+// Set of unsigned integers with O(1) insert/erase/contains and packed iteration. The sparse
+// array is split into pages allocated on first use, so memory grows with the largest inserted
+// values actually in use instead of the whole value range.
+//
+// Only the bits of IndexMask address the sparse array. The remaining bits (e.g. a generation
+// counter) are kept in the packed array and compared by contains(), so a value whose index is
+// occupied by a different generation is reported as absent.
+template <typename Type, size_t PageSize = 4096, Type IndexMask = std::numeric_limits<Type>::max()>
 class SparseSet {
-private:
-  std::array<Type, N> _sparse;
+  static_assert(std::is_unsigned_v<Type>, "SparseSet must be instantiated with an unsigned type");
+  static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+
+  static constexpr Type INVALID_INDEX = std::numeric_limits<Type>::max();
+
+  std::vector<std::unique_ptr<Type[]>> _sparse;
+  std::vector<Type> _dense;
+
+  Type& getSparse(Type value) {
+    const size_t page = (value & IndexMask) / PageSize;
+    if (page >= _sparse.size()) {
+      _sparse.resize(page + 1);
+    }
+    if (!_sparse[page]) {
+      _sparse[page] = std::make_unique_for_overwrite<Type[]>(PageSize);
+      std::fill_n(_sparse[page].get(), PageSize, INVALID_INDEX);
+    }
+    return _sparse[page][value & (PageSize - 1)];
+  }
+
+  Type& sparse(Type value) {
+    return _sparse[(value & IndexMask) / PageSize][value & (PageSize - 1)];
+  }
+
+  const Type& sparse(Type value) const {
+    return _sparse[(value & IndexMask) / PageSize][value & (PageSize - 1)];
+  }
+
+public:
+  bool contains(Type value) const {
+    const size_t page = (value & IndexMask) / PageSize;
+    if (page >= _sparse.size() || !_sparse[page]) {
+      return false;
+    }
+    const Type index = _sparse[page][value & (PageSize - 1)];
+    return index != INVALID_INDEX && _dense[index] == value;
+  }
+
+  // Returns the packed index of the inserted value. The value must not be present yet.
+  size_t insert(Type value) {
+    getSparse(value) = static_cast<Type>(_dense.size());
+    _dense.push_back(value);
+    return _dense.size() - 1;
+  }
+
+  // Replaces the content by distinct values in the given packed order. Consecutive values share
+  // their page, so pages are only looked up when the page changes.
+  void assign(std::span<const Type> values) {
+    clear();
+    _dense.assign(values.begin(), values.end());
+    size_t currentPage = std::numeric_limits<size_t>::max();
+    Type* page = nullptr;
+    for (size_t i = 0; i < values.size(); ++i) {
+      const size_t valuePage = (values[i] & IndexMask) / PageSize;
+      if (valuePage != currentPage) {
+        currentPage = valuePage;
+        page = &getSparse(values[i]) - (values[i] & (PageSize - 1));
+      }
+      page[values[i] & (PageSize - 1)] = static_cast<Type>(i);
+    }
+  }
+
+  // Moves the last packed value into the hole and returns the packed index the value occupied.
+  size_t erase(Type value) {
+    Type& valueIndex = sparse(value);
+    const size_t index = valueIndex;
+    const Type last = _dense.back();
+    _dense[index] = last;
+    sparse(last) = static_cast<Type>(index);
+    valueIndex = INVALID_INDEX;
+    _dense.pop_back();
+    return index;
+  }
+
+  // Exchanges the packed positions of two present values.
+  void swap(Type lhs, Type rhs) {
+    Type& lhsIndex = sparse(lhs);
+    Type& rhsIndex = sparse(rhs);
+    std::swap(_dense[lhsIndex], _dense[rhsIndex]);
+    std::swap(lhsIndex, rhsIndex);
+  }
+
+  size_t index(Type value) const {
+    return sparse(value);
+  }
+
+  void reserve(size_t size) {
+    _dense.reserve(size);
+  }
+
+  void clear() {
+    for (Type value : _dense) {
+      sparse(value) = INVALID_INDEX;
+    }
+    _dense.clear();
+  }
+
+  Type operator[](size_t index) const {
+    return _dense[index];
+  }
+
+  std::span<const Type> getPacked() const {
+    return _dense;
+  }
+
+  const Type* data() const {
+    return _dense.data();
+  }
+
+  auto begin() const {
+    return _dense.cbegin();
+  }
+
+  auto end() const {
+    return _dense.cend();
+  }
+
+  size_t size() const {
+    return _dense.size();
+  }
+
+  bool empty() const {
+    return _dense.empty();
+  }
 };
+
+}  // namespace lib
@@ -0,0 +1,114 @@
+#include "thread_pool.h"
+
+namespace lib {
+
+namespace {
+
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentQueueIndex = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threadCount) {
+  _queues.reserve(threadCount + 1);
+  for (size_t i = 0; i <= threadCount; ++i) {
+    _queues.push_back(std::make_unique<WorkerQueue>());
+  }
+  _workers.reserve(threadCount);
+  for (size_t i = 0; i < threadCount; ++i) {
+    _workers.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(_sleepMutex);
+    _stop = true;
+  }
+  _sleepCondition.notify_all();
+  for (std::thread& worker : _workers) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::getCurrentQueueIndex() {
+  if (currentPool == this) {
+    return currentQueueIndex;
+  }
+  // External threads share the last queue.
+  return _queues.size() - 1;
+}
+
+void ThreadPool::submit(TaskGroup& group, std::function<void()> task) {
+  group._pending.fetch_add(1, std::memory_order_relaxed);
+  WorkerQueue& queue = *_queues[currentPool == this
+                                    ? currentQueueIndex
+                                    : _nextQueue.fetch_add(1, std::memory_order_relaxed)
+                                          % _queues.size()];
+  {
+    std::lock_guard lock(queue.mutex);
+    queue.tasks.push_back(Task{std::move(task), &group});
+  }
+  _queuedTasks.fetch_add(1, std::memory_order_release);
+  { std::lock_guard lock(_sleepMutex); }
+  _sleepCondition.notify_one();
+}
+
+bool ThreadPool::tryRunTask(size_t queueIndex) {
+  Task task;
+  bool found = false;
+  {
+    WorkerQueue& queue = *_queues[queueIndex];
+    std::lock_guard lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      found = true;
+    }
+  }
+  for (size_t i = 1; !found && i < _queues.size(); ++i) {
+    WorkerQueue& victim = *_queues[(queueIndex + i) % _queues.size()];
+    std::lock_guard lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      found = true;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  _queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+  task.function();
+  task.group->_pending.fetch_sub(1, std::memory_order_acq_rel);
+  return true;
+}
+
+void ThreadPool::workerLoop(size_t queueIndex) {
+  currentPool = this;
+  currentQueueIndex = queueIndex;
+  while (true) {
+    if (tryRunTask(queueIndex)) {
+      continue;
+    }
+    std::unique_lock lock(_sleepMutex);
+    _sleepCondition.wait(lock, [this] {
+      return _stop || _queuedTasks.load(std::memory_order_acquire) > 0;
+    });
+    if (_stop) {
+      return;
+    }
+  }
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+  const size_t queueIndex = getCurrentQueueIndex();
+  while (!group.done()) {
+    if (!tryRunTask(queueIndex)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+}  // namespace lib
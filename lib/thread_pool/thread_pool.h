@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lib {
+
+// Counts the tasks of a batch that have not finished yet.
+class TaskGroup {
+  std::atomic<size_t> _pending = 0;
+
+  friend class ThreadPool;
+
+public:
+  bool done() const {
+    return _pending.load(std::memory_order_acquire) == 0;
+  }
+};
+
+// Work-stealing thread pool. Every worker owns a queue it pops from the back, idle workers steal
+// from the front of other queues. Threads waiting for a TaskGroup execute pending tasks instead of
+// blocking, so tasks may safely submit and wait for nested work.
+class ThreadPool {
+  struct Task {
+    std::function<void()> function;
+    TaskGroup* group;
+  };
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<WorkerQueue>> _queues;
+  std::vector<std::thread> _workers;
+  std::mutex _sleepMutex;
+  std::condition_variable _sleepCondition;
+  std::atomic<size_t> _queuedTasks = 0;
+  std::atomic<size_t> _nextQueue = 0;
+  bool _stop = false;
+
+  bool tryRunTask(size_t queueIndex);
+
+  void workerLoop(size_t queueIndex);
+
+  size_t getCurrentQueueIndex();
+
+public:
+  // The thread calling wait() participates as well, so threadCount may be zero.
+  explicit ThreadPool(size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void submit(TaskGroup& group, std::function<void()> task);
+
+  void wait(TaskGroup& group);
+
+  // Splits [0, count) into ranges of at most grainSize elements and calls func(begin, end) for
+  // each of them. Ranges do not depend on the number of threads.
+  template <typename Func>
+  void parallelFor(size_t count, size_t grainSize, Func&& func) {
+    grainSize = std::max<size_t>(grainSize, 1);
+    if (count <= grainSize || _workers.empty()) {
+      for (size_t begin = 0; begin < count; begin += grainSize) {
+        func(begin, std::min(begin + grainSize, count));
+      }
+      return;
+    }
+
+    TaskGroup group;
+    for (size_t begin = grainSize; begin < count; begin += grainSize) {
+      submit(group, [&func, begin, end = std::min(begin + grainSize, count)] {
+        func(begin, end);
+      });
+    }
+    func(0, grainSize);
+    wait(group);
+  }
+
+  size_t getThreadCount() const {
+    return _workers.size();
+  }
+};
+
+}  // namespace lib
@@ -0,0 +1 @@
+#include "triple_buffer.h"
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace lib {
+
+// Lock-free hand-off of whole values from one producer thread to one consumer thread. The
+// producer fills getWriteBuffer() and publishes it, the consumer acquires the latest published
+// value. Neither side ever waits: the third buffer is the one being exchanged between them.
+template <typename Type>
+class TripleBuffer {
+  static constexpr uint8_t INDEX_MASK = 0b011;
+  static constexpr uint8_t FRESH = 0b100;
+
+  std::array<Type, 3> _buffers{};
+  // Index of the shared buffer, FRESH when it was published but not acquired yet.
+  std::atomic<uint8_t> _shared = 1;
+  uint8_t _write = 0;
+  uint8_t _read = 2;
+
+public:
+  TripleBuffer() = default;
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Producer side. The buffer keeps the contents it had two publications ago, so its memory can
+  // be reused.
+  Type& getWriteBuffer() {
+    return _buffers[_write];
+  }
+
+  void publish() {
+    _write = _shared.exchange(_write | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  // Consumer side. Returns the most recently published value, or the previously acquired one
+  // if nothing new was published. The reference stays valid until the next acquire().
+  const Type& acquire() {
+    if (_shared.load(std::memory_order_relaxed) & FRESH) {
+      _read = _shared.exchange(_read, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    return _buffers[_read];
+  }
+
+  bool hasFresh() const {
+    return _shared.load(std::memory_order_relaxed) & FRESH;
+  }
+};
+
+}  // namespace lib
@@ -1,10 +1,34 @@
 #include "asset_manager.h"
 
+#include <chrono>
+
 #include "common/util/geometry.h"
 
 using ImageData = AssetManager::ImageData;
 using VertexData = AssetManager::VertexData;
 
+namespace {
+
+// Destroying the future of a running std::async load blocks until it finishes. Such futures are
+// moved to releasedLoads instead and destroyed once they are ready.
+template <typename Resource>
+void releaseLoad(std::unordered_map<std::string, std::future<Resource>>& loads,
+                 std::vector<std::future<Resource>>& releasedLoads, const std::string& name) {
+  std::erase_if(releasedLoads, [](const std::future<Resource>& future) {
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  });
+  auto it = loads.find(name);
+  if (it == loads.end()) {
+    return;
+  }
+  if (it->second.wait_for(std::chrono::seconds(0)) == std::future_status::timeout) {
+    releasedLoads.push_back(std::move(it->second));
+  }
+  loads.erase(it);
+}
+
+}  // namespace
+
 AssetManager::AssetManager(const LogicalDevice& logicalDevice,
                            const std::shared_ptr<FileLoader>& fileLoader, std::launch launchPolicy)
   : _logicalDevice(&logicalDevice), _fileLoader(fileLoader), _launchPolicy(launchPolicy) {}
@@ -20,6 +44,8 @@ AssetManager& AssetManager::operator=(AssetManager&& assetManager) noexcept {
   _awaitingVertexDataResources = std::move(assetManager._awaitingVertexDataResources);
   _imageResources = std::move(assetManager._imageResources);
   _awaitingImageResources = std::move(assetManager._awaitingImageResources);
+  _releasedVertexDataResources = std::move(assetManager._releasedVertexDataResources);
+  _releasedImageResources = std::move(assetManager._releasedImageResources);
   return *this;
 }
 
@@ -87,3 +113,13 @@ ErrorOr<std::reference_wrapper<const VertexData>> AssetManager::getVertexData(
   }
   return Error(EngineError::NOT_FOUND);
 }
+
+void AssetManager::releaseImage(const std::string& filePath) {
+  _imageResources.erase(filePath);
+  releaseLoad(_awaitingImageResources, _releasedImageResources, filePath);
+}
+
+void AssetManager::releaseVertexData(const std::string& name) {
+  _vertexDataResources.erase(name);
+  releaseLoad(_awaitingVertexDataResources, _releasedVertexDataResources, name);
+}
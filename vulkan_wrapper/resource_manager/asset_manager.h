@@ -10,6 +10,7 @@
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/file/file_loader.h"
 #include "common/model_loader/image_loader/image_loader.h"
@@ -64,6 +65,12 @@ public:
 
   ErrorOr<std::reference_wrapper<const VertexData>> getVertexData(const std::string& filePath);
 
+  // Frees the staging memory of the resource. A load still running is kept until it finishes, so
+  // that releasing never blocks. Deferred loads which did not start yet are dropped.
+  void releaseImage(const std::string& filePath);
+
+  void releaseVertexData(const std::string& name);
+
 private:
   void loadImageAsync(
       const std::string& filePath,
@@ -80,6 +87,10 @@ private:
 
   std::unordered_map<std::string, ImageData> _imageResources;
   std::unordered_map<std::string, std::future<ErrorOr<ImageData>>> _awaitingImageResources;
+
+  // Loads released while running, dropped by the next release after they finished.
+  std::vector<std::future<ErrorOr<VertexData>>> _releasedVertexDataResources;
+  std::vector<std::future<ErrorOr<ImageData>>> _releasedImageResources;
 };
 
 template <typename Model, typename... Type>
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/archetype_registry.h"
+
+TEST(ArchetypeRegistryTest, MovesEntitiesBetweenArchetypes) {
+  ArchetypeRegistry registry;
+  const Entity first = registry.createEntity();
+  const Entity second = registry.createEntity();
+  registry.addComponent(first, PositionComponent{.x = 1.0f, .y = 2.0f});
+  registry.addComponent(second, PositionComponent{.x = 3.0f, .y = 4.0f});
+  registry.addComponent(first, VelocityComponent{.dx = 5.0f, .dy = 6.0f});
+
+  EXPECT_EQ(registry.getComponent<PositionComponent>(first).x, 1.0f);
+  EXPECT_EQ(registry.getComponent<VelocityComponent>(first).dy, 6.0f);
+  EXPECT_EQ(registry.getComponent<PositionComponent>(second).y, 4.0f);
+
+  registry.destroyEntity(first);
+  EXPECT_EQ(registry.getComponent<PositionComponent>(second).x, 3.0f);
+}
+
+TEST(ArchetypeRegistryTest, IteratesAcrossChunks) {
+  constexpr size_t ENTITY_COUNT = 2000;
+  ArchetypeRegistry registry;
+  std::vector<Entity> entities;
+  for (size_t i = 0; i < ENTITY_COUNT; ++i) {
+    const Entity entity = registry.createEntity();
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+    registry.addComponent(entity, VelocityComponent{.dx = float(i), .dy = 1.0f});
+    entities.push_back(entity);
+  }
+  for (size_t i = 0; i < entities.size(); i += 2) {
+    registry.destroyEntity(entities[i]);
+  }
+
+  size_t visited = 0;
+  registry.updateComponents<PositionComponent, VelocityComponent>(
+      [&visited](PositionComponent& position, const VelocityComponent& velocity) {
+        position.x += velocity.dx;
+        ++visited;
+      });
+
+  EXPECT_EQ(visited, ENTITY_COUNT / 2);
+  for (size_t i = 1; i < entities.size(); i += 2) {
+    EXPECT_EQ(registry.getComponent<PositionComponent>(entities[i]).x, float(i));
+  }
+}
+
+TEST(ArchetypeRegistryTest, CopiesLvalueComponents) {
+  ArchetypeRegistry registry;
+  const Entity entity = registry.createEntity();
+  const PositionComponent position{.x = 1.0f, .y = 2.0f};
+  registry.addComponent(entity, position);
+  VelocityComponent velocity{.dx = 3.0f, .dy = 4.0f};
+  registry.addComponent(entity, velocity);
+  velocity.dx = 5.0f;
+  registry.addComponent(entity, velocity);
+
+  EXPECT_EQ(registry.getComponent<PositionComponent>(entity).y, 2.0f);
+  EXPECT_EQ(registry.getComponent<VelocityComponent>(entity).dx, 5.0f);
+}
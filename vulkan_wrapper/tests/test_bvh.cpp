@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "common/scene/bvh.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+std::vector<AABB> createVolumes(size_t count, uint32_t seed) {
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> size(0.1f, 5.0f);
+  std::vector<AABB> volumes(count);
+  for (AABB& volume : volumes) {
+    volume.lowerCorner = glm::vec3(position(random), position(random), position(random));
+    volume.upperCorner = volume.lowerCorner + glm::vec3(size(random), size(random), size(random));
+  }
+  return volumes;
+}
+
+std::optional<float> raycastAll(std::span<const AABB> volumes, const Ray& ray) {
+  std::optional<float> closest;
+  for (const AABB& volume : volumes) {
+    const std::optional<float> distance = intersectRay(ray, volume);
+    if (distance && (!closest || *distance < *closest)) {
+      closest = distance;
+    }
+  }
+  return closest;
+}
+
+std::vector<Ray> createRays(size_t count) {
+  std::mt19937 random(5);
+  std::uniform_real_distribution<float> coordinate(-150.0f, 150.0f);
+  std::vector<Ray> rays(count);
+  for (Ray& ray : rays) {
+    ray.origin = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+    const glm::vec3 target(0.3f * coordinate(random), 0.3f * coordinate(random),
+                           0.3f * coordinate(random));
+    ray.direction = glm::normalize(target - ray.origin);
+  }
+  return rays;
+}
+
+void expectClosestHits(const Bvh& bvh, std::span<const AABB> volumes) {
+  size_t hitCount = 0;
+  for (const Ray& ray : createRays(500)) {
+    const std::optional<RayHit> hit = bvh.raycast(ray);
+    const std::optional<float> expected = raycastAll(volumes, ray);
+    ASSERT_EQ(hit.has_value(), expected.has_value());
+    if (hit) {
+      ++hitCount;
+      EXPECT_EQ(hit->distance, *expected);
+      EXPECT_EQ(intersectRay(ray, volumes[hit->primitive]), *expected);
+    }
+  }
+  EXPECT_GT(hitCount, 100);
+}
+
+void expectOverlaps(const Bvh& bvh, std::span<const AABB> volumes) {
+  for (const AABB& query : createVolumes(50, 8)) {
+    const AABB grown{query.lowerCorner - 10.0f, query.upperCorner + 10.0f};
+    std::vector<uint32_t> primitives;
+    bvh.overlap(grown, primitives);
+    std::sort(primitives.begin(), primitives.end());
+
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < volumes.size(); ++i) {
+      if (glm::all(glm::lessThanEqual(volumes[i].lowerCorner, grown.upperCorner))
+          && glm::all(glm::greaterThanEqual(volumes[i].upperCorner, grown.lowerCorner))) {
+        expected.push_back(i);
+      }
+    }
+    EXPECT_EQ(primitives, expected);
+  }
+}
+
+}  // namespace
+
+TEST(BvhTest, RaycastFindsClosestVolume) {
+  const std::vector<AABB> volumes = createVolumes(5000, 1);
+  Bvh bvh;
+  EXPECT_LT(bvh.build(volumes), volumes.size());
+  EXPECT_EQ(bvh.size(), volumes.size());
+  expectClosestHits(bvh, volumes);
+}
+
+TEST(BvhTest, OverlapFindsIntersectingVolumes) {
+  const std::vector<AABB> volumes = createVolumes(5000, 2);
+  Bvh bvh;
+  bvh.build(volumes);
+  expectOverlaps(bvh, volumes);
+}
+
+TEST(BvhTest, ParallelBuildAnswersQueries) {
+  const std::vector<AABB> volumes = createVolumes(50000, 3);
+  lib::ThreadPool threadPool(3);
+  Bvh bvh;
+  bvh.build(volumes, &threadPool);
+  expectClosestHits(bvh, volumes);
+  expectOverlaps(bvh, volumes);
+}
+
+TEST(BvhTest, RefitFollowsMovedVolumes) {
+  std::vector<AABB> volumes = createVolumes(5000, 4);
+  Bvh bvh;
+  const size_t nodeCount = bvh.build(volumes);
+
+  std::mt19937 random(6);
+  std::uniform_real_distribution<float> offset(-20.0f, 20.0f);
+  for (AABB& volume : volumes) {
+    const glm::vec3 translation(offset(random), offset(random), offset(random));
+    volume.lowerCorner += translation;
+    volume.upperCorner += translation;
+  }
+  bvh.refit(volumes);
+  EXPECT_EQ(bvh.getNodeCount(), nodeCount);
+  expectClosestHits(bvh, volumes);
+  expectOverlaps(bvh, volumes);
+}
+
+TEST(BvhTest, SegmentcastStopsAtEnd) {
+  const std::vector<AABB> volumes = {
+    AABB{glm::vec3(-1.0f), glm::vec3(1.0f)},
+    AABB{glm::vec3(4.0f, -1.0f, -1.0f), glm::vec3(6.0f, 1.0f, 1.0f)}};
+  Bvh bvh;
+  bvh.build(volumes);
+
+  const std::optional<RayHit> hit = bvh.segmentcast(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(0.0f));
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->primitive, 1);
+  EXPECT_FLOAT_EQ(hit->distance, 4.0f);
+  EXPECT_FALSE(bvh.segmentcast(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(7.0f, 0.0f, 0.0f)));
+  EXPECT_FALSE(bvh.segmentcast(glm::vec3(3.0f, 3.0f, 0.0f), glm::vec3(3.0f, -3.0f, 0.0f)));
+}
+
+TEST(BvhTest, RaycastsMeshTriangles) {
+  // Terrain made of a grid of quads with heights z = x / 2.
+  constexpr uint32_t GRID_SIZE = 64;
+  std::vector<glm::vec3> positions;
+  for (uint32_t y = 0; y <= GRID_SIZE; ++y) {
+    for (uint32_t x = 0; x <= GRID_SIZE; ++x) {
+      positions.emplace_back(float(x), float(y), 0.5f * float(x));
+    }
+  }
+  std::vector<uint32_t> indices;
+  for (uint32_t y = 0; y < GRID_SIZE; ++y) {
+    for (uint32_t x = 0; x < GRID_SIZE; ++x) {
+      const uint32_t corner = y * (GRID_SIZE + 1) + x;
+      indices.insert(indices.end(), {corner, corner + 1, corner + GRID_SIZE + 2, corner,
+                                     corner + GRID_SIZE + 2, corner + GRID_SIZE + 1});
+    }
+  }
+  std::vector<AABB> volumes;
+  createTriangleVolumes(positions, indices, volumes);
+  ASSERT_EQ(volumes.size(), 2 * GRID_SIZE * GRID_SIZE);
+  Bvh bvh;
+  bvh.build(volumes);
+
+  const auto intersectTriangle = [&](const Ray& ray) {
+    return [&](uint32_t triangle) {
+      return intersectRay(ray, positions[indices[3 * triangle]],
+                          positions[indices[3 * triangle + 1]],
+                          positions[indices[3 * triangle + 2]]);
+    };
+  };
+  const Ray ray{glm::vec3(10.25f, 20.75f, 100.0f), glm::vec3(0.0f, 0.0f, -1.0f)};
+  const std::optional<RayHit> hit =
+      bvh.raycast(ray, std::numeric_limits<float>::infinity(), intersectTriangle(ray));
+  ASSERT_TRUE(hit);
+  EXPECT_NEAR(hit->distance, 100.0f - 0.5f * 10.25f, 1e-4f);
+  const uint32_t cell = 20 * GRID_SIZE + 10;
+  EXPECT_TRUE(hit->primitive == 2 * cell || hit->primitive == 2 * cell + 1);
+
+  // Looking along the slope from above it misses.
+  const Ray above{glm::vec3(0.0f, 5.0f, 1.0f), glm::normalize(glm::vec3(1.0f, 0.0f, 0.5f))};
+  EXPECT_FALSE(bvh.raycast(above, 1000.0f, intersectTriangle(above)));
+}
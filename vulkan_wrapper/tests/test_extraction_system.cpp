@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/registry.h"
+#include "common/entity_component_system/system/extraction_system.h"
+#include "lib/thread_pool/thread_pool.h"
+#include "lib/triple_buffer/triple_buffer.h"
+
+namespace {
+
+struct TestPacket {
+  float x;
+  float dx;
+
+  static TestPacket create(const PositionComponent& position, const VelocityComponent& velocity) {
+    return TestPacket{.x = position.x, .dx = velocity.dx};
+  }
+};
+
+}  // namespace
+
+TEST(TripleBufferTest, ConsumerSeesLatestPublishedValue) {
+  lib::TripleBuffer<int> buffer;
+  EXPECT_EQ(buffer.acquire(), 0);
+  buffer.getWriteBuffer() = 1;
+  buffer.publish();
+  buffer.getWriteBuffer() = 2;
+  buffer.publish();
+  EXPECT_TRUE(buffer.hasFresh());
+  EXPECT_EQ(buffer.acquire(), 2);
+  EXPECT_EQ(buffer.acquire(), 2);
+
+  constexpr int COUNT = 100'000;
+  std::thread producer([&buffer] {
+    for (int i = 3; i <= COUNT; ++i) {
+      buffer.getWriteBuffer() = i;
+      buffer.publish();
+    }
+  });
+  int last = 2;
+  while (last != COUNT) {
+    const int value = buffer.acquire();
+    ASSERT_GE(value, last);
+    last = value;
+  }
+  producer.join();
+}
+
+TEST(ExtractionSystemTest, ExtractsVisibleEntities) {
+  Registry registry;
+  lib::ThreadPool threadPool(2);
+  ExtractionSystem<TestPacket, PositionComponent, VelocityComponent> system(&registry);
+  system.setThreadPool(&threadPool);
+
+  std::vector<Entity> entities = registry.createEntities(2000);
+  for (size_t i = 0; i < entities.size(); ++i) {
+    registry.addComponent(entities[i], PositionComponent{.x = float(i), .y = 0.0f});
+    registry.addComponent(entities[i], VelocityComponent{.dx = -float(i), .dy = 0.0f});
+  }
+  system.update(0.0f);
+  const FrameSnapshot<TestPacket>& all = system.acquireSnapshot();
+  ASSERT_EQ(all.packets.size(), entities.size());
+  for (const TestPacket& packet : all.packets) {
+    EXPECT_EQ(packet.x, -packet.dx);
+  }
+
+  // The acquired snapshot is not touched by the following extractions.
+  const std::vector<Entity> visible = {entities[7], entities[3]};
+  system.setVisibleEntities(&visible);
+  registry.advanceTick();
+  system.update(0.0f);
+  system.update(0.0f);
+  EXPECT_EQ(all.packets.size(), entities.size());
+  const FrameSnapshot<TestPacket>& culled = system.acquireSnapshot();
+  ASSERT_EQ(culled.packets.size(), 2);
+  EXPECT_EQ(culled.packets[0].x, 7.0f);
+  EXPECT_EQ(culled.packets[1].x, 3.0f);
+  EXPECT_EQ(culled.tick, registry.getTick());
+}
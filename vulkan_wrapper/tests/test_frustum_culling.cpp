@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <vector>
+
+#include "common/util/geometry.h"
+#include "lib/simd/kernels.h"
+
+TEST(FrustumCullingTest, BatchesMatchSingleBoxTests) {
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = extractFrustumPlanes(
+      glm::perspective(glm::radians(70.0f), 1.5f, 0.1f, 50.0f)
+      * glm::lookAt(glm::vec3(0.0f, 2.0f, -20.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+  // An odd count exercises the scalar tails.
+  std::mt19937 random(11);
+  std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+  std::uniform_real_distribution<float> size(0.0f, 3.0f);
+  AABBBatch boxes;
+  std::vector<uint32_t> expected;
+  for (uint32_t i = 0; i < 1001; ++i) {
+    const glm::vec3 lower(position(random), position(random), position(random));
+    const AABB volume{lower, lower + size(random)};
+    boxes.push_back(volume);
+    if (volume.intersectsFrustum(planes)) {
+      expected.push_back(i);
+    }
+  }
+  ASSERT_FALSE(expected.empty());
+
+  const lib::SimdLevel supported = lib::getSupportedSimdLevel();
+  for (lib::SimdLevel level : {lib::SimdLevel::SCALAR, lib::SimdLevel::SSE,
+                               lib::SimdLevel::AVX2, lib::SimdLevel::NEON}) {
+    if (!lib::setSimdLevel(level)) {
+      continue;
+    }
+    std::vector<uint32_t> visible = {42};
+    cullAABBs(boxes, planes, visible);
+    ASSERT_EQ(visible.size(), expected.size() + 1);
+    EXPECT_TRUE(std::equal(expected.cbegin(), expected.cend(), visible.cbegin() + 1));
+  }
+  lib::setSimdLevel(supported);
+}
+
+TEST(FrustumCullingTest, BatchesMatchSingleBoxTestsOnPlanes) {
+  const std::array<glm::vec4, 1> planes = {glm::vec4(0.3f, -0.7f, 0.6f, 1.3f)};
+
+  // The corner farthest along the normal lies on the plane, so the sign of the distance only
+  // depends on rounding.
+  std::mt19937 random(5);
+  std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+  AABBBatch boxes;
+  std::vector<uint32_t> expected;
+  for (uint32_t i = 0; i < 4001; ++i) {
+    const float x = position(random);
+    const float y = position(random);
+    const float z = -(planes[0].x * x + planes[0].y * y + planes[0].w) / planes[0].z;
+    const AABB volume{glm::vec3(x - 1.0f, y, z - 1.0f), glm::vec3(x, y + 1.0f, z)};
+    boxes.push_back(volume);
+    if (volume.intersectsFrustum(planes)) {
+      expected.push_back(i);
+    }
+  }
+  ASSERT_FALSE(expected.empty());
+  ASSERT_LT(expected.size(), boxes.minX.size());
+
+  const lib::SimdLevel supported = lib::getSupportedSimdLevel();
+  for (lib::SimdLevel level : {lib::SimdLevel::SCALAR, lib::SimdLevel::SSE,
+                               lib::SimdLevel::AVX2, lib::SimdLevel::NEON}) {
+    if (!lib::setSimdLevel(level)) {
+      continue;
+    }
+    std::vector<uint32_t> visible;
+    cullAABBs(boxes, planes, visible);
+    EXPECT_EQ(visible, expected) << "SIMD level " << static_cast<int>(level);
+  }
+  lib::setSimdLevel(supported);
+}
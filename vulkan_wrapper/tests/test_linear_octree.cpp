@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "common/scene/linear_octree.h"
+#include "lib/thread_pool/thread_pool.h"
+
+TEST(LinearOctreeTest, StoresObjectsInTheirDeepestCell) {
+  const AABB volume{.lowerCorner = glm::vec3(-8.0f), .upperCorner = glm::vec3(8.0f)};
+  std::vector<std::unique_ptr<Object>> objects;
+  std::vector<LinearOctree::Entry> entries;
+  const auto addEntry = [&](const glm::vec3& lower, const glm::vec3& upper) {
+    objects.push_back(std::make_unique<Object>("object", static_cast<Entity>(objects.size())));
+    entries.push_back({objects.back().get(), AABB{lower, upper}});
+  };
+  // Inside the upper-right-back octant, then its lower-left-front child.
+  addEntry(glm::vec3(1.0f), glm::vec3(7.0f));
+  addEntry(glm::vec3(1.0f), glm::vec3(3.0f));
+  // Straddles the center, outside of the volume.
+  addEntry(glm::vec3(-1.0f), glm::vec3(1.0f));
+  addEntry(glm::vec3(-1.0f), glm::vec3(9.0f));
+
+  LinearOctree octree(volume);
+  ASSERT_EQ(octree.build(entries), 3);
+  ASSERT_EQ(octree.getNodes().size(), 3);
+  EXPECT_EQ(octree.getObjects(octree.getNodes()[0])[0], objects[2].get());
+  const LinearOctree::Node* octant = octree.findNode(0b1111);
+  ASSERT_NE(octant, nullptr);
+  EXPECT_EQ(octant->volume.lowerCorner, glm::vec3(0.0f));
+  EXPECT_EQ(octree.getObjects(*octant)[0], objects[0].get());
+  EXPECT_EQ(octant->subtreeEnd, 3);
+  const LinearOctree::Node* child = octree.findNode(0b1111000);
+  ASSERT_NE(child, nullptr);
+  EXPECT_EQ(child->volume.upperCorner, glm::vec3(4.0f));
+  EXPECT_EQ(octree.getObjects(*child)[0], objects[1].get());
+  EXPECT_EQ(octree.findNode(0b1000), nullptr);
+
+  // Queries are conservative and do not depend on the thread pool.
+  std::mt19937 random(3);
+  std::uniform_real_distribution<float> position(-7.5f, 7.0f);
+  std::uniform_real_distribution<float> size(0.01f, 0.5f);
+  for (int i = 0; i < 5000; ++i) {
+    const glm::vec3 lower(position(random), position(random), position(random));
+    addEntry(lower, lower + size(random));
+  }
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = extractFrustumPlanes(
+      glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 20.0f)
+      * glm::lookAt(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+  octree.build(entries);
+  std::vector<const Object*> visible;
+  octree.query(planes, visible);
+
+  lib::ThreadPool threadPool(3);
+  LinearOctree parallelOctree(volume);
+  parallelOctree.build(entries, &threadPool);
+  std::vector<const Object*> parallelVisible;
+  parallelOctree.query(planes, parallelVisible);
+  EXPECT_EQ(visible, parallelVisible);
+
+  std::sort(visible.begin(), visible.end());
+  for (const LinearOctree::Entry& entry : entries) {
+    if (volume.contains(entry.volume) && entry.volume.intersectsFrustum(planes)) {
+      EXPECT_TRUE(std::binary_search(visible.cbegin(), visible.cend(), entry.object));
+    }
+  }
+}
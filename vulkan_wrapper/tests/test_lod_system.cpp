@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+#include "common/entity_component_system/component/lod.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/entity_component_system/registry/registry.h"
+#include "common/entity_component_system/system/lod_system.h"
+#include "common/entity_component_system/system/transform_system.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+// 90 degrees vertically on a 1000 pixel high viewport: an object of size 1 at distance 1 covers
+// 500 pixels.
+constexpr float VIEWPORT_HEIGHT = 1000.0f;
+const Projection PROJECTION = PerspectiveProjection{.fovy = glm::radians(90.0f),
+                                                    .aspect = 1.0f,
+                                                    .nearZ = 0.1f,
+                                                    .farZ = 1000.0f};
+
+// The world matrix is left to the TransformSystem.
+TransformComponent createTransform() {
+  return TransformComponent{.model = glm::mat4(1.0f), .world = glm::mat4(0.0f)};
+}
+
+// Unit cube, whose bounding sphere has a diameter of sqrt(3).
+LodComponent createLod() {
+  LodComponent lod;
+  lod.levels[0] = LodLevel{.firstIndex = 0, .indexCount = 3000, .minScreenSize = 200.0f};
+  lod.levels[1] = LodLevel{.firstIndex = 3000, .indexCount = 300, .minScreenSize = 50.0f};
+  lod.levels[2] = LodLevel{.firstIndex = 3300, .indexCount = 30, .minScreenSize = 0.0f};
+  lod.levelCount = 3;
+  lod.bounds = AABB{glm::vec3(-0.5f), glm::vec3(0.5f)};
+  return lod;
+}
+
+// Distance from the origin at which the unit cube is projected to the given size.
+float getDistance(float pixels) {
+  return std::sqrt(3.0f) * 0.5f * VIEWPORT_HEIGHT / pixels;
+}
+
+void placeAt(Registry& registry, Entity entity, float distance, float scale = 1.0f) {
+  registry.advanceTick();
+  registry.patch<TransformComponent>(entity, [distance, scale](TransformComponent& transform) {
+    transform.model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -distance)),
+                                 glm::vec3(scale));
+  });
+}
+
+}  // namespace
+
+TEST(LodSystemTest, SelectsLevelFromScreenSize) {
+  Registry registry;
+  TransformSystem transforms(&registry);
+  LodSystem system(&registry);
+  const auto update = [&] {
+    transforms.update(0.0f);
+    system.update(0.0f);
+  };
+  system.setView(glm::vec3(0.0f), PROJECTION, VIEWPORT_HEIGHT);
+  const Entity entity = registry.createEntity();
+  registry.addComponent(entity, createLod());
+  registry.addComponent(entity, createTransform());
+
+  const LodComponent& lod = registry.getComponent<LodComponent>(entity);
+  placeAt(registry, entity, getDistance(400.0f));
+  transforms.update(0.0f);
+  EXPECT_FLOAT_EQ(system.getScreenSize(lod, registry.getComponent<TransformComponent>(entity)),
+                  400.0f);
+  update();
+  EXPECT_EQ(lod.currentLevel, 0);
+
+  placeAt(registry, entity, getDistance(100.0f));
+  update();
+  EXPECT_EQ(lod.currentLevel, 1);
+
+  // Jumps over several levels at once, in both directions.
+  placeAt(registry, entity, getDistance(10.0f));
+  update();
+  EXPECT_EQ(lod.currentLevel, 2);
+  placeAt(registry, entity, getDistance(1000.0f));
+  update();
+  EXPECT_EQ(lod.currentLevel, 0);
+
+  // Scaling the model matrix grows the projected size.
+  placeAt(registry, entity, getDistance(100.0f), 4.0f);
+  update();
+  EXPECT_EQ(lod.currentLevel, 0);
+}
+
+TEST(LodSystemTest, HysteresisKeepsLevelNearThreshold) {
+  Registry registry;
+  TransformSystem transforms(&registry);
+  LodSystem system(&registry);
+  const auto update = [&] {
+    transforms.update(0.0f);
+    system.update(0.0f);
+  };
+  system.setView(glm::vec3(0.0f), PROJECTION, VIEWPORT_HEIGHT);
+  system.setHysteresis(0.1f);
+  const Entity entity = registry.createEntity();
+  registry.addComponent(entity, createLod());
+  registry.addComponent(entity, createTransform());
+  const LodComponent& lod = registry.getComponent<LodComponent>(entity);
+
+  placeAt(registry, entity, getDistance(210.0f));
+  update();
+  EXPECT_EQ(lod.currentLevel, 0);
+  placeAt(registry, entity, getDistance(190.0f));
+  update();
+  EXPECT_EQ(lod.currentLevel, 0);
+  placeAt(registry, entity, getDistance(170.0f));
+  update();
+  EXPECT_EQ(lod.currentLevel, 1);
+  placeAt(registry, entity, getDistance(210.0f));
+  update();
+  EXPECT_EQ(lod.currentLevel, 1);
+  placeAt(registry, entity, getDistance(230.0f));
+  update();
+  EXPECT_EQ(lod.currentLevel, 0);
+}
+
+TEST(LodSystemTest, CullsSmallObjects) {
+  Registry registry;
+  lib::ThreadPool threadPool(2);
+  TransformSystem transforms(&registry);
+  LodSystem system(&registry);
+  const auto update = [&] {
+    transforms.update(0.0f);
+    system.update(0.0f);
+  };
+  system.setThreadPool(&threadPool);
+  system.setView(glm::vec3(0.0f), PROJECTION, VIEWPORT_HEIGHT);
+  system.setCullScreenSize(4.0f);
+
+  // Every fourth entity is far enough to be culled.
+  const std::vector<Entity> entities = registry.createEntities(5000);
+  std::vector<Entity> expected;
+  for (size_t i = 0; i < entities.size(); ++i) {
+    registry.addComponent(entities[i], createLod());
+    registry.addComponent(entities[i], createTransform());
+    placeAt(registry, entities[i], getDistance(i % 4 == 0 ? 2.0f : 8.0f));
+    if (i % 4 != 0) {
+      expected.push_back(entities[i]);
+    }
+  }
+  update();
+  EXPECT_EQ(system.getVisibleEntities(), expected);
+  EXPECT_TRUE(registry.getComponent<LodComponent>(entities[0]).culled);
+  EXPECT_EQ(registry.getComponent<LodComponent>(entities[1]).currentLevel, 2);
+
+  // Culled entities come back only above the band.
+  placeAt(registry, entities[0], getDistance(4.2f));
+  update();
+  EXPECT_TRUE(registry.getComponent<LodComponent>(entities[0]).culled);
+  placeAt(registry, entities[0], getDistance(4.5f));
+  update();
+  EXPECT_FALSE(registry.getComponent<LodComponent>(entities[0]).culled);
+
+  // Only the candidates are processed.
+  const std::vector<Entity> candidates = {entities[8], entities[9]};
+  system.setCandidates(&candidates);
+  update();
+  EXPECT_EQ(system.getVisibleEntities(), std::vector<Entity>{entities[9]});
+}
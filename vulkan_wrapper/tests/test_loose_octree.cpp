@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "common/scene/loose_octree.h"
+
+TEST(LooseOctreeTest, MovesAndRemovesObjects) {
+  LooseOctree octree(AABB{.lowerCorner = glm::vec3(-16.0f), .upperCorner = glm::vec3(16.0f)});
+  std::vector<std::unique_ptr<Object>> objects;
+  for (Entity entity = 0; entity < 2000; ++entity) {
+    objects.push_back(std::make_unique<Object>("object", entity));
+  }
+
+  // Objects straddling the center sink as deep as their size allows.
+  const LooseOctree::Handle straddling =
+      octree.insert(objects[0].get(), AABB{glm::vec3(-0.2f), glm::vec3(0.2f)});
+  const LooseOctree::Handle small =
+      octree.insert(objects[1].get(), AABB{glm::vec3(1.0f), glm::vec3(1.5f)});
+  EXPECT_EQ(octree.getDepth(straddling), 6);
+  EXPECT_EQ(octree.getDepth(small), 6);
+  const size_t nodeCount = octree.getNodeCount();
+
+  // Small moves stay within the loose bounds and don't touch the nodes.
+  octree.update(small, AABB{glm::vec3(1.2f), glm::vec3(1.7f)});
+  EXPECT_EQ(octree.getNodeCount(), nodeCount);
+  octree.update(small, AABB{glm::vec3(-9.0f), glm::vec3(-5.0f)});
+  EXPECT_EQ(octree.getDepth(small), 3);
+  octree.remove(straddling);
+  octree.remove(small);
+  EXPECT_EQ(octree.size(), 0);
+  EXPECT_EQ(octree.getNodeCount(), 1);
+
+  // Queries match a brute force test after random moves.
+  std::mt19937 random(5);
+  std::uniform_real_distribution<float> position(-18.0f, 15.0f);
+  std::uniform_real_distribution<float> size(0.01f, 3.0f);
+  const auto randomVolume = [&] {
+    const glm::vec3 lower(position(random), position(random), position(random));
+    return AABB{lower, lower + size(random)};
+  };
+  std::vector<LooseOctree::Handle> handles;
+  for (const std::unique_ptr<Object>& object : objects) {
+    handles.push_back(octree.insert(object.get(), randomVolume()));
+  }
+  for (int i = 0; i < 5000; ++i) {
+    octree.update(handles[random() % handles.size()], randomVolume());
+  }
+  for (size_t i = 0; i < handles.size(); i += 2) {
+    octree.remove(handles[i]);
+  }
+
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = extractFrustumPlanes(
+      glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 30.0f)
+      * glm::lookAt(glm::vec3(0.0f, 0.0f, -20.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+  std::vector<const Object*> visible;
+  octree.query(planes, visible);
+  std::vector<const Object*> expected;
+  for (size_t i = 1; i < handles.size(); i += 2) {
+    if (octree.getVolume(handles[i]).intersectsFrustum(planes)) {
+      expected.push_back(objects[i].get());
+    }
+  }
+  std::sort(visible.begin(), visible.end());
+  std::sort(expected.begin(), expected.end());
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(visible, expected);
+}
+
+TEST(LooseOctreeTest, KeepsObjectsCenteredOutsideOfTheVolumeInTheRoot) {
+  LooseOctree octree(AABB{.lowerCorner = glm::vec3(-16.0f), .upperCorner = glm::vec3(16.0f)});
+  const Object nearObject("near", 0);
+  const Object farObject("far", 1);
+  // Within the loose bounds of the root, but centered outside of its cell.
+  const LooseOctree::Handle near = octree.insert(
+      &nearObject, AABB{glm::vec3(19.75f, 0.1f, 0.1f), glm::vec3(20.25f, 0.6f, 0.6f)});
+  const LooseOctree::Handle far = octree.insert(
+      &farObject, AABB{glm::vec3(99.75f, 0.1f, 0.1f), glm::vec3(100.25f, 0.6f, 0.6f)});
+  EXPECT_EQ(octree.getDepth(near), 0);
+  EXPECT_EQ(octree.getDepth(far), 0);
+
+  for (const Object* object : {&nearObject, &farObject}) {
+    const float x = object == &nearObject ? 20.0f : 100.0f;
+    const std::array<glm::vec4, NUM_CUBE_FACES> planes = extractFrustumPlanes(
+        glm::perspective(glm::radians(30.0f), 1.0f, 0.1f, 10.0f)
+        * glm::lookAt(glm::vec3(x, 0.35f, -5.0f), glm::vec3(x, 0.35f, 0.35f),
+                      glm::vec3(0.0f, 1.0f, 0.0f)));
+    std::vector<const Object*> visible;
+    octree.query(planes, visible);
+    EXPECT_EQ(visible, std::vector<const Object*>{object});
+  }
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/scene/occlusion_buffer.h"
+
+namespace {
+
+// One character per pixel, '.' for cleared pixels and the tenth of [-1, 1] the depth is in
+// otherwise, so the golden images below stay readable.
+std::string toImage(const OcclusionBuffer& buffer) {
+  std::string image;
+  for (uint32_t y = 0; y < buffer.getHeight(); ++y) {
+    for (uint32_t x = 0; x < buffer.getWidth(); ++x) {
+      const float depth = buffer.getDepth(x, y);
+      image += depth == OcclusionBuffer::CLEAR_DEPTH
+                   ? '.'
+                   : static_cast<char>('0' + std::clamp(int((depth + 1.0f) * 5.0f), 0, 9));
+    }
+    image += '\n';
+  }
+  return image;
+}
+
+// Flips y like the camera does for Vulkan, so the first row is the top of the screen.
+glm::mat4 getViewProjection() {
+  glm::mat4 projection = glm::perspective(glm::radians(90.0f), 2.0f, 1.0f, 20.0f);
+  projection[1][1] = -projection[1][1];
+  return projection
+         * glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 2.0f, -1.0f),
+                       glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+constexpr std::string_view GOLDEN_TRIANGLE =
+  "................................\n"
+  "..000001........................\n"
+  "..111111112222222...............\n"
+  "...12222222222333333333344......\n"
+  "...22222333333333444444444455...\n"
+  "....33333334444444444555555.....\n"
+  "....344444444445555555556.......\n"
+  ".....444555555555566666.........\n"
+  ".....5555555666666666...........\n"
+  ".....56666666667777.............\n"
+  "......66677777777...............\n"
+  "......777777788.................\n"
+  ".......888888...................\n"
+  ".......8889.....................\n"
+  "........9.......................\n"
+  "................................\n";
+
+constexpr std::string_view GOLDEN_SCENE =
+  "................................\n"
+  "................................\n"
+  "................................\n"
+  "................................\n"
+  "................................\n"
+  "................................\n"
+  "..........77777777..............\n"
+  "..........77777777..............\n"
+  "..........77777777..............\n"
+  ".999999999777777779999999999999.\n"
+  "88888888887777777788888888888888\n"
+  "88888888887777777788888888888888\n"
+  "77777777777777777777777777777777\n"
+  "66666666666666666666666666666666\n"
+  "66666666666666666666666666666666\n"
+  "55555555555555555555555555555555\n";
+
+}  // namespace
+
+TEST(OcclusionBufferTest, RasterizesTriangleWithInterpolatedDepth) {
+  OcclusionBuffer buffer(32, 16);
+  const std::vector<glm::vec3> positions = {
+    glm::vec3(-0.9f, -0.9f, -1.0f), glm::vec3(0.9f, -0.5f, 0.0f), glm::vec3(-0.5f, 0.9f, 0.98f)};
+  const std::vector<uint32_t> indices = {0, 1, 2};
+  buffer.renderOccluder(positions, indices, glm::mat4(1.0f));
+
+  EXPECT_EQ(toImage(buffer), GOLDEN_TRIANGLE);
+}
+
+TEST(OcclusionBufferTest, ClipsOccludersAtCameraPlane) {
+  // A floor passing below the camera and a wall behind it, seen through a perspective.
+  OcclusionBuffer buffer(32, 16);
+  const glm::mat4 viewProjection = getViewProjection();
+  buffer.renderBox(AABB{glm::vec3(-3.0f, 0.0f, -5.0f), glm::vec3(1.0f, 3.0f, -4.0f)},
+                   viewProjection);
+  buffer.renderBox(AABB{glm::vec3(-20.0f, -1.0f, -20.0f), glm::vec3(20.0f, 0.0f, 20.0f)},
+                   viewProjection);
+
+  EXPECT_EQ(toImage(buffer), GOLDEN_SCENE);
+}
+
+TEST(OcclusionBufferTest, TestsBoxesAgainstOccluders) {
+  OcclusionBuffer buffer(64, 32);
+  const glm::mat4 viewProjection = getViewProjection();
+  buffer.renderBox(AABB{glm::vec3(-3.0f, 0.0f, -5.0f), glm::vec3(1.0f, 3.0f, -4.0f)},
+                   viewProjection);
+  buffer.updateHierarchy();
+
+  const auto isVisible = [&](glm::vec3 lowerCorner, glm::vec3 upperCorner) {
+    return buffer.isVisible(AABB{lowerCorner, upperCorner}, viewProjection);
+  };
+  // Behind the wall, in front of it, peeking out to its right.
+  EXPECT_FALSE(isVisible(glm::vec3(-1.5f, 1.0f, -12.0f), glm::vec3(-0.5f, 2.0f, -11.0f)));
+  EXPECT_TRUE(isVisible(glm::vec3(-1.5f, 1.0f, -3.5f), glm::vec3(-0.5f, 2.0f, -3.0f)));
+  EXPECT_TRUE(isVisible(glm::vec3(2.5f, 1.0f, -12.0f), glm::vec3(4.0f, 2.0f, -11.0f)));
+  // Crossing the camera plane, behind the camera and off screen.
+  EXPECT_TRUE(isVisible(glm::vec3(-1.0f, 1.0f, -1.0f), glm::vec3(1.0f, 3.0f, 1.0f)));
+  EXPECT_FALSE(isVisible(glm::vec3(-1.0f, 1.0f, 5.0f), glm::vec3(1.0f, 3.0f, 6.0f)));
+  EXPECT_FALSE(isVisible(glm::vec3(30.0f, 1.0f, -6.0f), glm::vec3(31.0f, 3.0f, -5.0f)));
+}
+
+TEST(OcclusionBufferTest, RenderingHiddenBoxesChangesNothing) {
+  OcclusionBuffer buffer(128, 64);
+  const glm::mat4 viewProjection = getViewProjection();
+  for (const AABB& wall : {AABB{glm::vec3(-6.0f, 0.0f, -9.0f), glm::vec3(1.0f, 4.0f, -8.0f)},
+                           AABB{glm::vec3(2.0f, 0.0f, -14.0f), glm::vec3(8.0f, 6.0f, -13.0f)}}) {
+    buffer.renderBox(wall, viewProjection);
+  }
+  buffer.updateHierarchy();
+
+  std::mt19937 random(4);
+  std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> size(0.1f, 2.0f);
+  size_t hiddenCount = 0;
+  for (int i = 0; i < 2000; ++i) {
+    const glm::vec3 lower(position(random), 0.5f * position(random) + 2.0f,
+                          position(random) - 15.0f);
+    const AABB box{lower, lower + size(random)};
+    if (buffer.isVisible(box, viewProjection)) {
+      continue;
+    }
+    ++hiddenCount;
+    OcclusionBuffer withBox = buffer;
+    withBox.renderBox(box, viewProjection);
+    for (uint32_t y = 0; y < buffer.getHeight(); ++y) {
+      for (uint32_t x = 0; x < buffer.getWidth(); ++x) {
+        ASSERT_EQ(withBox.getDepth(x, y), buffer.getDepth(x, y));
+      }
+    }
+  }
+  EXPECT_GT(hiddenCount, 100);
+}
+
+TEST(OcclusionBufferTest, SelectsLargestOccludersOnScreen) {
+  const std::vector<AABB> volumes = {
+    AABB{glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(1.0f, 1.0f, -9.0f)},
+    AABB{glm::vec3(-5.0f, 0.0f, -10.0f), glm::vec3(5.0f, 5.0f, -9.0f)},
+    AABB{glm::vec3(0.0f, 0.0f, -100.0f), glm::vec3(10.0f, 10.0f, -99.0f)},
+    AABB{glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(2.0f, 2.0f, -2.0f)}};
+  std::vector<uint32_t> occluders;
+  selectOccluders(volumes, glm::vec3(0.0f), 2, occluders);
+
+  EXPECT_EQ(occluders, (std::vector<uint32_t>{1, 3}));
+}
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "lib/radix_sort/radix_sort.h"
+#include "lib/thread_pool/thread_pool.h"
+
+TEST(RadixSortTest, SortsByBitRangeStably) {
+  // Keys in the high bits, the original position in the low 20 bits.
+  std::mt19937_64 random(7);
+  std::vector<uint64_t> values(100'000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = ((random() % 5000) << 20) | i;
+  }
+  std::vector<uint64_t> expected = values;
+  std::sort(expected.begin(), expected.end());
+
+  std::vector<uint64_t> scratch(values.size());
+  std::vector<uint64_t> serial = values;
+  lib::radixSort<uint64_t>(serial, scratch, 20);
+  EXPECT_EQ(serial, expected);
+
+  lib::ThreadPool threadPool(3);
+  lib::radixSort<uint64_t>(values, scratch, 20, 64, &threadPool);
+  EXPECT_EQ(values, expected);
+}
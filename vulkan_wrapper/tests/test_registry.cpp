@@ -0,0 +1,357 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/registry.h"
+
+TEST(RegistryTest, ViewTracksStructuralChanges) {
+  Registry registry;
+  const Entity first = registry.createEntity();
+  const Entity second = registry.createEntity();
+  registry.addComponent(first, PositionComponent{.x = 0.0f, .y = 0.0f});
+  registry.addComponent(first, VelocityComponent{.dx = 1.0f, .dy = 1.0f});
+  registry.addComponent(second, PositionComponent{.x = 0.0f, .y = 0.0f});
+
+  EXPECT_EQ((registry.view<PositionComponent, VelocityComponent>().size()), 1);
+
+  registry.addComponent(second, VelocityComponent{.dx = 2.0f, .dy = 2.0f});
+  EXPECT_EQ((registry.view<PositionComponent, VelocityComponent>().size()), 2);
+
+  registry.destroyEntity(first);
+  auto view = registry.view<PositionComponent, VelocityComponent>();
+  ASSERT_EQ(view.size(), 1);
+  EXPECT_EQ(*view.begin(), second);
+}
+
+TEST(RegistryTest, UpdateComponentsVisitsMatchingEntities) {
+  Registry registry;
+  for (int i = 0; i < 10; ++i) {
+    const Entity entity = registry.createEntity();
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+    if (i % 2 == 0) {
+      registry.addComponent(entity, VelocityComponent{.dx = 1.0f, .dy = 0.0f});
+    }
+  }
+
+  registry.updateComponents<PositionComponent, VelocityComponent>(
+      [](PositionComponent& position, const VelocityComponent& velocity) {
+        position.x += velocity.dx;
+      });
+
+  float sum = 0.0f;
+  registry.updateComponents<PositionComponent>([&sum](Entity, const PositionComponent& position) {
+    sum += position.x;
+  });
+  EXPECT_EQ(sum, 5.0f);
+}
+
+TEST(RegistryTest, CopiesLvalueComponents) {
+  Registry registry;
+  const Entity entity = registry.createEntity();
+  const PositionComponent position{.x = 1.0f, .y = 2.0f};
+  registry.addComponent(entity, position);
+  VelocityComponent velocity{.dx = 3.0f, .dy = 4.0f};
+  registry.addComponent(entity, velocity);
+  velocity.dx = 5.0f;
+  registry.addComponent(entity, velocity);
+
+  EXPECT_EQ(registry.getComponent<PositionComponent>(entity).y, 2.0f);
+  EXPECT_EQ(registry.getComponent<VelocityComponent>(entity).dx, 5.0f);
+}
+
+TEST(RegistryTest, DetectsStaleHandles) {
+  Registry registry;
+  const Entity entity = registry.createEntity();
+  registry.addComponent(entity, PositionComponent{.x = 1.0f, .y = 0.0f});
+  registry.destroyEntity(entity);
+
+  const Entity recycled = registry.createEntity();
+  registry.addComponent(recycled, PositionComponent{.x = 2.0f, .y = 0.0f});
+
+  EXPECT_EQ(getEntityIndex(recycled), getEntityIndex(entity));
+  EXPECT_FALSE(registry.isAlive(entity));
+  EXPECT_EQ(registry.tryGetComponent<PositionComponent>(entity), nullptr);
+  ASSERT_NE(registry.tryGetComponent<PositionComponent>(recycled), nullptr);
+  EXPECT_EQ(registry.getComponent<PositionComponent>(recycled).x, 2.0f);
+  EXPECT_FALSE(registry.findComponent<PositionComponent>(entity));
+  EXPECT_FALSE(registry.findComponent<VelocityComponent>(recycled));
+  ASSERT_TRUE(registry.findComponent<PositionComponent>(recycled));
+  EXPECT_EQ(registry.findComponent<PositionComponent>(recycled)->get().x, 2.0f);
+
+  registry.destroyEntity(entity);
+  EXPECT_TRUE(registry.isAlive(recycled));
+}
+
+TEST(RegistryTest, PlaysBackCommandBuffers) {
+  Registry registry;
+  const Entity existing = registry.createEntity();
+  registry.addComponent(existing, PositionComponent{.x = 0.0f, .y = 0.0f});
+  registry.addComponent(existing, VelocityComponent{.dx = 1.0f, .dy = 0.0f});
+  EXPECT_EQ((registry.view<PositionComponent, VelocityComponent>().size()), 1);
+
+  RegistryCommandBuffer first;
+  RegistryCommandBuffer second;
+  registry.updateComponents<PositionComponent>([&first](Entity entity, PositionComponent&) {
+    const DeferredEntity spawned = first.createEntity();
+    first.addComponent(spawned, PositionComponent{.x = 5.0f, .y = 0.0f});
+    first.addComponent(spawned, VelocityComponent{.dx = 2.0f, .dy = 0.0f});
+    first.removeComponent<VelocityComponent>(entity);
+  });
+  const DeferredEntity discarded = second.createEntity();
+  second.addComponent(discarded, PositionComponent{.x = 7.0f, .y = 0.0f});
+  second.destroyEntity(discarded);
+
+  RegistryCommandBuffer* buffers[] = {&first, &second};
+  registry.playback(buffers);
+
+  ASSERT_EQ(first.getCreatedEntities().size(), 1);
+  const Entity spawned = first.getCreatedEntities()[0];
+  EXPECT_FALSE(registry.hasComponent<VelocityComponent>(existing));
+  EXPECT_EQ(registry.getComponent<PositionComponent>(spawned).x, 5.0f);
+  EXPECT_FALSE(registry.isAlive(second.getCreatedEntities()[0]));
+
+  auto view = registry.view<PositionComponent, VelocityComponent>();
+  ASSERT_EQ(view.size(), 1);
+  EXPECT_EQ(*view.begin(), spawned);
+  EXPECT_TRUE(first.empty());
+}
+
+TEST(RegistryTest, PlaysBackCommandsOfAnEntityInRecordingOrder) {
+  Registry registry;
+  const Entity entity = registry.createEntity();
+  registry.addComponent(entity, PositionComponent{.x = 1.0f, .y = 0.0f});
+  const Entity removed = registry.createEntity();
+
+  RegistryCommandBuffer commandBuffer;
+  commandBuffer.removeComponent<PositionComponent>(entity);
+  commandBuffer.addComponent(entity, PositionComponent{.x = 2.0f, .y = 0.0f});
+  commandBuffer.addComponent(removed, PositionComponent{.x = 3.0f, .y = 0.0f});
+  commandBuffer.removeComponent<PositionComponent>(removed);
+  RegistryCommandBuffer* buffers[] = {&commandBuffer};
+  registry.playback(buffers);
+
+  ASSERT_TRUE(registry.hasComponent<PositionComponent>(entity));
+  EXPECT_EQ(registry.getComponent<PositionComponent>(entity).x, 2.0f);
+  EXPECT_FALSE(registry.hasComponent<PositionComponent>(removed));
+  EXPECT_EQ(registry.view<PositionComponent>().size(), 1);
+}
+
+TEST(RegistryTest, TracksComponentChanges) {
+  Registry registry;
+  const Entity moving = registry.createEntity();
+  const Entity idle = registry.createEntity();
+  for (Entity entity : {moving, idle}) {
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = 0.0f});
+    registry.addComponent(entity, VelocityComponent{.dx = 0.0f, .dy = 0.0f});
+  }
+  registry.advanceTick();
+  const uint32_t since = registry.getTick();
+
+  const auto collect = [&registry](auto filter) {
+    std::vector<Entity> entities;
+    registry.view<const PositionComponent, const VelocityComponent>().each(
+        filter, [&entities](Entity entity, const PositionComponent&, const VelocityComponent&) {
+          entities.push_back(entity);
+        });
+    return entities;
+  };
+  EXPECT_TRUE(collect(Changed<PositionComponent>{since}).empty());
+
+  registry.patch<PositionComponent>(moving, [](PositionComponent& position) {
+    position.x = 1.0f;
+  });
+  EXPECT_EQ(collect(Changed<PositionComponent>{since}), std::vector<Entity>{moving});
+  EXPECT_TRUE(collect(Changed<VelocityComponent>{since}).empty());
+
+  registry.advanceTick();
+  registry.view<PositionComponent, const VelocityComponent>().each(
+      [](PositionComponent&, const VelocityComponent&) {});
+  EXPECT_EQ(collect(Changed<PositionComponent>{registry.getTick()}).size(), 2);
+  EXPECT_TRUE(collect(Added<PositionComponent>{since}).empty());
+}
+
+TEST(RegistryTest, SpawnsEntitiesInBulk) {
+  Registry registry;
+  const Entity reused = registry.createEntity();
+  registry.destroyEntity(reused);
+  const auto positions = registry.view<PositionComponent, VelocityComponent>();
+
+  const std::vector<Entity> entities = registry.createEntities(3);
+  EXPECT_EQ(getEntityIndex(entities[0]), getEntityIndex(reused));
+  const std::vector<PositionComponent> components = {
+    {.x = 0.0f, .y = 0.0f}, {.x = 1.0f, .y = 0.0f}, {.x = 2.0f, .y = 0.0f}};
+  registry.addComponents<PositionComponent>(entities, components);
+  registry.addComponent(entities[1], VelocityComponent{.dx = 1.0f, .dy = 0.0f});
+  EXPECT_EQ(registry.getComponent<PositionComponent>(entities[2]).x, 2.0f);
+  EXPECT_EQ(positions.size(), 1);
+
+  const ErrorOr<std::vector<Entity>> clones = registry.instantiate(entities[1], 100);
+  ASSERT_TRUE(clones);
+  for (Entity clone : *clones) {
+    EXPECT_EQ(registry.getComponent<PositionComponent>(clone).x, 1.0f);
+    EXPECT_TRUE(registry.hasComponent<VelocityComponent>(clone));
+  }
+  EXPECT_EQ(positions.size(), 101);
+}
+
+TEST(RegistryTest, RejectsPrefabsWhichCannotBeCopied) {
+  ComponentPoolImpl<std::unique_ptr<int>> moveOnlyPool;
+  EXPECT_FALSE(moveOnlyPool.isCopyable());
+  moveOnlyPool.addComponent(0, std::make_unique<int>(1), 1);
+  const Entity targets[] = {1, 2};
+  moveOnlyPool.cloneComponent(0, targets, 1);
+  EXPECT_EQ(moveOnlyPool.size(), 1);
+  EXPECT_TRUE(ComponentPoolImpl<PositionComponent>().isCopyable());
+
+  Registry registry;
+  const Entity prefab = registry.createEntity();
+  registry.addComponent(prefab, PositionComponent{.x = 1.0f, .y = 0.0f});
+  registry.destroyEntity(prefab);
+  EXPECT_FALSE(registry.instantiate(prefab, 10));
+  EXPECT_EQ(registry.view<PositionComponent>().size(), 0);
+  EXPECT_EQ(getEntityIndex(registry.createEntity()), getEntityIndex(prefab));
+}
+
+TEST(RegistryTest, GroupKeepsOwnedPoolsPacked) {
+  Registry registry;
+  std::vector<Entity> entities = registry.createEntities(8);
+  for (size_t i = 0; i < entities.size(); ++i) {
+    registry.addComponent(entities[i], PositionComponent{.x = float(i), .y = 0.0f});
+    if (i % 2 == 0) {
+      registry.addComponent(entities[i], VelocityComponent{.dx = float(i), .dy = 0.0f});
+    }
+  }
+  const auto group = registry.group<PositionComponent, const VelocityComponent>();
+  ASSERT_TRUE(group);
+  EXPECT_TRUE((registry.group<PositionComponent, const VelocityComponent>()));
+  EXPECT_FALSE(registry.group<VelocityComponent>());
+  const auto expectPacked = [&group](size_t size) {
+    ASSERT_EQ(group->size(), size);
+    size_t visited = 0;
+    group->each([&visited](Entity, PositionComponent& position, const VelocityComponent& velocity) {
+      EXPECT_EQ(position.x, velocity.dx);
+      ++visited;
+    });
+    EXPECT_EQ(visited, size);
+  };
+  expectPacked(4);
+
+  registry.addComponent(entities[1], VelocityComponent{.dx = 1.0f, .dy = 0.0f});
+  expectPacked(5);
+  registry.removeComponent<VelocityComponent>(entities[0]);
+  expectPacked(4);
+  registry.destroyEntity(entities[2]);
+  expectPacked(3);
+  ASSERT_TRUE(registry.instantiate(entities[4], 2));
+  expectPacked(5);
+  EXPECT_EQ(registry.getComponent<PositionComponent>(entities[6]).x, 6.0f);
+}
+
+TEST(RegistryTest, RestoresSerializedSnapshots) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "bejzak_registry_snapshot.bin").string();
+  Registry source;
+  std::vector<Entity> entities = source.createEntities(100);
+  for (size_t i = 0; i < entities.size(); ++i) {
+    source.addComponent(entities[i], PositionComponent{.x = float(i), .y = 1.0f});
+    if (i % 3 == 0) {
+      source.addComponent(entities[i], VelocityComponent{.dx = float(i), .dy = 0.0f});
+    }
+  }
+  source.destroyEntity(entities[10]);
+  ASSERT_TRUE(source.serialize(path));
+
+  Registry restored;
+  const Entity discarded = restored.createEntity();
+  restored.addComponent(discarded, PositionComponent{.x = -1.0f, .y = 0.0f});
+  const auto view = restored.view<PositionComponent, VelocityComponent>();
+  const auto group = restored.group<PositionComponent, const VelocityComponent>();
+  ASSERT_TRUE(group);
+  ASSERT_TRUE((restored.deserialize<PositionComponent, VelocityComponent>(path)));
+
+  EXPECT_EQ(view.size(), 34);
+  EXPECT_EQ(group->size(), 34);
+  EXPECT_FALSE(restored.isAlive(entities[10]));
+  EXPECT_EQ(restored.getComponent<PositionComponent>(entities[99]).x, 99.0f);
+  EXPECT_EQ(restored.getComponent<VelocityComponent>(entities[99]).dx, 99.0f);
+  EXPECT_FALSE(restored.hasComponent<VelocityComponent>(entities[98]));
+  EXPECT_EQ(getEntityIndex(restored.createEntity()), getEntityIndex(entities[10]));
+
+  // Only Position is requested, Velocity pools are dropped.
+  Registry partial;
+  ASSERT_TRUE(partial.deserialize<PositionComponent>(path));
+  EXPECT_TRUE(partial.hasComponent<PositionComponent>(entities[0]));
+  EXPECT_FALSE(partial.hasComponent<VelocityComponent>(entities[0]));
+
+  // Views of pools which are not restored only lose the entities which are not alive anymore.
+  Registry kept;
+  const std::vector<Entity> keptEntities = kept.createEntities(150);
+  kept.addComponent(keptEntities[1], VelocityComponent{.dx = 1.0f, .dy = 0.0f});
+  kept.addComponent(keptEntities[120], VelocityComponent{.dx = 2.0f, .dy = 0.0f});
+  const auto velocities = kept.view<const VelocityComponent>();
+  ASSERT_TRUE(kept.deserialize<PositionComponent>(path));
+  EXPECT_EQ(velocities.getEntities().size(), 1);
+  EXPECT_EQ(velocities.getEntities().front(), keptEntities[1]);
+  EXPECT_EQ((kept.view<const PositionComponent, const VelocityComponent>().size()), 1);
+
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "not a snapshot";
+  }
+  EXPECT_FALSE(restored.deserialize<PositionComponent>(path));
+  EXPECT_EQ(view.size(), 34);
+  std::filesystem::remove(path);
+}
+
+TEST(RegistryTest, RejectsMalformedSnapshots) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "bejzak_malformed_snapshot.bin").string();
+  Registry source;
+  const std::vector<Entity> entities = source.createEntities(4);
+  for (Entity entity : entities) {
+    source.addComponent(entity, PositionComponent{.x = 1.0f, .y = 0.0f});
+  }
+  source.destroyEntity(entities[1]);
+  ASSERT_TRUE(source.serialize(path));
+  std::vector<std::byte> data(std::filesystem::file_size(path));
+  std::ifstream(path, std::ios::binary).read(reinterpret_cast<char*>(data.data()), data.size());
+  std::filesystem::remove(path);
+
+  Registry registry;
+  const Entity kept = registry.createEntity();
+  const Entity dropped = registry.createEntity();
+  registry.addComponent(kept, PositionComponent{.x = 5.0f, .y = 0.0f});
+  for (Entity entity : {kept, dropped}) {
+    registry.addComponent(entity, VelocityComponent{.dx = 2.0f, .dy = 0.0f});
+  }
+
+  // The header holds magic, version, slot count, free list and alive count, the four slots start
+  // at 32 and the pool header at 48, followed by the packed entities.
+  const auto corrupt = [&data](size_t offset, uint32_t value) {
+    std::vector<std::byte> copy = data;
+    std::memcpy(copy.data() + offset, &value, sizeof(value));
+    return copy;
+  };
+  EXPECT_FALSE(registry.deserialize<PositionComponent>(corrupt(12, 0)));
+  EXPECT_FALSE(registry.deserialize<PositionComponent>(corrupt(16, 4)));
+  EXPECT_FALSE(registry.deserialize<PositionComponent>(corrupt(48, MAX_COMPONENTS)));
+  EXPECT_FALSE(registry.deserialize<PositionComponent>(corrupt(68, entities[0])));
+  std::vector<std::byte> shifted(data.size() + 1);
+  std::memcpy(shifted.data() + 1, data.data(), data.size());
+  EXPECT_FALSE(registry.deserialize<PositionComponent>(std::span(shifted).subspan(1)));
+  EXPECT_EQ(registry.getComponent<PositionComponent>(kept).x, 5.0f);
+  EXPECT_TRUE(registry.isAlive(dropped));
+
+  // Velocity is not restored and stays on entities alive in the snapshot.
+  ASSERT_TRUE(registry.deserialize<PositionComponent>(data));
+  EXPECT_EQ(registry.getComponent<PositionComponent>(kept).x, 1.0f);
+  EXPECT_EQ(registry.getComponent<VelocityComponent>(kept).dx, 2.0f);
+  EXPECT_FALSE(registry.isAlive(dropped));
+  EXPECT_EQ(registry.view<VelocityComponent>().size(), 1);
+  EXPECT_EQ((registry.view<PositionComponent, VelocityComponent>().size()), 1);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "common/scene/scene.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+const AABB SCENE_VOLUME{.lowerCorner = glm::vec3(-100.0f), .upperCorner = glm::vec3(100.0f)};
+
+struct RandomScene {
+  std::vector<std::unique_ptr<Object>> objects;
+  std::vector<LinearOctree::Entry> entries;
+};
+
+// 20000 small boxes scattered over SCENE_VOLUME.
+RandomScene createRandomScene(uint32_t seed) {
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> position(-99.0f, 95.0f);
+  std::uniform_real_distribution<float> size(0.1f, 4.0f);
+  RandomScene scene;
+  for (Entity entity = 0; entity < 20000; ++entity) {
+    scene.objects.push_back(std::make_unique<Object>("object", entity));
+    const glm::vec3 lower(position(random), position(random), position(random));
+    scene.entries.push_back({scene.objects.back().get(), AABB{lower, lower + size(random)}});
+  }
+  return scene;
+}
+
+}  // namespace
+
+TEST(SceneTest, ParallelCullingMatchesSerialCulling) {
+  const RandomScene randomScene = createRandomScene(9);
+  const std::array<glm::vec4, NUM_CUBE_FACES> planes = extractFrustumPlanes(
+      glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 150.0f)
+      * glm::lookAt(glm::vec3(0.0f, 10.0f, -90.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+  Scene serialScene(SCENE_VOLUME);
+  serialScene.build(randomScene.entries);
+  std::vector<const Object*> serialVisible;
+  serialScene.cull(planes, serialVisible);
+
+  lib::ThreadPool threadPool(3);
+  Scene parallelScene(SCENE_VOLUME);
+  parallelScene.setThreadPool(&threadPool);
+  parallelScene.build(randomScene.entries);
+  std::vector<const Object*> parallelVisible;
+  parallelScene.cull(planes, parallelVisible);
+  EXPECT_GT(serialVisible.size(), 1000);
+  EXPECT_LT(serialVisible.size(), randomScene.entries.size());
+
+  // Culling is conservative and accepting inside nodes does not lose objects.
+  std::sort(serialVisible.begin(), serialVisible.end());
+  std::sort(parallelVisible.begin(), parallelVisible.end());
+  EXPECT_EQ(serialVisible, parallelVisible);
+  for (const LinearOctree::Entry& entry : randomScene.entries) {
+    if (entry.volume.intersectsFrustum(planes)) {
+      EXPECT_TRUE(
+          std::binary_search(serialVisible.cbegin(), serialVisible.cend(), entry.object));
+    }
+  }
+}
+
+TEST(SceneTest, CullsSeveralViewsInOneTraversal) {
+  const RandomScene randomScene = createRandomScene(4);
+  // Two eyes, a shadow cascade, a camera looking the other way and a view containing the half of
+  // the scene with x > 0, whose subtrees start with that view inside.
+  const auto perspectiveFrom = [](const glm::vec3& eye) {
+    return extractFrustumPlanes(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 150.0f)
+                                * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+  };
+  const std::vector<Frustum> frustums = {
+    perspectiveFrom(glm::vec3(-1.0f, 0.0f, -90.0f)), perspectiveFrom(glm::vec3(1.0f, 0.0f, -90.0f)),
+    extractFrustumPlanes(glm::ortho(-40.0f, 40.0f, -40.0f, 40.0f, 0.0f, 200.0f)
+                         * glm::lookAt(glm::vec3(0.0f, 100.0f, 0.0f), glm::vec3(0.0f),
+                                       glm::vec3(0.0f, 0.0f, 1.0f))),
+    perspectiveFrom(glm::vec3(0.0f, 0.0f, 90.0f)),
+    extractFrustumPlanes(glm::ortho(-110.0f, 0.0f, -110.0f, 110.0f, 0.0f, 220.0f)
+                         * glm::lookAt(glm::vec3(0.0f, 110.0f, 0.0f), glm::vec3(0.0f),
+                                       glm::vec3(0.0f, 0.0f, 1.0f)))};
+
+  lib::ThreadPool threadPool(3);
+  Scene scene(SCENE_VOLUME);
+  scene.build(randomScene.entries);
+  std::vector<VisibleObject> serialVisible;
+  scene.cullViews(frustums, serialVisible);
+  scene.setThreadPool(&threadPool);
+  std::vector<VisibleObject> parallelVisible;
+  scene.cullViews(frustums, parallelVisible);
+
+  for (const std::vector<VisibleObject>* visible : {&serialVisible, &parallelVisible}) {
+    std::vector<const Object*> objects;
+    for (const VisibleObject& object : *visible) {
+      objects.push_back(object.object);
+    }
+    std::sort(objects.begin(), objects.end());
+    EXPECT_EQ(std::adjacent_find(objects.cbegin(), objects.cend()), objects.cend());
+    for (size_t view = 0; view < frustums.size(); ++view) {
+      std::vector<const Object*> expected;
+      scene.cull(frustums[view], expected);
+      std::vector<const Object*> viewObjects;
+      for (const VisibleObject& object : *visible) {
+        if (object.viewMask & (1u << view)) {
+          viewObjects.push_back(object.object);
+        }
+      }
+      std::sort(expected.begin(), expected.end());
+      std::sort(viewObjects.begin(), viewObjects.end());
+      EXPECT_FALSE(expected.empty());
+      EXPECT_EQ(viewObjects, expected);
+    }
+  }
+}
+
+TEST(SceneTest, CullsSingleViewLikeCull) {
+  const RandomScene randomScene = createRandomScene(5);
+  const std::vector<Frustum> frustums = {extractFrustumPlanes(
+      glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 150.0f)
+      * glm::lookAt(glm::vec3(0.0f, 0.0f, -90.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)))};
+
+  Scene scene(SCENE_VOLUME);
+  scene.build(randomScene.entries);
+  std::vector<VisibleObject> visible;
+  scene.cullViews(frustums, visible);
+  std::vector<const Object*> expected;
+  scene.cull(frustums.front(), expected);
+
+  ASSERT_EQ(visible.size(), expected.size());
+  for (size_t i = 0; i < visible.size(); ++i) {
+    EXPECT_EQ(visible[i].object, expected[i]);
+    EXPECT_EQ(visible[i].viewMask, 1u);
+  }
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <vector>
+
+#include "common/entity_component_system/component/hierarchy.h"
+#include "common/entity_component_system/component/position.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/entity_component_system/component/velocity.h"
+#include "common/entity_component_system/registry/registry.h"
+#include "common/entity_component_system/system/movement_system.h"
+#include "common/entity_component_system/system/scheduler.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+// Reads components which were never added, their pools are created by the Scheduler.
+class HierarchyReaderSystem : public System {
+  Registry* _registry;
+
+public:
+  bool hadPools = false;
+  size_t visited = 0;
+
+  explicit HierarchyReaderSystem(Registry* registry) : _registry(registry) {}
+
+  void update(float) override {
+    hadPools = _registry->hasPool(getComponentID<HierarchyComponent>())
+               && _registry->hasPool(getComponentID<TransformComponent>());
+    visited += _registry->view<const HierarchyComponent, const TransformComponent>().size();
+  }
+
+  SystemAccess getAccess() const override {
+    return SystemAccess{.reads = getSignature<HierarchyComponent, TransformComponent>(),
+                        .writes = Signature(),
+                        .exclusive = false};
+  }
+};
+
+class AccelerationSystem : public System {
+  Registry* _registry;
+
+public:
+  explicit AccelerationSystem(Registry* registry) : _registry(registry) {}
+
+  void update(float deltaTime) override {
+    _registry->updateComponents<VelocityComponent>([deltaTime](VelocityComponent& velocity) {
+      velocity.dx += deltaTime;
+    });
+  }
+
+  SystemAccess getAccess() const override {
+    return SystemAccess{
+        .reads = Signature(), .writes = getSignature<VelocityComponent>(), .exclusive = false};
+  }
+};
+
+// Checks that every velocity still belongs to its entity, see populate().
+class VelocityReaderSystem : public System {
+  Registry* _registry;
+
+public:
+  size_t mismatches = 0;
+
+  explicit VelocityReaderSystem(Registry* registry) : _registry(registry) {}
+
+  void update(float) override {
+    _registry->view<const VelocityComponent>().each(
+        [this](Entity entity, const VelocityComponent& velocity) {
+          mismatches += velocity.dx != float(getEntityIndex(entity));
+        });
+  }
+
+  SystemAccess getAccess() const override {
+    return SystemAccess{
+        .reads = getSignature<VelocityComponent>(), .writes = Signature(), .exclusive = false};
+  }
+};
+
+std::vector<Entity> populate(Registry& registry) {
+  std::vector<Entity> entities;
+  for (size_t i = 0; i < 5000; ++i) {
+    const Entity entity = entities.emplace_back(registry.createEntity());
+    registry.addComponent(entity, PositionComponent{.x = 0.0f, .y = float(i)});
+    registry.addComponent(entity, VelocityComponent{.dx = float(i), .dy = 1.0f});
+  }
+  return entities;
+}
+
+}  // namespace
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+  lib::ThreadPool threadPool(3);
+  std::vector<int> visits(10'000, 0);
+  threadPool.parallelFor(visits.size(), 64, [&visits](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      ++visits[i];
+    }
+  });
+  EXPECT_EQ(std::accumulate(visits.cbegin(), visits.cend(), 0), visits.size());
+  EXPECT_TRUE(std::all_of(visits.cbegin(), visits.cend(), [](int count) {
+    return count == 1;
+  }));
+}
+
+TEST(SchedulerTest, ConflictingSystemsRunInRegistrationOrder) {
+  Registry sequentialRegistry;
+  const std::vector<Entity> entities = populate(sequentialRegistry);
+  AccelerationSystem sequentialAcceleration(&sequentialRegistry);
+  MovementSystem sequentialMovement(&sequentialRegistry);
+
+  Registry parallelRegistry;
+  populate(parallelRegistry);
+  AccelerationSystem parallelAcceleration(&parallelRegistry);
+  MovementSystem parallelMovement(&parallelRegistry);
+  lib::ThreadPool threadPool(3);
+  Scheduler scheduler(threadPool, &parallelRegistry);
+  scheduler.addSystem(&parallelAcceleration);
+  scheduler.addSystem(&parallelMovement);
+
+  for (int frame = 0; frame < 10; ++frame) {
+    sequentialAcceleration.update(0.5f);
+    sequentialMovement.update(0.5f);
+    scheduler.update(0.5f);
+  }
+
+  for (Entity entity : entities) {
+    EXPECT_EQ(sequentialRegistry.getComponent<PositionComponent>(entity).x,
+              parallelRegistry.getComponent<PositionComponent>(entity).x);
+  }
+}
+
+TEST(SchedulerTest, DetectsConflicts) {
+  const SystemAccess movement{.reads = getSignature<VelocityComponent>(),
+                              .writes = getSignature<PositionComponent>(),
+                              .exclusive = false};
+  const SystemAccess velocityReader{.reads = getSignature<VelocityComponent>(),
+                                    .writes = getSignature<TransformComponent>(),
+                                    .exclusive = false};
+  const SystemAccess positionReader{
+      .reads = getSignature<PositionComponent>(), .writes = Signature(), .exclusive = false};
+
+  EXPECT_FALSE(movement.conflictsWith(velocityReader));
+  EXPECT_TRUE(movement.conflictsWith(positionReader));
+  EXPECT_TRUE(movement.conflictsWith(SystemAccess{}));
+}
+
+TEST(SchedulerTest, CreatesDeclaredPoolsBeforeDispatch) {
+  Registry registry;
+  populate(registry);
+  lib::ThreadPool threadPool(3);
+  Scheduler scheduler(threadPool, &registry);
+  HierarchyReaderSystem reader(&registry);
+  MovementSystem movement(&registry);
+  scheduler.addSystem(&reader);
+  scheduler.addSystem(&movement);
+  EXPECT_FALSE(registry.hasPool(getComponentID<HierarchyComponent>()));
+
+  scheduler.update(0.5f);
+  EXPECT_TRUE(reader.hadPools);
+  EXPECT_EQ(reader.visited, 0);
+}
+
+TEST(SchedulerTest, MovementRunsNextToVelocityReaders) {
+  Registry registry;
+  populate(registry);
+  // Entities without a position leave holes in the velocity pool, which the group has to close.
+  for (size_t i = 0; i < 1000; ++i) {
+    const Entity entity = registry.createEntity();
+    registry.addComponent(
+        entity, VelocityComponent{.dx = float(getEntityIndex(entity)), .dy = 0.0f});
+  }
+  std::vector<Entity> interleaved;
+  for (size_t i = 0; i < 1000; ++i) {
+    const Entity entity = registry.createEntity();
+    registry.addComponent(
+        entity, VelocityComponent{.dx = float(getEntityIndex(entity)), .dy = 0.0f});
+    if (i % 2 == 0) {
+      registry.addComponent(entity, PositionComponent{});
+    }
+  }
+
+  lib::ThreadPool threadPool(3);
+  Scheduler scheduler(threadPool, &registry);
+  VelocityReaderSystem reader(&registry);
+  MovementSystem movement(&registry);
+  scheduler.addSystem(&reader);
+  scheduler.addSystem(&movement);
+
+  // The constructor sorted the pools into the group already, running the systems only reads it.
+  EXPECT_FALSE((registry.group<const VelocityComponent, TransformComponent>()));
+  for (int frame = 0; frame < 10; ++frame) {
+    scheduler.update(0.5f);
+  }
+  EXPECT_EQ(reader.mismatches, 0);
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "lib/simd/kernels.h"
+
+TEST(SimdKernelsTest, EveryLevelMatchesScalarKernels) {
+  // Odd sizes exercise the scalar tails of the vector loops.
+  constexpr size_t count = 37;
+  std::vector<float> x(count);
+  std::vector<float> y(count);
+  for (size_t i = 0; i < count; ++i) {
+    x[i] = static_cast<float>(i) * 0.5f - 4.0f;
+    y[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+
+  const lib::SimdLevel supported = lib::getSupportedSimdLevel();
+  for (lib::SimdLevel level : {lib::SimdLevel::SCALAR, lib::SimdLevel::SSE,
+                               lib::SimdLevel::AVX2, lib::SimdLevel::NEON}) {
+    if (!lib::setSimdLevel(level)) {
+      continue;
+    }
+    std::vector<float> result = y;
+    lib::axpy(result.data(), x.data(), 2.0f, count);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_FLOAT_EQ(result[i], y[i] + 2.0f * x[i]);
+    }
+    lib::clamp(result.data(), -1.0f, 1.0f, count);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_FLOAT_EQ(result[i], std::clamp(y[i] + 2.0f * x[i], -1.0f, 1.0f));
+    }
+    result = x;
+    lib::damp(result.data(), 3.0f, 1.0f, count);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_FLOAT_EQ(result[i], x[i] * 0.25f);
+    }
+  }
+  EXPECT_FALSE(lib::setSimdLevel(supported == lib::SimdLevel::NEON ? lib::SimdLevel::AVX2
+                                                                   : lib::SimdLevel::NEON));
+  EXPECT_TRUE(lib::setSimdLevel(supported));
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "lib/sparse_set/sparse_set.h"
+
+TEST(SparseSetTest, InsertEraseContains) {
+  lib::SparseSet<uint32_t, 16> set;
+  set.insert(3);
+  set.insert(100);
+  set.insert(17);
+
+  EXPECT_TRUE(set.contains(100));
+  EXPECT_FALSE(set.contains(4));
+  EXPECT_FALSE(set.contains(1'000'000));
+  EXPECT_EQ(set.index(17), 2);
+
+  EXPECT_EQ(set.erase(3), 0);
+  EXPECT_FALSE(set.contains(3));
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_EQ(set[0], 17);
+  EXPECT_EQ(set.index(17), 0);
+}
+
+TEST(SparseSetTest, AssignReplacesValues) {
+  lib::SparseSet<uint32_t, 16> set;
+  set.insert(5);
+  set.insert(40);
+  const uint32_t values[] = {40, 3, 100, 17, 18};
+  set.assign(values);
+
+  EXPECT_EQ(set.size(), 5);
+  EXPECT_FALSE(set.contains(5));
+  for (size_t i = 0; i < std::size(values); ++i) {
+    EXPECT_TRUE(set.contains(values[i]));
+    EXPECT_EQ(set.index(values[i]), i);
+  }
+  EXPECT_EQ(set.erase(3), 1);
+  EXPECT_EQ(set.index(18), 1);
+}
+
+TEST(SparseSetTest, SwapKeepsIndicesConsistent) {
+  lib::SparseSet<uint16_t> set;
+  for (uint16_t value = 0; value < 10; ++value) {
+    set.insert(value * 7);
+  }
+  set.swap(0, 63);
+
+  EXPECT_EQ(set[0], 63);
+  EXPECT_EQ(set[9], 0);
+  EXPECT_EQ(set.index(63), 0);
+  EXPECT_EQ(set.index(0), 9);
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.contains(63));
+}
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "common/scene/spatial_hash_grid.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+struct GridObjects {
+  std::vector<std::unique_ptr<Object>> objects;
+  std::vector<AABB> volumes;
+  std::vector<SpatialHashGrid::Handle> handles;
+  std::vector<bool> inserted;
+};
+
+AABB createVolume(std::mt19937& random) {
+  std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+  std::uniform_real_distribution<float> size(0.1f, 6.0f);
+  const glm::vec3 lower(position(random), position(random), position(random));
+  return AABB{lower, lower + glm::vec3(size(random), size(random), size(random))};
+}
+
+std::vector<const Object*> queryAll(const GridObjects& scene, const AABB& volume) {
+  std::vector<const Object*> objects;
+  for (size_t i = 0; i < scene.objects.size(); ++i) {
+    if (scene.inserted[i]
+        && glm::all(glm::lessThanEqual(scene.volumes[i].lowerCorner, volume.upperCorner))
+        && glm::all(glm::greaterThanEqual(scene.volumes[i].upperCorner, volume.lowerCorner))) {
+      objects.push_back(scene.objects[i].get());
+    }
+  }
+  std::sort(objects.begin(), objects.end());
+  return objects;
+}
+
+std::vector<const Object*> queryAllRadius(
+    const GridObjects& scene, const glm::vec3& center, float radius) {
+  std::vector<const Object*> objects;
+  for (size_t i = 0; i < scene.objects.size(); ++i) {
+    const glm::vec3 closest =
+        glm::clamp(center, scene.volumes[i].lowerCorner, scene.volumes[i].upperCorner);
+    if (scene.inserted[i] && glm::dot(closest - center, closest - center) <= radius * radius) {
+      objects.push_back(scene.objects[i].get());
+    }
+  }
+  std::sort(objects.begin(), objects.end());
+  return objects;
+}
+
+std::vector<const Object*> sorted(std::vector<const Object*> objects) {
+  std::sort(objects.begin(), objects.end());
+  return objects;
+}
+
+GridObjects createGridObjects(SpatialHashGrid& grid, size_t count, std::mt19937& random) {
+  GridObjects scene;
+  for (size_t i = 0; i < count; ++i) {
+    scene.objects.push_back(std::make_unique<Object>("object", static_cast<Entity>(i)));
+    scene.volumes.push_back(createVolume(random));
+    scene.handles.push_back(grid.insert(scene.objects.back().get(), scene.volumes.back()));
+    scene.inserted.push_back(true);
+  }
+  return scene;
+}
+
+void expectQueriesMatch(const SpatialHashGrid& grid, const GridObjects& scene,
+                        std::mt19937& random) {
+  for (int i = 0; i < 100; ++i) {
+    const AABB volume = createVolume(random);
+    const AABB query{volume.lowerCorner - 5.0f, volume.upperCorner + 5.0f};
+    std::vector<const Object*> objects;
+    grid.query(query, objects);
+    EXPECT_EQ(sorted(objects), queryAll(scene, query));
+
+    objects.clear();
+    grid.queryRadius(volume.lowerCorner, 12.0f, objects);
+    EXPECT_EQ(sorted(objects), queryAllRadius(scene, volume.lowerCorner, 12.0f));
+  }
+}
+
+}  // namespace
+
+TEST(SpatialHashGridTest, QueriesMatchBruteForce) {
+  std::mt19937 random(1);
+  SpatialHashGrid grid(8.0f);
+  const GridObjects scene = createGridObjects(grid, 5000, random);
+  EXPECT_EQ(grid.size(), 5000);
+  expectQueriesMatch(grid, scene, random);
+
+  // A query covering more cells than are occupied scans the occupied cells instead.
+  std::vector<const Object*> objects;
+  const AABB everything{glm::vec3(-1000.0f), glm::vec3(1000.0f)};
+  grid.query(everything, objects);
+  EXPECT_EQ(objects.size(), 5000);
+}
+
+TEST(SpatialHashGridTest, UpdatesAndRemovalsKeepQueriesExact) {
+  std::mt19937 random(2);
+  SpatialHashGrid grid(8.0f);
+  GridObjects scene = createGridObjects(grid, 5000, random);
+  std::uniform_real_distribution<float> step(-3.0f, 3.0f);
+  for (int frame = 0; frame < 10; ++frame) {
+    for (size_t i = 0; i < scene.objects.size(); ++i) {
+      if (!scene.inserted[i]) {
+        continue;
+      }
+      const glm::vec3 offset(step(random), step(random), step(random));
+      scene.volumes[i].lowerCorner += offset;
+      scene.volumes[i].upperCorner += offset;
+      grid.update(scene.handles[i], scene.volumes[i]);
+    }
+    // Removing emptied cells shifts the following entries of the table.
+    for (size_t i = frame; i < scene.objects.size(); i += 7) {
+      if (scene.inserted[i]) {
+        grid.remove(scene.handles[i]);
+        scene.inserted[i] = false;
+      }
+    }
+    expectQueriesMatch(grid, scene, random);
+  }
+  EXPECT_EQ(grid.size(), std::count(scene.inserted.cbegin(), scene.inserted.cend(), true));
+}
+
+TEST(SpatialHashGridTest, UpdateWithinCellKeepsCells) {
+  SpatialHashGrid grid(10.0f);
+  const Object object("object", 0);
+  const SpatialHashGrid::Handle handle =
+      grid.insert(&object, AABB{glm::vec3(1.0f), glm::vec3(2.0f)});
+  EXPECT_EQ(grid.getCellCount(), 1);
+
+  grid.update(handle, AABB{glm::vec3(7.0f), glm::vec3(8.0f)});
+  EXPECT_EQ(grid.getCellCount(), 1);
+  std::vector<const Object*> objects;
+  grid.query(AABB{glm::vec3(7.5f), glm::vec3(7.5f)}, objects);
+  EXPECT_EQ(objects, std::vector<const Object*>{&object});
+
+  grid.update(handle, AABB{glm::vec3(-8.0f), glm::vec3(-7.0f)});
+  EXPECT_EQ(grid.getCellCount(), 1);
+  objects.clear();
+  grid.query(AABB{glm::vec3(7.5f), glm::vec3(7.5f)}, objects);
+  EXPECT_TRUE(objects.empty());
+
+  grid.remove(handle);
+  EXPECT_EQ(grid.getCellCount(), 0);
+  EXPECT_EQ(grid.size(), 0);
+}
+
+TEST(SpatialHashGridTest, FindsObjectsWhoseCoordinatesWrapAround) {
+  SpatialHashGrid grid(1.0f);
+  const Object nearObject("near", 0);
+  const Object aliasedObject("aliased", 1);
+  const Object farObject("far", 2);
+  const glm::vec3 offset(0.25f);
+  const glm::vec3 aliased(float(1 << 21), 0.0f, 0.0f);
+  const glm::vec3 far(3e6f, -3e6f, 0.0f);
+  grid.insert(&nearObject, AABB{offset, offset + 0.5f});
+  grid.insert(&aliasedObject, AABB{aliased + offset, aliased + offset + 0.5f});
+  grid.insert(&farObject, AABB{far + offset, far + offset + 0.5f});
+  EXPECT_EQ(grid.getCellCount(), 2);
+
+  // Point queries visit single cells, larger ones scan the occupied cells.
+  for (const glm::vec3 extent : {glm::vec3(0.0f), glm::vec3(4.0f)}) {
+    std::vector<const Object*> objects;
+    grid.query(AABB{glm::vec3(0.5f) - extent, glm::vec3(0.5f) + extent}, objects);
+    EXPECT_EQ(objects, std::vector<const Object*>{&nearObject});
+    objects.clear();
+    grid.query(AABB{aliased + 0.5f - extent, aliased + 0.5f + extent}, objects);
+    EXPECT_EQ(objects, std::vector<const Object*>{&aliasedObject});
+    objects.clear();
+    grid.query(AABB{far + 0.5f - extent, far + 0.5f + extent}, objects);
+    EXPECT_EQ(objects, std::vector<const Object*>{&farObject});
+  }
+}
+
+TEST(SpatialHashGridTest, BatchedQueriesMatchSingleQueries) {
+  std::mt19937 random(3);
+  SpatialHashGrid grid(8.0f);
+  createGridObjects(grid, 20000, random);
+  std::vector<AABB> volumes;
+  std::vector<glm::vec4> spheres;
+  for (int i = 0; i < 1000; ++i) {
+    volumes.push_back(createVolume(random));
+    spheres.emplace_back(volumes.back().lowerCorner, 10.0f);
+  }
+
+  lib::ThreadPool threadPool(3);
+  for (lib::ThreadPool* pool : {static_cast<lib::ThreadPool*>(nullptr), &threadPool}) {
+    GridQueryResults results;
+    grid.query(volumes, results, pool);
+    ASSERT_EQ(results.offsets.size(), volumes.size() + 1);
+    for (size_t i = 0; i < volumes.size(); ++i) {
+      std::vector<const Object*> expected;
+      grid.query(volumes[i], expected);
+      EXPECT_TRUE(std::equal(results.objects.cbegin() + results.offsets[i],
+                             results.objects.cbegin() + results.offsets[i + 1], expected.cbegin(),
+                             expected.cend()));
+    }
+
+    grid.queryRadius(spheres, results, pool);
+    ASSERT_EQ(results.offsets.size(), spheres.size() + 1);
+    for (size_t i = 0; i < spheres.size(); ++i) {
+      std::vector<const Object*> expected;
+      grid.queryRadius(glm::vec3(spheres[i]), spheres[i].w, expected);
+      EXPECT_TRUE(std::equal(results.objects.cbegin() + results.offsets[i],
+                             results.objects.cbegin() + results.offsets[i + 1], expected.cbegin(),
+                             expected.cend()));
+    }
+    EXPECT_GT(results.objects.size(), 1000);
+  }
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "common/entity_component_system/component/hierarchy.h"
+#include "common/entity_component_system/component/transform.h"
+#include "common/entity_component_system/registry/registry.h"
+#include "common/entity_component_system/system/transform_system.h"
+#include "lib/thread_pool/thread_pool.h"
+
+namespace {
+
+Entity createNode(Registry& registry, Entity parent, const glm::vec3& translation) {
+  const Entity entity = registry.createEntity();
+  registry.addComponent(
+      entity, TransformComponent{.model = glm::translate(glm::mat4(1.0f), translation),
+                                 .world = glm::mat4(1.0f)});
+  registry.addComponent(entity, HierarchyComponent{.parent = parent});
+  return entity;
+}
+
+glm::vec3 getWorldPosition(Registry& registry, Entity entity) {
+  return glm::vec3(registry.getComponent<TransformComponent>(entity).world[3]);
+}
+
+}  // namespace
+
+TEST(TransformSystemTest, PropagatesDirtySubtrees) {
+  Registry registry;
+  lib::ThreadPool threadPool(1);
+  TransformSystem system(&registry);
+  system.setThreadPool(&threadPool);
+
+  // Children are created before their parents to exercise the depth sort.
+  const Entity root = registry.createEntity();
+  const Entity grandchild = createNode(registry, NULL_ENTITY, glm::vec3(0.0f, 0.0f, 1.0f));
+  const Entity child = createNode(registry, root, glm::vec3(0.0f, 1.0f, 0.0f));
+  const Entity sibling = createNode(registry, NULL_ENTITY, glm::vec3(5.0f, 0.0f, 0.0f));
+  registry.addComponent(grandchild, HierarchyComponent{.parent = child});
+  registry.addComponent(root, TransformComponent{.model = glm::translate(
+                                                     glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
+                                                 .world = glm::mat4(1.0f)});
+  registry.addComponent(root, HierarchyComponent{});
+
+  system.update(0.0f);
+  EXPECT_EQ(system.getDepth(), 3);
+  EXPECT_EQ(getWorldPosition(registry, grandchild), glm::vec3(1.0f, 1.0f, 1.0f));
+  EXPECT_EQ(getWorldPosition(registry, sibling), glm::vec3(5.0f, 0.0f, 0.0f));
+
+  // Clean subtrees are not recomputed.
+  registry.advanceTick();
+  system.update(0.0f);
+  registry.advanceTick();
+  registry.getComponent<TransformComponent>(sibling).world = glm::mat4(0.0f);
+  registry.patch<TransformComponent>(root, [](TransformComponent& transform) {
+    transform.model = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f, 0.0f, 0.0f));
+  });
+  system.update(0.0f);
+  EXPECT_EQ(getWorldPosition(registry, grandchild), glm::vec3(2.0f, 1.0f, 1.0f));
+  EXPECT_EQ(getWorldPosition(registry, sibling), glm::vec3(0.0f));
+
+  // Reparenting and destroying parents restructure the hierarchy.
+  registry.advanceTick();
+  registry.addComponent(grandchild, HierarchyComponent{.parent = sibling});
+  registry.destroyEntity(root);
+  system.update(0.0f);
+  EXPECT_EQ(system.getDepth(), 2);
+  EXPECT_EQ(getWorldPosition(registry, child), glm::vec3(0.0f, 1.0f, 0.0f));
+  EXPECT_EQ(getWorldPosition(registry, grandchild), glm::vec3(5.0f, 0.0f, 1.0f));
+}
+
+TEST(TransformSystemTest, CopiesModelOfEntitiesWithoutHierarchy) {
+  Registry registry;
+  TransformSystem system(&registry);
+  const Entity parent = createNode(registry, NULL_ENTITY, glm::vec3(1.0f, 0.0f, 0.0f));
+  const Entity child = createNode(registry, parent, glm::vec3(0.0f, 1.0f, 0.0f));
+  const Entity standalone = registry.createEntity();
+  registry.addComponent(
+      standalone, TransformComponent{.model = glm::translate(glm::mat4(1.0f), glm::vec3(3.0f)),
+                                     .world = glm::mat4(0.0f)});
+
+  system.update(0.0f);
+  EXPECT_EQ(getWorldPosition(registry, standalone), glm::vec3(3.0f));
+
+  registry.advanceTick();
+  registry.patch<TransformComponent>(standalone, [](TransformComponent& transform) {
+    transform.model = glm::translate(glm::mat4(1.0f), glm::vec3(4.0f));
+  });
+  system.update(0.0f);
+  EXPECT_EQ(getWorldPosition(registry, standalone), glm::vec3(4.0f));
+
+  // Detached entities fall back to their model matrix.
+  registry.advanceTick();
+  registry.removeComponent<HierarchyComponent>(child);
+  system.update(0.0f);
+  EXPECT_EQ(getWorldPosition(registry, child), glm::vec3(0.0f, 1.0f, 0.0f));
+}
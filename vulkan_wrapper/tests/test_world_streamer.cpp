@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "common/scene/world_streamer.h"
+
+namespace {
+
+constexpr float CELL_SIZE = 100.0f;
+constexpr size_t ASSET_SIZE = 1000;
+
+class FakeAssetManager : public common::AssetManager<FakeAssetManager> {
+public:
+  std::vector<std::string> images;
+
+  void loadImageAsync(const std::string& filePath) {
+    images.push_back(filePath);
+  }
+
+  void releaseImage(const std::string& filePath) {
+    std::erase(images, filePath);
+  }
+
+  void releaseVertexData(const std::string&) {}
+};
+
+std::string getImagePath(int32_t x, int32_t z) {
+  return "cell_" + std::to_string(x) + "_" + std::to_string(z) + ".ktx";
+}
+
+// A row of cells along x, every cell has its own image and shares the terrain with the others.
+void addRow(WorldStreamer& streamer, int32_t count) {
+  for (int32_t x = 0; x < count; ++x) {
+    const CellAsset assets[] = {
+      CellAsset{getImagePath(x, 0), StreamedAssetType::IMAGE, ASSET_SIZE},
+      CellAsset{"terrain.gltf", StreamedAssetType::MODEL, ASSET_SIZE}
+    };
+    ASSERT_TRUE(streamer.addCell(glm::ivec3(x, 0, 0), assets));
+  }
+}
+
+glm::vec3 getCellCenter(int32_t x) {
+  return glm::vec3((float(x) + 0.5f) * CELL_SIZE, 0.5f * CELL_SIZE, 0.5f * CELL_SIZE);
+}
+
+}  // namespace
+
+TEST(WorldStreamerTest, StreamsCellsAroundView) {
+  WorldStreamer streamer(CELL_SIZE, StreamingSettings{.loadRadius = 120.0f,
+                                                      .releaseRadius = 180.0f,
+                                                      .memoryBudget = 100 * ASSET_SIZE,
+                                                      .maxLoadsPerUpdate = 8});
+  addRow(streamer, 20);
+  FakeAssetManager assetManager;
+  std::vector<std::string> models;
+  const auto loadModel = [&models](const std::string& path) { models.push_back(path); };
+  const auto releaseModel = [&models](const std::string& path) { std::erase(models, path); };
+
+  // Cells 4 to 6 are within 120 of the center of cell 5, the nearest comes first.
+  const StreamingRequests& requests = streamer.update(getCellCenter(5));
+  ASSERT_EQ(requests.loads.size(), 4);
+  EXPECT_EQ(streamer.getAsset(requests.loads[0]).path, getImagePath(5, 0));
+  EXPECT_EQ(streamer.getAsset(requests.loads[1]).path, "terrain.gltf");
+  streamer.issueRequests(assetManager, loadModel, releaseModel);
+  EXPECT_EQ(assetManager.images.size(), 3);
+  EXPECT_EQ(models, std::vector<std::string>{"terrain.gltf"});
+  EXPECT_EQ(streamer.getMemoryUsage(), 4 * ASSET_SIZE);
+
+  // Cell 4 is 150 away from the center of cell 6 and stays within the release radius.
+  streamer.update(getCellCenter(6));
+  streamer.issueRequests(assetManager, loadModel, releaseModel);
+  EXPECT_TRUE(streamer.isResident(glm::ivec3(4, 0, 0)));
+  EXPECT_TRUE(streamer.isResident(glm::ivec3(7, 0, 0)));
+  EXPECT_EQ(streamer.getResidentCellCount(), 4);
+
+  streamer.update(getCellCenter(7));
+  streamer.issueRequests(assetManager, loadModel, releaseModel);
+  EXPECT_FALSE(streamer.isResident(glm::ivec3(4, 0, 0)));
+  EXPECT_EQ(std::count(assetManager.images.cbegin(), assetManager.images.cend(),
+                       getImagePath(4, 0)),
+            0);
+  EXPECT_EQ(streamer.getResidentCellCount(), 4);
+
+  // Leaving the world releases the shared model as well.
+  streamer.update(glm::vec3(-10'000.0f));
+  streamer.issueRequests(assetManager, loadModel, releaseModel);
+  EXPECT_EQ(streamer.getResidentCellCount(), 0);
+  EXPECT_EQ(streamer.getMemoryUsage(), 0);
+  EXPECT_TRUE(assetManager.images.empty());
+  EXPECT_TRUE(models.empty());
+}
+
+TEST(WorldStreamerTest, KeepsNearestCellsWithinBudget) {
+  // Room for the terrain and two images.
+  WorldStreamer streamer(CELL_SIZE, StreamingSettings{.loadRadius = 250.0f,
+                                                      .releaseRadius = 400.0f,
+                                                      .memoryBudget = 3 * ASSET_SIZE,
+                                                      .maxLoadsPerUpdate = 8});
+  addRow(streamer, 20);
+  streamer.update(getCellCenter(5));
+  EXPECT_EQ(streamer.getResidentCellCount(), 2);
+  EXPECT_TRUE(streamer.isResident(glm::ivec3(5, 0, 0)));
+  EXPECT_LE(streamer.getMemoryUsage(), 3 * ASSET_SIZE);
+
+  // The far cell of the previous update makes room for the new nearest one.
+  streamer.update(getCellCenter(7));
+  EXPECT_TRUE(streamer.isResident(glm::ivec3(7, 0, 0)));
+  EXPECT_EQ(streamer.getResidentCellCount(), 2);
+  EXPECT_LE(streamer.getMemoryUsage(), 3 * ASSET_SIZE);
+
+  // The result is stable while the view does not move.
+  const std::vector<uint32_t> none;
+  EXPECT_EQ(streamer.update(getCellCenter(7)).loads, none);
+  EXPECT_EQ(streamer.getRequests().releases, none);
+}
+
+TEST(WorldStreamerTest, LimitsLoadsPerUpdate) {
+  WorldStreamer streamer(CELL_SIZE, StreamingSettings{.loadRadius = 1000.0f,
+                                                      .releaseRadius = 1000.0f,
+                                                      .memoryBudget = 100 * ASSET_SIZE,
+                                                      .maxLoadsPerUpdate = 2});
+  addRow(streamer, 5);
+  for (size_t update = 1; update <= 3; ++update) {
+    streamer.update(getCellCenter(0));
+    EXPECT_EQ(streamer.getResidentCellCount(), std::min<size_t>(2 * update, 5));
+  }
+  EXPECT_TRUE(streamer.isResident(glm::ivec3(4, 0, 0)));
+}
+
+TEST(WorldStreamerTest, RejectsInvalidCells) {
+  WorldStreamer streamer(CELL_SIZE, StreamingSettings{.loadRadius = 100.0f,
+                                                      .releaseRadius = 100.0f,
+                                                      .memoryBudget = ASSET_SIZE});
+  const CellAsset image{"image.png", StreamedAssetType::IMAGE, ASSET_SIZE};
+  ASSERT_TRUE(streamer.addCell(glm::ivec3(0), std::span(&image, 1)));
+  EXPECT_FALSE(streamer.addCell(glm::ivec3(0), std::span(&image, 1)));
+  EXPECT_FALSE(streamer.addCell(glm::ivec3(1 << 20, 0, 0), std::span(&image, 1)));
+  const CellAsset resized{"image.png", StreamedAssetType::IMAGE, 2 * ASSET_SIZE};
+  EXPECT_FALSE(streamer.addCell(glm::ivec3(1, 0, 0), std::span(&resized, 1)));
+}